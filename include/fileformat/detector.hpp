@@ -3,11 +3,14 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <istream>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
+#include "fileformat/source.hpp"
 #include "fileformat/types.hpp"
 
 namespace fileformat {
@@ -35,6 +38,14 @@ namespace fileformat {
 /// @note 不抛异常，流位置会被重置到调用前的位置
 [[nodiscard]] Format detect(std::istream& stream) noexcept;
 
+/// 检测文件格式（通过分段缓冲区，如网络报文链）
+/// @param segments 按顺序排列的数据段，允许空段
+/// @param count 段数
+/// @return 等价于对拼接后数据的前 kMaxHeaderSize 字节调用 detect()（与流版本的检测窗口一致）
+/// @note 检测窗口位于首段内或前几段在内存中相邻时直接原地检测；否则先以游标窥视开头签名，
+///       签名足以判定时不收集窗口，只有跨段的结构检查才把窗口内的字节收集到栈缓冲区；不分配内存
+[[nodiscard]] Format detect_segments(const ByteSegment* segments, size_t count) noexcept;
+
 //==============================================================================
 // 安全检测 API（返回详细错误）
 //==============================================================================
@@ -44,6 +55,258 @@ namespace fileformat {
 /// @return DetectResult 包含格式和错误信息
 [[nodiscard]] DetectResult detect_safe(const std::string& path) noexcept;
 
+/// 安全检测任意随机访问数据源（对象存储、HTTP Range 等）
+/// @param source 数据源
+/// @return 与 detect_safe(path) 相同的格式与加密判断；文件头读取不完整时 error 为 io_error，
+///         空数据源返回 Unknown 且无错误
+/// @note 首批以一次 read_batch 读取文件头与最后 1 KB，尾部校验与 PDF trailer 等探测直接复用；
+///       此后各探测器声明的区间同样合并后成批读取，常见格式只需一次往返
+[[nodiscard]] DetectResult detect_safe(ByteSource& source) noexcept;
+
+#if !defined(_WIN32)
+/// 安全检测已打开的文件描述符（POSIX）
+/// @param fd 可读的普通文件描述符，以 pread 读取，不改变其文件位置，调用后仍由调用方关闭
+/// @return 与 detect_safe(path) 相同的格式、加密判断与错误语义；fd 无效时 error 为 bad_file_descriptor，
+///         目录为 is_a_directory，其他非普通文件为 invalid_argument
+[[nodiscard]] DetectResult detect_fd(int fd) noexcept;
+
+/// 安全检测目录描述符下的文件（POSIX，以 openat 打开，不解析完整路径）
+/// @param dirfd 目录描述符，或 AT_FDCWD
+/// @param name 相对 dirfd 的文件名（绝对路径时忽略 dirfd）
+/// @return 同 detect_fd；打开失败时 error 为 openat 的 errno（如 no_such_file_or_directory、
+///         permission_denied），name 为空时为 invalid_argument
+[[nodiscard]] DetectResult detect_at(int dirfd, const char* name) noexcept;
+#endif
+
+/// 判断文档或压缩包是否加密：PDF trailer 中的 /Encrypt、OLE 容器中的 EncryptedPackage 流
+/// （加密的 DOCX/XLSX/PPTX）、ZIP 加密标志位与 AES 扩展字段、RAR 头部/文件加密标志、7z 头部中的 AES 编码器
+/// @param data 完整文件数据（从文件开头起）
+/// @param size 数据大小
+/// @return 已加密时返回 true，其他格式或无法判断时返回 false
+/// @note 所有返回 DetectResult 的 API 以定位读取完成同样的判断并填充 DetectResult::encrypted
+[[nodiscard]] bool is_encrypted(const uint8_t* data, size_t size) noexcept;
+
+//==============================================================================
+// 内容分析 API
+//==============================================================================
+
+/// 统计字节分布（熵、可打印字符占比、零字节占比）并给出内容分类
+/// @param data 数据指针
+/// @param size 数据大小
+/// @return 内容统计概要，空指针或零大小时 content_class 为 Unknown
+[[nodiscard]] ContentProfile analyze_content(const uint8_t* data, size_t size) noexcept;
+
+/// 检测文件格式并同时输出内容统计（通过内存缓冲区）
+/// @param data 文件数据指针
+/// @param size 数据大小
+/// @param profile 输出的内容统计概要
+/// @return 检测到的格式
+[[nodiscard]] Format detect(const uint8_t* data, size_t size, ContentProfile& profile) noexcept;
+
+/// 安全检测文件格式并同时输出内容统计（文件头部只读取一次）
+/// @param path 文件路径
+/// @param profile 输出的内容统计概要，读取失败时保持默认值
+/// @return DetectResult 包含格式和错误信息
+[[nodiscard]] DetectResult detect_safe(const std::string& path, ContentProfile& profile) noexcept;
+
+//==============================================================================
+// 图像信息 API
+//==============================================================================
+
+/// 从图像文件头解析宽高、位深与通道数（PNG IHDR、JPEG SOFn、GIF 逻辑屏幕描述符、
+/// BMP DIB 头、WebP VP8/VP8L/VP8X、TIFF IFD0），不分配内存
+/// @param data 文件数据指针（从文件开头起）
+/// @param size 数据大小
+/// @return 图像信息；非图像或头部不完整时宽高为 0
+/// @note JPEG 的 SOFn 位于缓冲区之外时设置 resume_offset，可读取该偏移处的数据后调用 resume_probe_image()
+[[nodiscard]] ImageInfo probe_image(const uint8_t* data, size_t size) noexcept;
+
+/// 从 partial.resume_offset 处继续扫描 JPEG 标记段
+/// @param partial 上一次 probe_image()/resume_probe_image() 的结果
+/// @param data 从 partial.resume_offset 开始的文件数据
+/// @param size 数据大小
+/// @return 更新后的图像信息，仍未找到时 resume_offset 指向下一个待读取的偏移
+[[nodiscard]] ImageInfo resume_probe_image(const ImageInfo& partial, const uint8_t* data,
+                                           size_t size) noexcept;
+
+/// 安全检测文件格式并解析图像信息（复用检测读取的文件头，JPEG 需要时按 resume_offset 追加有限次读取）
+/// @param path 文件路径
+/// @param info 输出的图像信息，非图像时 format 以外的字段为 0
+/// @return DetectResult 包含格式和错误信息
+[[nodiscard]] DetectResult detect_safe(const std::string& path, ImageInfo& info) noexcept;
+
+//==============================================================================
+// 可执行文件信息 API
+//==============================================================================
+
+/// 从可执行文件头解析架构、位数、字节序与文件类型（ELF e_ident/e_type/e_machine，
+/// PE COFF 头与可选头 magic，Mach-O cputype/filetype 与 fat_arch 表），不分配内存
+/// @param data 文件数据指针（从文件开头起）
+/// @param size 数据大小
+/// @return 可执行文件信息；非可执行文件时只有 format 有效
+[[nodiscard]] ExecutableInfo probe_executable(const uint8_t* data, size_t size) noexcept;
+
+/// 安全检测文件格式并解析可执行文件信息（复用检测读取的文件头，不再额外读取）
+/// @param path 文件路径
+/// @param info 输出的可执行文件信息
+/// @return DetectResult 包含格式和错误信息
+[[nodiscard]] DetectResult detect_safe(const std::string& path, ExecutableInfo& info) noexcept;
+
+//==============================================================================
+// 音视频信息 API
+//==============================================================================
+
+/// 解析音视频流参数：WAV fmt/data 块、AVI avih 头、MP3 帧头与 Xing/VBRI 头、
+/// ISO-BMFF（MP4/M4A/MOV/3GP）moov 中的 mvhd
+/// @param data 完整文件数据
+/// @param size 数据大小（CBR MP3 时长与平均码率依据该大小计算）
+/// @return 流参数，非媒体格式或无法解析的字段为 0
+[[nodiscard]] MediaInfo probe_media(const uint8_t* data, size_t size) noexcept;
+
+/// 安全检测文件格式并解析音视频流参数
+/// @param path 文件路径
+/// @param info 输出的流参数
+/// @return DetectResult 包含格式和错误信息
+/// @note 位于文件末尾的 moov 等通过有界的顶层 box 遍历与定位读取获得，不读取整个文件
+[[nodiscard]] DetectResult detect_safe(const std::string& path, MediaInfo& info) noexcept;
+
+//==============================================================================
+// 布局探测 API
+//==============================================================================
+
+/// 探测流式分发相关的布局：MP4/M4A/MOV/3GP 的 moov 是否位于 mdat 之前（faststart），
+/// PDF 是否线性化
+/// @param data 文件数据（从文件开头起）
+/// @param size 数据大小（视为文件大小，用于校验 PDF 的 /L）
+/// @return 布局信息，不适用的格式 known 为 false
+[[nodiscard]] LayoutInfo probe_layout(const uint8_t* data, size_t size) noexcept;
+
+/// 安全检测文件格式并探测布局（PDF 只使用文件头，MP4 在文件头之外继续有界的顶层 box 遍历）
+/// @param path 文件路径
+/// @param info 输出的布局信息
+/// @return DetectResult 包含格式和错误信息
+[[nodiscard]] DetectResult detect_safe(const std::string& path, LayoutInfo& info) noexcept;
+
+//==============================================================================
+// 完整性检查 API
+//==============================================================================
+
+/// 校验廉价的文件结束标记，在解码之前拒绝上传中断或传输截断的文件：
+/// PNG 的 IEND 块及其 CRC、JPEG 的 EOI、ZIP 的 EOCD 与中央目录范围、PDF 的 %%EOF、
+/// GZIP 尾部是否存在且 ISIZE 合理、RIFF（WAV/AVI/WebP）头部声明的大小与实际大小
+/// @param data 完整文件数据
+/// @param size 数据大小
+/// @return 检测到的格式与完整性，其他格式为 Completeness::Unchecked
+[[nodiscard]] CompletenessResult check_complete(const uint8_t* data, size_t size) noexcept;
+
+/// 校验文件结束标记（通过文件路径）
+/// @param path 文件路径
+/// @return 检测到的格式、完整性与错误信息
+/// @note 复用检测读取的文件头，文件大于头部窗口时只追加一次文件尾读取（ZIP 最多 64 KB，其他 1 KB）
+[[nodiscard]] CompletenessResult check_complete(const std::string& path) noexcept;
+
+//==============================================================================
+// 分层检测 API
+//==============================================================================
+
+/// 检测外层格式，外层为 GZIP 时再解压载荷开头约 1 KB 并检测内层格式（如 .tar.gz）
+/// @param data 文件数据指针
+/// @param size 数据大小
+/// @return 外层与内层格式
+/// @note 解压在栈缓冲区内完成，不分配内存，不依赖 zlib
+[[nodiscard]] LayeredFormat detect_layered(const uint8_t* data, size_t size) noexcept;
+
+/// 分层检测（通过文件路径，只读取文件头部）
+/// @param path 文件路径
+/// @return 外层与内层格式，文件不存在或无法读取时均为 Unknown
+[[nodiscard]] LayeredFormat detect_layered(const std::string& path) noexcept;
+
+//==============================================================================
+// 编码输入检测 API
+//==============================================================================
+
+/// 检测经传输编码的数据，只解码检测所需的开头部分（至多 kMaxHeaderSize 字节）
+/// @param data 编码数据（Base64 时可带 "data:<mime>;base64," 前缀）
+/// @param size 数据大小
+/// @param encoding 传输编码
+/// @return 解码后内容的格式
+/// @note 解码在栈缓冲区内完成，跳过空白与换行，不分配内存；解码开销与载荷总大小无关
+[[nodiscard]] Format detect_encoded(const uint8_t* data, size_t size,
+                                    TransferEncoding encoding) noexcept;
+
+//==============================================================================
+// TAR 成员遍历 API
+//==============================================================================
+
+/// TAR 成员回调
+/// @param member 成员信息，path 只在回调期间有效
+/// @return 返回 false 停止遍历
+using TarMemberCallback = std::function<bool(const TarMember& member)>;
+
+/// 流式遍历 TAR 成员，只读取 512 字节头与每个普通文件的前 kMaxHeaderSize 字节并执行 detect()
+/// @param stream 输入流（从归档开头起）；可定位时跳过成员数据，管道等不可定位的流则读取丢弃
+/// @param callback 每个成员按归档顺序回调一次（PAX 扩展头与 GNU 长文件名头不单独报告）
+/// @param error 输出错误码，成功时清空；头部校验和错误为 illegal_byte_sequence，头部或数据不完整为 io_error
+/// @return 报告的成员数
+size_t walk_tar(std::istream& stream, const TarMemberCallback& callback, std::error_code& error);
+
+/// 流式遍历 TAR 成员（通过文件路径）
+size_t walk_tar(const std::string& path, const TarMemberCallback& callback,
+                std::error_code& error);
+
+/// 遍历内存中的 TAR 归档
+size_t walk_tar(const uint8_t* data, size_t size, const TarMemberCallback& callback,
+                std::error_code& error);
+
+//==============================================================================
+// MIME 消息扫描 API
+//==============================================================================
+
+/// MIME 部分回调
+/// @param part 部分信息，content_type 只在回调期间有效
+/// @return 返回 false 停止扫描
+using MimePartCallback = std::function<bool(const MimePart& part)>;
+
+/// 流式扫描 MIME 消息（.eml）的各个叶子部分，检测每个部分的真实格式
+/// @param stream 输入流（从消息头开始），只向前读取
+/// @param callback 每个叶子部分按出现顺序回调一次；非 multipart 消息的正文作为唯一部分报告
+/// @param error 输出错误码，成功时清空；读取失败时为 io_error
+/// @return 报告的部分数
+/// @note 每个部分只保留正文开头的固定字节数并按 base64/quoted-printable 解码前 kMaxHeaderSize 字节，
+///       内存占用与消息大小无关；嵌套 multipart 最多 8 层
+size_t scan_mime(std::istream& stream, const MimePartCallback& callback, std::error_code& error);
+
+/// 流式扫描 MIME 消息（通过文件路径）
+size_t scan_mime(const std::string& path, const MimePartCallback& callback,
+                 std::error_code& error);
+
+/// 扫描内存中的 MIME 消息
+size_t scan_mime(const uint8_t* data, size_t size, const MimePartCallback& callback,
+                 std::error_code& error);
+
+//==============================================================================
+// 容器树检测 API
+//==============================================================================
+
+/// 递归进入可识别的容器（ZIP 条目、TAR 成员、GZIP 载荷、可执行文件后附加的数据），
+/// 返回按先序排列的 (offset, Format) 节点树
+/// @param data 文件数据指针
+/// @param size 数据大小
+/// @param options 深度、节点数与字节预算
+/// @return 节点列表，第一个为根节点；空指针或零大小时为空
+/// @note 整个下降过程只分配一块暂存区，嵌套探测在其中按栈方式切分，不再分配内存
+[[nodiscard]] std::vector<FormatNode> detect_tree(const uint8_t* data, size_t size,
+                                                  const TreeOptions& options = TreeOptions{});
+
+/// 容器树检测（通过文件路径，最多读取 options.max_bytes 字节）
+/// @param path 文件路径
+/// @param options 深度、节点数与字节预算
+/// @param error 输出错误码，成功时清空
+/// @return 节点列表，读取失败时为空
+[[nodiscard]] std::vector<FormatNode> detect_tree(const std::string& path,
+                                                  const TreeOptions& options,
+                                                  std::error_code& error);
+
 //==============================================================================
 // 异常检测 API
 //==============================================================================
@@ -64,6 +327,32 @@ namespace fileformat {
 [[nodiscard]] std::vector<std::pair<std::string, Format>> detect_batch(
     const std::vector<std::string>& paths);
 
+//==============================================================================
+// 嵌入格式扫描 API
+//==============================================================================
+
+/// 嵌入格式命中回调
+/// @param offset 命中的起始偏移
+/// @param format 在该偏移处检测到的格式
+/// @return 返回 false 停止扫描
+using EmbeddedCallback = std::function<bool(uint64_t offset, Format format)>;
+
+/// 在任意偏移处扫描嵌入的文件格式（拼接文件、固件、磁盘镜像等）
+/// @param data 数据指针
+/// @param size 数据大小
+/// @param callback 每个命中按偏移递增顺序回调一次
+/// @return 报告的命中数
+/// @note 先用签名表做首字节预过滤，候选位置再以 detect() 确认；偏移 0 处的外层格式同样会报告
+size_t scan_embedded(const uint8_t* data, size_t size, const EmbeddedCallback& callback);
+
+/// 在任意偏移处扫描嵌入的文件格式（通过文件路径，分块流式读取）
+/// @param path 文件路径
+/// @param callback 每个命中按偏移递增顺序回调一次
+/// @param error 输出错误码，成功时清空
+/// @return 报告的命中数
+size_t scan_embedded(const std::string& path, const EmbeddedCallback& callback,
+                     std::error_code& error);
+
 //==============================================================================
 // 格式信息查询
 //==============================================================================
@@ -103,9 +392,26 @@ namespace detail {
 /// 检测可执行文件格式
 [[nodiscard]] Format detect_executable(const uint8_t* data, size_t size) noexcept;
 
+/// 检测文本格式（纯文本/XML/JSON/HTML/CSV，XML 中包含 FB2 判定）
+[[nodiscard]] Format detect_text(const uint8_t* data, size_t size) noexcept;
+
 /// 检测 ZIP 内部结构（区分 DOCX/XLSX/PPTX/EPUB/普通ZIP）
 [[nodiscard]] Format detect_zip_content(const uint8_t* data, size_t size) noexcept;
 
+/// 检测数据湖/数据库格式（Parquet/ORC/Avro/Arrow/SQLite）
+[[nodiscard]] Format detect_data(const uint8_t* data, size_t size) noexcept;
+
+/// 依据文件头检测磁盘镜像格式（qcow2/VHDX/VMDK/动态 VHD；ISO 9660、UDF 与固定 VHD 需要远偏移探测）
+[[nodiscard]] Format detect_disk_image(const uint8_t* data, size_t size) noexcept;
+
+/// 格式的有效性是否依赖文件尾（Parquet/ORC/Arrow）
+[[nodiscard]] bool has_footer(Format format) noexcept;
+
+/// 校验文件尾
+/// @param tail 文件最后 size 字节
+/// @return 尾部与格式一致，或格式不依赖文件尾时返回 true
+[[nodiscard]] bool check_footer(Format format, const uint8_t* tail, size_t size) noexcept;
+
 }  // namespace detail
 
 }  // namespace fileformat
@@ -32,6 +32,7 @@
 /// @endcode
 
 #include "fileformat/detector.hpp"
+#include "fileformat/source.hpp"
 #include "fileformat/types.hpp"
 
 /// @namespace fileformat
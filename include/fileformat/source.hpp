@@ -0,0 +1,95 @@
+#ifndef FILEFORMAT_SOURCE_HPP
+#define FILEFORMAT_SOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace fileformat {
+
+//==============================================================================
+// 随机访问数据源
+//==============================================================================
+
+/// 批量读取中的一个区间
+struct ReadRequest {
+    uint64_t offset = 0;         // 起始偏移
+    uint8_t* out = nullptr;      // 输出缓冲区，至少 length 字节
+    size_t length = 0;           // 请求的字节数
+    size_t transferred = 0;      // 输出：实际读取的字节数，越界或出错时小于 length
+};
+
+/// 按偏移读取的数据源：检测只通过该接口访问文件头之外的数据（文件尾、远偏移、目录扇区等），
+/// 可由对象存储、HTTP Range 等远端后端实现
+class ByteSource {
+public:
+    virtual ~ByteSource() = default;
+
+    /// 数据总大小
+    virtual uint64_t size() const noexcept = 0;
+
+    /// 从 offset 读取至多 length 字节到 out
+    /// @return 实际读取的字节数，越界或出错时小于 length
+    virtual size_t read_at(uint64_t offset, uint8_t* out, size_t length) noexcept = 0;
+
+    /// 批量读取多个区间（调用方已按偏移排序并合并相邻区间）
+    /// @note 默认逐个调用 read_at；远端实现可覆盖为一次多区间请求或并发请求，以减少往返次数
+    virtual void read_batch(ReadRequest* requests, size_t count) noexcept {
+        for (size_t i = 0; i < count; ++i) {
+            requests[i].transferred = read_at(requests[i].offset, requests[i].out, requests[i].length);
+        }
+    }
+};
+
+/// 内存缓冲区数据源（不复制数据，调用方须保证其生存期）
+class MemorySource final : public ByteSource {
+public:
+    MemorySource(const uint8_t* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    uint64_t size() const noexcept override { return size_; }
+
+    size_t read_at(uint64_t offset, uint8_t* out, size_t length) noexcept override {
+        if (data_ == nullptr || offset >= size_) {
+            return 0;
+        }
+        auto available = static_cast<size_t>(size_ - offset);
+        size_t count = length < available ? length : available;
+        std::memcpy(out, data_ + offset, count);
+        return count;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+};
+
+/// 本地文件数据源
+class FileSource final : public ByteSource {
+public:
+    /// 打开文件并获取大小
+    /// @param path 文件路径，打开失败时 is_open() 为 false，大小为 0
+    explicit FileSource(const std::string& path) noexcept;
+    ~FileSource() override;
+
+    FileSource(FileSource&& other) noexcept;
+    FileSource& operator=(FileSource&& other) noexcept;
+
+    /// 文件是否已成功打开
+    bool is_open() const noexcept { return file_ != nullptr; }
+
+    uint64_t size() const noexcept override { return size_; }
+
+    size_t read_at(uint64_t offset, uint8_t* out, size_t length) noexcept override;
+
+private:
+    struct File;  // 文件句柄，定义于实现文件中（公共头文件不引入 <fstream>）
+
+    std::unique_ptr<File> file_;
+    uint64_t size_ = 0;
+};
+
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_SOURCE_HPP
@@ -56,6 +56,52 @@ enum class Format {
     ELF,
     MachO,
 
+    // 文本格式
+    Text,
+    XML,
+    JSON,
+    HTML,
+    CSV,
+
+    // ISO-BMFF 品牌细分格式（追加在末尾以保持已有枚举值稳定）
+    M4A,
+    MOV,
+    ThreeGP,
+    HEIC,
+    AVIF,
+
+    // EBML DocType 细分格式
+    WebM,
+
+    // TIFF 派生的相机 RAW 格式
+    DNG,
+    CR2,
+    NEF,
+    ARW,
+
+    // 压缩流格式
+    Zstd,
+    XZ,
+    BZip2,
+    LZ4,
+    Brotli,
+    UnixCompress,
+
+    // 数据湖 / 数据库格式
+    Parquet,
+    ORC,
+    Avro,
+    Arrow,
+    SQLite,
+
+    // 光盘 / 磁盘镜像格式
+    ISO9660,
+    UDF,
+    QCOW2,
+    VHD,
+    VHDX,
+    VMDK,
+
     // 格式数量（用于数组大小）
     COUNT_
 };
@@ -68,7 +114,45 @@ enum class Category {
     Ebook,
     Archive,
     Media,
-    Executable
+    Executable,
+    Text,
+    Data,
+    DiskImage
+};
+
+/// 处理器架构（来自可执行文件头）
+enum class Architecture {
+    Unknown,
+    X86,
+    X86_64,
+    ARM,
+    ARM64,
+    PowerPC,
+    PowerPC64,
+    MIPS,
+    RISCV
+};
+
+/// 可执行文件类型
+enum class BinaryKind {
+    Unknown,
+    Executable,     // 可执行程序（含带解释器的 PIE）
+    SharedLibrary,  // 共享库、DLL、dylib、bundle
+    Object,         // 可重定位目标文件
+    Core            // 核心转储
+};
+
+/// 传输编码（邮件附件、JSON 内嵌数据、data: URI）
+enum class TransferEncoding {
+    Base64,          // RFC 4648，同时接受 URL 安全字母表
+    QuotedPrintable  // RFC 2045
+};
+
+/// 文件结束标记的完整性
+enum class Completeness {
+    Unchecked,  // 格式没有可廉价校验的结束标记（或未识别格式）
+    Complete,   // 结束标记存在且与文件大小一致
+    Truncated   // 结束标记缺失、损坏或与文件大小不符（上传中断、传输截断）
 };
 
 /// 格式详细信息
@@ -84,6 +168,7 @@ struct FormatInfo {
 struct DetectResult {
     Format format = Format::Unknown;
     std::error_code error;
+    bool encrypted = false;  // 文档或压缩包已加密（所有返回 DetectResult 的 API 均判断）
 
     /// 检测是否成功（无错误）
     [[nodiscard]] bool is_valid() const noexcept { return !error; }
@@ -95,6 +180,141 @@ struct DetectResult {
     operator Format() const noexcept { return format; }
 };
 
+/// 图像头部信息（只解析文件头，不解码像素）
+struct ImageInfo {
+    Format format = Format::Unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t bit_depth = 0;       // 每通道位深（索引色图像为每像素索引位数）
+    uint8_t channels = 0;        // 通道数（索引色图像为 1）
+    uint64_t resume_offset = 0;  // JPEG 的 SOFn 位于缓冲区之外时继续扫描的文件偏移，0 表示无需继续
+
+    /// 是否解析出宽高
+    [[nodiscard]] bool has_dimensions() const noexcept { return width != 0 && height != 0; }
+};
+
+/// 音视频流参数（只读取文件头及少量定位读取）
+struct MediaInfo {
+    Format format = Format::Unknown;
+    uint64_t duration_ms = 0;    // 时长（毫秒），无法确定时为 0
+    uint32_t bitrate = 0;        // 平均码率（bit/s）
+    uint32_t sample_rate = 0;    // 音频采样率（Hz）
+    uint16_t channels = 0;       // 音频声道数
+    uint16_t width = 0;          // 视频宽度（AVI）
+    uint16_t height = 0;         // 视频高度（AVI）
+
+    /// 是否解析出时长
+    [[nodiscard]] bool has_duration() const noexcept { return duration_ms != 0; }
+};
+
+/// 可执行文件头信息（ELF、PE、Mach-O，只解析文件头，不分配内存）
+struct ExecutableInfo {
+    static constexpr size_t kMaxSlices = 8;
+
+    Format format = Format::Unknown;
+    Architecture architecture = Architecture::Unknown;  // Mach-O 通用二进制为 Unknown，见 slices
+    BinaryKind kind = BinaryKind::Unknown;
+    uint32_t machine = 0;        // 原始机器字段（ELF e_machine、COFF Machine、Mach-O cputype）
+    uint8_t bits = 0;            // 32 或 64，无法确定时为 0
+    bool big_endian = false;
+    bool fat = false;            // Mach-O 通用二进制（fat）
+    uint8_t slice_count = 0;     // 已记录的 fat_arch 条目数（最多 kMaxSlices 个）
+    std::array<Architecture, kMaxSlices> slices{};
+
+    /// 是否解析出架构（单一架构或通用二进制的切片）
+    [[nodiscard]] bool has_architecture() const noexcept {
+        return architecture != Architecture::Unknown || slice_count != 0;
+    }
+};
+
+/// 流式分发相关的文件布局
+struct LayoutInfo {
+    Format format = Format::Unknown;
+    bool known = false;        // 是否确定了布局（格式不适用或数据不足时为 false）
+    bool fast_start = false;   // ISO-BMFF：moov 位于 mdat 之前，无需重新封装即可渐进播放
+    bool linearized = false;   // PDF：开头的 /Linearized 字典有效（/L 与文件长度一致）
+};
+
+/// 完整性检查结果
+struct CompletenessResult {
+    Format format = Format::Unknown;
+    Completeness completeness = Completeness::Unchecked;
+    std::error_code error;
+
+    /// 检查是否成功（无错误）
+    [[nodiscard]] bool is_valid() const noexcept { return !error; }
+
+    /// 是否确认文件被截断
+    [[nodiscard]] bool is_truncated() const noexcept {
+        return completeness == Completeness::Truncated;
+    }
+};
+
+/// 分层检测结果（外层容器及其压缩载荷的格式）
+struct LayeredFormat {
+    Format outer = Format::Unknown;  // 外层格式，与 detect() 的结果一致
+    Format inner = Format::Unknown;  // 载荷格式，外层不是压缩流或载荷无法识别时为 Unknown
+
+    /// 是否识别出内层格式
+    [[nodiscard]] bool has_inner() const noexcept { return inner != Format::Unknown; }
+};
+
+/// 容器树中的一个节点
+struct FormatNode {
+    uint64_t offset = 0;             // 在父节点内容中的偏移（解压后的载荷从 0 开始，根节点为 0）
+    Format format = Format::Unknown;
+    uint32_t depth = 0;              // 嵌套深度，根节点为 0
+    int parent = -1;                 // 父节点下标，根节点为 -1
+};
+
+/// 容器下降的预算
+struct TreeOptions {
+    uint32_t max_depth = 4;          // 最大嵌套深度（超过 32 时按 32 处理）
+    size_t max_nodes = 64;           // 最多报告的节点数
+    size_t max_bytes = 1 << 20;      // 解压输出总字节数上限；路径版本同时以此限制读取的文件字节数
+};
+
+/// 分段输入中的一段（对应 POSIX iovec 的 iov_base/iov_len），数据由调用方持有
+struct ByteSegment {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+/// MIME 消息中的一个叶子部分（附件或正文）
+struct MimePart {
+    size_t index = 0;                // 叶子部分按出现顺序的序号，从 0 开始
+    std::string_view content_type;   // 声明的媒体类型（小写，不含参数），缺省时为空，仅在回调期间有效
+    Format format = Format::Unknown; // 按 Content-Transfer-Encoding 解码后内容开头检测出的格式
+    bool mismatch = false;           // 检测出的格式与声明的类型不符（任一方未知或声明为通用二进制时为 false）
+};
+
+/// TAR 归档中的一个成员
+struct TarMember {
+    std::string_view path;           // 成员路径（PAX path > GNU 长文件名 > ustar prefix/name），仅在回调期间有效
+    uint64_t size = 0;               // 数据大小（PAX size 优先）
+    uint64_t offset = 0;             // 数据在归档中的起始偏移
+    char type = '0';                 // 类型标志：'0' 普通文件、'5' 目录、'2' 符号链接等
+    Format format = Format::Unknown; // 数据开头检测出的格式，非普通文件或空文件为 Unknown
+};
+
+/// 内容统计分类（基于字节分布的启发式判断）
+enum class ContentClass {
+    Unknown,     // 数据不足，无法判断
+    Text,        // 文本
+    Binary,      // 结构化二进制数据
+    Compressed,  // 高熵但分布不均匀，可能为压缩数据
+    Encrypted    // 高熵且接近均匀分布，可能为加密或随机数据
+};
+
+/// 内容统计概要
+struct ContentProfile {
+    double entropy = 0.0;          // 字节香农熵（bit/byte，0~8）
+    double printable_ratio = 0.0;  // 可打印 ASCII 及空白字符占比
+    double zero_ratio = 0.0;       // 零字节占比
+    ContentClass content_class = ContentClass::Unknown;
+    size_t sample_size = 0;        // 参与统计的字节数
+};
+
 /// Magic bytes 签名
 struct MagicSignature {
     std::array<uint8_t, 16> bytes;  // 签名字节
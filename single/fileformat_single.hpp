@@ -27,6 +27,7 @@
 #define FILEFORMAT_SINGLE_HPP
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -118,10 +119,130 @@ inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
     return std::memcmp(data, pattern, len) == 0;
 }
 
+/// 读取小端 32 位整数
+inline uint32_t read_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+//------------------------------------------------------------------------------
+// 多模式子串匹配
+//------------------------------------------------------------------------------
+
+/// 编译期构建的 Aho-Corasick 多模式匹配器
+///
+/// 一次扫描即可确定多个子串是否出现，取代对同一缓冲区的多次 string_view::find。
+/// 状态转移表在编译期展开为完整 DFA（MaxStates x 256），扫描时每字节一次查表。
+///
+/// @tparam NeedleCount 子串数量（不超过 32）
+/// @tparam MaxStates 状态数上限（>= 所有子串长度之和 + 1，且不超过 256）
+template <size_t NeedleCount, size_t MaxStates>
+class MultiMatcher {
+    static_assert(NeedleCount > 0 && NeedleCount <= 32, "needle mask is 32 bits wide");
+    static_assert(MaxStates <= 256, "state index is 8 bits wide");
+
+public:
+    /// @param needles 待查找的子串，下标即返回掩码中的位序号
+    /// @param fold_case 为 true 时按 ASCII 不区分大小写匹配
+    constexpr MultiMatcher(const std::array<std::string_view, NeedleCount>& needles,
+                           bool fold_case = false)
+        : fold_case_(fold_case) {
+        // 1. 构建 trie（0 表示无转移，根节点为状态 0，不会成为转移目标）
+        size_t state_count = 1;
+        for (size_t n = 0; n < NeedleCount; ++n) {
+            size_t state = 0;
+            for (char ch : needles[n]) {
+                auto c = fold(static_cast<uint8_t>(ch));
+                if (next_[state][c] == 0) {
+                    next_[state][c] = static_cast<uint8_t>(state_count++);
+                }
+                state = next_[state][c];
+            }
+            output_[state] |= 1u << n;
+        }
+
+        // 2. 按 BFS 顺序计算失配链接，并把缺失的转移补全为 DFA 转移
+        std::array<uint8_t, MaxStates> fail{};
+        std::array<uint8_t, MaxStates> queue{};
+        size_t head = 0;
+        size_t tail = 0;
+        for (size_t c = 0; c < 256; ++c) {
+            if (next_[0][c] != 0) {
+                queue[tail++] = next_[0][c];
+            }
+        }
+        while (head < tail) {
+            size_t state = queue[head++];
+            output_[state] |= output_[fail[state]];
+            for (size_t c = 0; c < 256; ++c) {
+                uint8_t child = next_[state][c];
+                if (child != 0) {
+                    fail[child] = next_[fail[state]][c];
+                    queue[tail++] = child;
+                } else {
+                    next_[state][c] = next_[fail[state]][c];
+                }
+            }
+        }
+    }
+
+    /// 单遍扫描数据，返回出现过的子串掩码
+    /// @param stop_mask 一旦命中其中任一子串即提前结束扫描（全部命中时总会提前结束）
+    uint32_t scan(const uint8_t* data, size_t size, uint32_t stop_mask = 0) const noexcept {
+        uint32_t found = 0;
+        size_t state = 0;
+        for (size_t i = 0; i < size; ++i) {
+            state = next_[state][fold(data[i])];
+            found |= output_[state];
+            if ((found & stop_mask) != 0 || found == kAllNeedles) {
+                break;
+            }
+        }
+        return found;
+    }
+
+    uint32_t scan(std::string_view text, uint32_t stop_mask = 0) const noexcept {
+        return scan(reinterpret_cast<const uint8_t*>(text.data()), text.size(), stop_mask);
+    }
+
+    static constexpr uint32_t kAllNeedles =
+        NeedleCount == 32 ? 0xFFFFFFFFu : ((1u << NeedleCount) - 1);
+
+private:
+    constexpr uint8_t fold(uint8_t c) const {
+        return (fold_case_ && c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c - 'A' + 'a') : c;
+    }
+
+    bool fold_case_;
+    std::array<std::array<uint8_t, 256>, MaxStates> next_{};
+    std::array<uint32_t, MaxStates> output_{};
+};
+
 //------------------------------------------------------------------------------
 // 图像格式检测
 //------------------------------------------------------------------------------
 
+/// 校验 BMP：DIB 头大小必须是已知的版本之一（排除以 "BM" 开头的文本等）
+inline bool is_valid_bmp(const uint8_t* data, size_t size) noexcept {
+    // BITMAPFILEHEADER (14 字节) + DIB 头大小字段 (4 字节)
+    if (size < 18) {
+        return false;
+    }
+    switch (read_le32(data + 14)) {
+        case 12:   // BITMAPCOREHEADER / OS21XBITMAPHEADER
+        case 16:   // OS22XBITMAPHEADER（精简版）
+        case 40:   // BITMAPINFOHEADER
+        case 52:   // BITMAPV2INFOHEADER
+        case 56:   // BITMAPV3INFOHEADER
+        case 64:   // OS22XBITMAPHEADER
+        case 108:  // BITMAPV4HEADER
+        case 124:  // BITMAPV5HEADER
+            return true;
+        default:
+            return false;
+    }
+}
+
 inline Format detect_image(const uint8_t* data, size_t size) noexcept {
     if (data == nullptr || size < 2) {
         return Format::Unknown;
@@ -139,9 +260,9 @@ inline Format detect_image(const uint8_t* data, size_t size) noexcept {
         return Format::JPEG;
     }
 
-    // BMP: 42 4D ("BM")
+    // BMP: 42 4D ("BM") + 合法的 DIB 头大小
     constexpr uint8_t kBmpMagic[] = {0x42, 0x4D};
-    if (size >= 2 && mem_equal(data, kBmpMagic, 2)) {
+    if (size >= 2 && mem_equal(data, kBmpMagic, 2) && is_valid_bmp(data, size)) {
         return Format::BMP;
     }
 
@@ -263,32 +384,41 @@ inline Format detect_zip_content(const uint8_t* data, size_t size) noexcept {
         return Format::Unknown;
     }
 
-    // 在整个数据中搜索特征字符串
-    std::string_view data_view(reinterpret_cast<const char*>(data), size);
+    // 单遍搜索所有特征字符串
+    constexpr uint32_t kEpubMime = 1u << 0;
+    constexpr uint32_t kMimetype = 1u << 1;
+    constexpr uint32_t kMetaInf = 1u << 2;
+    constexpr uint32_t kPptDir = 1u << 3;
+    constexpr uint32_t kXlDir = 1u << 4;
+    constexpr uint32_t kWordDir = 1u << 5;
+    static constexpr MultiMatcher<6, 64> kZipMatcher(
+        {"application/epub+zip", "mimetype", "META-INF/", "ppt/", "xl/", "word/"});
+
+    // 命中 EPUB mimetype 内容即可提前结束
+    uint32_t found = kZipMatcher.scan(data, size, kEpubMime);
 
     // EPUB: 检查 mimetype 文件内容
-    if (data_view.find("application/epub+zip") != std::string_view::npos) {
+    if (found & kEpubMime) {
         return Format::EPUB;
     }
     // EPUB 备用检测
-    if (data_view.find("mimetype") != std::string_view::npos && 
-        data_view.find("META-INF/") != std::string_view::npos) {
+    if ((found & kMimetype) && (found & kMetaInf)) {
         return Format::EPUB;
     }
 
     // Office Open XML: 直接检查特征目录（不需要先验证 Office 特征）
     // PPTX: ppt/ 目录
-    if (data_view.find("ppt/") != std::string_view::npos) {
+    if (found & kPptDir) {
         return Format::PPTX;
     }
     
     // XLSX: xl/ 目录（Excel 特有）
-    if (data_view.find("xl/") != std::string_view::npos) {
+    if (found & kXlDir) {
         return Format::XLSX;
     }
     
     // DOCX: word/ 目录
-    if (data_view.find("word/") != std::string_view::npos) {
+    if (found & kWordDir) {
         return Format::DOCX;
     }
 
@@ -323,9 +453,12 @@ inline Format detect_archive(const uint8_t* data, size_t size) noexcept {
         return Format::SevenZip;
     }
 
-    // GZIP
+    // GZIP: 1F 8B + CM 为 deflate，FLG 的保留位 (bit 5-7) 为 0
     constexpr uint8_t kGzipMagic[] = {0x1F, 0x8B};
-    if (size >= 2 && mem_equal(data, kGzipMagic, 2)) {
+    constexpr uint8_t kGzipMethodDeflate = 0x08;
+    constexpr uint8_t kGzipReservedFlags = 0xE0;
+    if (size >= 4 && mem_equal(data, kGzipMagic, 2) && data[2] == kGzipMethodDeflate &&
+        (data[3] & kGzipReservedFlags) == 0) {
         return Format::GZip;
     }
 
@@ -351,8 +484,8 @@ inline Format detect_ebook(const uint8_t* data, size_t size) noexcept {
     constexpr uint8_t kMobiMagic[] = {0x42, 0x4F, 0x4F, 0x4B, 0x4D, 0x4F, 0x42, 0x49};
     if (size >= 68 && mem_equal(data + 60, kMobiMagic, 8)) {
         // 检查是否为 AZW3
-        std::string_view view(reinterpret_cast<const char*>(data), size);
-        if (view.find("KF8") != std::string_view::npos) {
+        static constexpr MultiMatcher<1, 4> kKf8Matcher({"KF8"});
+        if (kKf8Matcher.scan(data, size) != 0) {
             return Format::AZW3;
         }
         return Format::MOBI;
@@ -381,6 +514,71 @@ inline Format detect_ebook(const uint8_t* data, size_t size) noexcept {
 // 媒体格式检测
 //------------------------------------------------------------------------------
 
+/// 解析 MPEG-1/2/2.5 Layer III 帧头
+/// @param version_bits 输出：00=MPEG2.5, 10=MPEG2, 11=MPEG1
+/// @param sample_rate_index 输出：采样率表下标
+/// @param frame_length 输出：含帧头的整帧字节数
+/// @return 帧头合法时返回 true
+inline bool parse_mp3_frame_header(const uint8_t* p, uint8_t& version_bits,
+                                   uint8_t& sample_rate_index, size_t& frame_length) noexcept {
+    // MPEG Layer III 比特率表（kbps），索引 0 (free) 和 15 (bad) 无效
+    constexpr uint16_t kBitrateV1[16] = {0,   32,  40,  48,  56,  64,  80,  96,
+                                         112, 128, 160, 192, 224, 256, 320, 0};
+    constexpr uint16_t kBitrateV2[16] = {0,  8,  16, 24,  32,  40,  48,  56,
+                                         64, 80, 96, 112, 128, 144, 160, 0};
+    // 采样率表（Hz），按 MPEG1 / MPEG2 / MPEG2.5 排列，索引 3 保留
+    constexpr uint32_t kSampleRate[3][3] = {
+        {44100, 48000, 32000}, {22050, 24000, 16000}, {11025, 12000, 8000}};
+
+    // 11 位帧同步
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    version_bits = (p[1] >> 3) & 0x03;
+    uint8_t layer_bits = (p[1] >> 1) & 0x03;
+    uint8_t bitrate_index = (p[2] >> 4) & 0x0F;
+    sample_rate_index = (p[2] >> 2) & 0x03;
+    uint8_t padding = (p[2] >> 1) & 0x01;
+    uint8_t emphasis = p[3] & 0x03;
+
+    // 版本 01 保留；只接受 Layer III (01)；强调模式 10 保留
+    if (version_bits == 0x01 || layer_bits != 0x01 || sample_rate_index == 0x03 ||
+        emphasis == 0x02) {
+        return false;
+    }
+
+    bool is_v1 = version_bits == 0x03;
+    uint32_t bitrate = (is_v1 ? kBitrateV1 : kBitrateV2)[bitrate_index];
+    if (bitrate == 0) {
+        return false;  // free format 无法计算帧长，按无效处理
+    }
+    size_t rate_row = is_v1 ? 0 : (version_bits == 0x02 ? 1 : 2);
+    frame_length = (is_v1 ? 144 : 72) * bitrate * 1000 / kSampleRate[rate_row][sample_rate_index] +
+                   padding;
+    return true;
+}
+
+/// 检查 MP3 帧同步：首帧头合法，且缓冲区内的下一帧与之版本/采样率一致
+inline bool is_mp3_frame_sync(const uint8_t* data, size_t size) noexcept {
+    uint8_t version = 0;
+    uint8_t rate = 0;
+    size_t next = 0;
+    if (size < 4 || !parse_mp3_frame_header(data, version, rate, next)) {
+        return false;
+    }
+
+    // 下一帧超出缓冲区时只能依据首帧判断
+    if (next > size - 4) {
+        return true;
+    }
+
+    uint8_t second_version = 0;
+    uint8_t second_rate = 0;
+    size_t second_length = 0;
+    return parse_mp3_frame_header(data + next, second_version, second_rate, second_length) &&
+           second_version == version && second_rate == rate;
+}
+
 inline Format detect_media(const uint8_t* data, size_t size) noexcept {
     if (data == nullptr || size < 2) {
         return Format::Unknown;
@@ -392,9 +590,8 @@ inline Format detect_media(const uint8_t* data, size_t size) noexcept {
         return Format::MP3;
     }
 
-    // MP3 frame sync
-    if (size >= 2 && data[0] == 0xFF && 
-        (data[1] == 0xFB || data[1] == 0xFA || data[1] == 0xF3 || data[1] == 0xF2)) {
+    // MP3 帧同步：首帧头合法，且下一帧（在缓冲区内时）与之一致
+    if (is_mp3_frame_sync(data, size)) {
         return Format::MP3;
     }
 
@@ -430,14 +627,29 @@ inline Format detect_media(const uint8_t* data, size_t size) noexcept {
 // 可执行文件格式检测
 //------------------------------------------------------------------------------
 
+/// 校验 PE 文件：DOS 头偏移 0x3C 的 e_lfanew 必须指向缓冲区内的 "PE\0\0" 签名
+inline bool is_valid_pe(const uint8_t* data, size_t size) noexcept {
+    constexpr size_t kLfanewOffset = 0x3C;
+    constexpr uint8_t kPeSignature[] = {0x50, 0x45, 0x00, 0x00};
+    if (size < kLfanewOffset + 4) {
+        return false;
+    }
+    size_t pe_offset = read_le32(data + kLfanewOffset);
+    // PE 签名不能与 DOS 头重叠
+    if (pe_offset < kLfanewOffset + 4 || pe_offset > size - 4) {
+        return false;
+    }
+    return mem_equal(data + pe_offset, kPeSignature, 4);
+}
+
 inline Format detect_executable(const uint8_t* data, size_t size) noexcept {
     if (data == nullptr || size < 2) {
         return Format::Unknown;
     }
 
-    // Windows PE: MZ
+    // Windows PE: MZ header + e_lfanew 指向的 PE 签名
     constexpr uint8_t kMzMagic[] = {0x4D, 0x5A};
-    if (size >= 2 && mem_equal(data, kMzMagic, 2)) {
+    if (size >= 2 && mem_equal(data, kMzMagic, 2) && is_valid_pe(data, size)) {
         return Format::EXE;
     }
 
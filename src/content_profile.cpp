@@ -0,0 +1,103 @@
+#include "fileformat/detector.hpp"
+
+#include <array>
+#include <cmath>
+
+namespace fileformat {
+
+namespace {
+
+// 内容分类阈值
+constexpr size_t kMinClassifySize = 16;        // 少于该字节数不做分类
+constexpr double kTextLikeRatio = 0.98;        // 文本：可打印/空白/高位字节占比下限
+constexpr double kHighEntropyRatio = 0.9;      // 高熵：熵与可达最大熵之比下限
+constexpr size_t kMinChiSquareSize = 1280;     // 卡方检验要求每个桶期望频数 >= 5
+constexpr double kRandomChiSquareLimit = 323.0;  // 255 自由度下约 mean + 3σ
+
+/// 统计 256 桶字节直方图
+/// 使用 4 组交错子直方图，消除相邻相同字节带来的写后读依赖，便于编译器流水化/向量化
+std::array<uint32_t, 256> byte_histogram(const uint8_t* data, size_t size) {
+    std::array<std::array<uint32_t, 256>, 4> lanes{};
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        ++lanes[0][data[i]];
+        ++lanes[1][data[i + 1]];
+        ++lanes[2][data[i + 2]];
+        ++lanes[3][data[i + 3]];
+    }
+    for (; i < size; ++i) {
+        ++lanes[0][data[i]];
+    }
+
+    std::array<uint32_t, 256> histogram{};
+    for (size_t b = 0; b < 256; ++b) {
+        histogram[b] = lanes[0][b] + lanes[1][b] + lanes[2][b] + lanes[3][b];
+    }
+    return histogram;
+}
+
+bool is_text_whitespace(size_t b) {
+    return b == '\t' || b == '\n' || b == '\r' || b == '\f';
+}
+
+}  // namespace
+
+ContentProfile analyze_content(const uint8_t* data, size_t size) noexcept {
+    ContentProfile profile;
+    if (data == nullptr || size == 0) {
+        return profile;
+    }
+
+    auto histogram = byte_histogram(data, size);
+    const double total = static_cast<double>(size);
+
+    double entropy = 0.0;
+    double chi_square = 0.0;
+    const double expected = total / 256.0;
+    size_t printable = 0;
+    size_t high = 0;
+    for (size_t b = 0; b < 256; ++b) {
+        uint32_t count = histogram[b];
+        if (count != 0) {
+            double p = count / total;
+            entropy -= p * std::log2(p);
+        }
+        double diff = count - expected;
+        chi_square += diff * diff / expected;
+
+        if ((b >= 0x20 && b < 0x7F) || is_text_whitespace(b)) {
+            printable += count;
+        } else if (b >= 0x80) {
+            high += count;
+        }
+    }
+
+    profile.entropy = entropy;
+    profile.printable_ratio = printable / total;
+    profile.zero_ratio = histogram[0] / total;
+    profile.sample_size = size;
+
+    if (size < kMinClassifySize) {
+        return profile;
+    }
+
+    // 文本：无零字节，几乎全部为可打印字符、空白或 UTF-8/多字节编码的高位字节
+    if (histogram[0] == 0 && (printable + high) / total >= kTextLikeRatio) {
+        profile.content_class = ContentClass::Text;
+        return profile;
+    }
+
+    // 高熵数据：样本较小时可达到的最大熵为 log2(size)
+    double max_entropy = std::log2(static_cast<double>(size < 256 ? size : 256));
+    if (entropy >= max_entropy * kHighEntropyRatio) {
+        // 样本足够时用卡方检验区分均匀分布（加密/随机）与压缩数据
+        bool uniform = size >= kMinChiSquareSize && chi_square <= kRandomChiSquareLimit;
+        profile.content_class = uniform ? ContentClass::Encrypted : ContentClass::Compressed;
+        return profile;
+    }
+
+    profile.content_class = ContentClass::Binary;
+    return profile;
+}
+
+}  // namespace fileformat
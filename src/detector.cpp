@@ -7,6 +7,17 @@
 #include <fstream>
 #include <system_error>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "formats/inflate.hpp"
+#include "formats/transfer.hpp"
+#include "formats/reader.hpp"
+#include "formats/tar.hpp"
+
 namespace fileformat {
 
 //==============================================================================
@@ -67,11 +78,58 @@ constexpr std::array<FormatInfo, static_cast<size_t>(Format::COUNT_)> kFormatInf
      Category::Executable},
     {Format::ELF, "ELF", "application/x-executable", "", Category::Executable},
     {Format::MachO, "Mach-O", "application/x-mach-binary", "", Category::Executable},
+
+    // 文本格式
+    {Format::Text, "TXT", "text/plain", ".txt", Category::Text},
+    {Format::XML, "XML", "application/xml", ".xml", Category::Text},
+    {Format::JSON, "JSON", "application/json", ".json", Category::Text},
+    {Format::HTML, "HTML", "text/html", ".html", Category::Text},
+    {Format::CSV, "CSV", "text/csv", ".csv", Category::Text},
+
+    // ISO-BMFF 品牌细分格式
+    {Format::M4A, "M4A", "audio/mp4", ".m4a", Category::Media},
+    {Format::MOV, "MOV", "video/quicktime", ".mov", Category::Media},
+    {Format::ThreeGP, "3GP", "video/3gpp", ".3gp", Category::Media},
+    {Format::HEIC, "HEIC", "image/heic", ".heic", Category::Image},
+    {Format::AVIF, "AVIF", "image/avif", ".avif", Category::Image},
+
+    // EBML DocType 细分格式
+    {Format::WebM, "WebM", "video/webm", ".webm", Category::Media},
+
+    // TIFF 派生的相机 RAW 格式
+    {Format::DNG, "DNG", "image/x-adobe-dng", ".dng", Category::Image},
+    {Format::CR2, "CR2", "image/x-canon-cr2", ".cr2", Category::Image},
+    {Format::NEF, "NEF", "image/x-nikon-nef", ".nef", Category::Image},
+    {Format::ARW, "ARW", "image/x-sony-arw", ".arw", Category::Image},
+
+    // 压缩流格式
+    {Format::Zstd, "ZSTD", "application/zstd", ".zst", Category::Archive},
+    {Format::XZ, "XZ", "application/x-xz", ".xz", Category::Archive},
+    {Format::BZip2, "BZIP2", "application/x-bzip2", ".bz2", Category::Archive},
+    {Format::LZ4, "LZ4", "application/x-lz4", ".lz4", Category::Archive},
+    {Format::Brotli, "BROTLI", "application/x-brotli", ".br", Category::Archive},
+    {Format::UnixCompress, "COMPRESS", "application/x-compress", ".Z", Category::Archive},
+
+    // 数据湖 / 数据库格式
+    {Format::Parquet, "Parquet", "application/vnd.apache.parquet", ".parquet", Category::Data},
+    {Format::ORC, "ORC", "application/x-orc", ".orc", Category::Data},
+    {Format::Avro, "Avro", "application/avro", ".avro", Category::Data},
+    {Format::Arrow, "Arrow", "application/vnd.apache.arrow.file", ".arrow", Category::Data},
+    {Format::SQLite, "SQLite", "application/vnd.sqlite3", ".sqlite", Category::Data},
+
+    // 光盘 / 磁盘镜像格式
+    {Format::ISO9660, "ISO", "application/x-iso9660-image", ".iso", Category::DiskImage},
+    {Format::UDF, "UDF", "application/x-udf-image", ".udf", Category::DiskImage},
+    {Format::QCOW2, "QCOW2", "application/x-qemu-disk", ".qcow2", Category::DiskImage},
+    {Format::VHD, "VHD", "application/x-vhd", ".vhd", Category::DiskImage},
+    {Format::VHDX, "VHDX", "application/x-vhdx", ".vhdx", Category::DiskImage},
+    {Format::VMDK, "VMDK", "application/x-vmdk", ".vmdk", Category::DiskImage},
 }};
 
 // 类别名称表
-constexpr std::array<std::string_view, 7> kCategoryNames = {
-    "unknown", "image", "document", "ebook", "archive", "media", "executable"};
+constexpr std::array<std::string_view, 10> kCategoryNames = {
+    "unknown", "image", "document", "ebook", "archive", "media", "executable", "text", "data",
+    "disk_image"};
 
 }  // namespace
 
@@ -139,6 +197,197 @@ std::pair<std::vector<uint8_t>, std::error_code> read_file_header(const std::str
     return {buffer, std::error_code{}};
 }
 
+// 文件尾确认读取的字节数（Parquet/Arrow 尾部魔数，ORC postscript 长度与魔数）
+constexpr size_t kFooterPeekSize = 16;
+
+/// 头部检测之后访问文件其他位置的确认步骤
+/// - 依赖文件尾的格式（Parquet/ORC/Arrow）校验尾部，不符（如写入中断）时返回 Unknown
+/// - 头部无法识别时执行远偏移探测（ISO 9660/UDF 卷识别序列、固定大小 VHD 的 footer）
+Format detect_beyond_header(ByteSource& reader, Format format) {
+    if (format == Format::Unknown) {
+        return detail::detect_disk_image_far(reader);
+    }
+    if (!detail::has_footer(format)) {
+        return format;
+    }
+    std::vector<uint8_t> scratch;
+    detail::ProbeView tail;
+    const detail::ProbeRange footer{-static_cast<int64_t>(kFooterPeekSize), kFooterPeekSize};
+    detail::read_probes(reader, &footer, 1, scratch, &tail);
+    return detail::check_footer(format, tail.data, tail.size) ? format : Format::Unknown;
+}
+
+/// 头部检测之后是否需要访问文件其他位置
+bool needs_beyond_header(Format format) {
+    return format == Format::Unknown || detail::has_footer(format);
+}
+
+/// 加密判断是否需要访问文件其他位置（PDF trailer、OLE 目录扇区、7z 尾部的头部）
+bool needs_encryption_probe(Format format) {
+    return format == Format::PDF || format == Format::DOC || format == Format::XLS ||
+           format == Format::PPT || format == Format::SevenZip;
+}
+
+/// 为头部之后的确认步骤提供数据源：文件完整位于头部缓冲区或不需要额外数据时直接复用已读数据，
+/// 否则打开文件以定位读取访问
+/// @param need_file 头部未覆盖整个文件时是否需要读取文件
+/// @return 需要打开文件但失败时返回 false，step 不会被调用
+template <typename Step>
+bool with_reader(const std::string& path, const std::vector<uint8_t>& head, bool need_file,
+                 Step&& step) {
+    if (head.size() < kMaxHeaderSize || !need_file) {
+        MemorySource reader(head.data(), head.size());
+        step(reader);
+        return true;
+    }
+
+    FileSource reader(path);
+    if (!reader.is_open()) {
+        return false;
+    }
+    step(reader);
+    return true;
+}
+
+// 数据源首批读取的文件尾窗口（PDF trailer、列式格式尾部、VHD footer 均位于最后 1 KB 内）
+constexpr uint32_t kSourceTailPrefetch = 1024;
+
+/// 首批读取的缓存：以一次 read_batch 取回文件头与文件尾窗口，之后完全落在其中的读取直接返回，
+/// 其余读取转发给底层数据源
+class PrefetchedSource final : public ByteSource {
+public:
+    explicit PrefetchedSource(ByteSource& source) noexcept : source_(source), size_(source.size()) {}
+
+    /// 读取文件头与文件尾窗口（间隔较小时合并为一个区间）
+    /// @return 文件头完整读取时返回 true
+    bool prefetch() noexcept {
+        const detail::ProbeRange ranges[] = {
+            {0, static_cast<uint32_t>(kMaxHeaderSize)},
+            {-static_cast<int64_t>(kSourceTailPrefetch), kSourceTailPrefetch},
+        };
+        detail::read_probes(source_, ranges, 2, scratch_, views_);
+        starts_[0] = 0;
+        // 以请求的起点定位文件尾窗口：短读时视图只覆盖其前缀，不能由视图长度反推起点
+        starts_[1] = size_ - std::min<uint64_t>(size_, kSourceTailPrefetch);
+        return views_[0].size == std::min<uint64_t>(size_, kMaxHeaderSize);
+    }
+
+    const uint8_t* head() const noexcept { return views_[0].data; }
+    size_t head_size() const noexcept { return views_[0].size; }
+
+    uint64_t size() const noexcept override { return size_; }
+
+    size_t read_at(uint64_t offset, uint8_t* out, size_t length) noexcept override {
+        size_t count = 0;
+        if (from_cache(offset, out, length, count)) {
+            return count;
+        }
+        return source_.read_at(offset, out, length);
+    }
+
+    /// 未命中缓存的区间转发给底层数据源；以 kMaxProbeRanges 个为一批，使用栈上的定长数组
+    void read_batch(ReadRequest* requests, size_t count) noexcept override {
+        for (size_t first = 0; first < count; first += detail::kMaxProbeRanges) {
+            size_t last = std::min(count, first + detail::kMaxProbeRanges);
+            std::array<ReadRequest, detail::kMaxProbeRanges> misses;
+            std::array<size_t, detail::kMaxProbeRanges> positions;
+            size_t miss_count = 0;
+            for (size_t i = first; i < last; ++i) {
+                ReadRequest& request = requests[i];
+                if (!from_cache(request.offset, request.out, request.length, request.transferred)) {
+                    misses[miss_count] = request;
+                    positions[miss_count++] = i;
+                }
+            }
+            if (miss_count == 0) {
+                continue;
+            }
+            source_.read_batch(misses.data(), miss_count);
+            for (size_t k = 0; k < miss_count; ++k) {
+                requests[positions[k]].transferred = misses[k].transferred;
+            }
+        }
+    }
+
+private:
+    /// 区间（截断到数据末尾）完全落在已读窗口内时复制并返回 true
+    bool from_cache(uint64_t offset, uint8_t* out, size_t length, size_t& count) const noexcept {
+        if (offset >= size_) {
+            count = 0;
+            return true;
+        }
+        auto wanted = static_cast<size_t>(std::min<uint64_t>(length, size_ - offset));
+        for (size_t i = 0; i < 2; ++i) {
+            if (offset >= starts_[i] && offset + wanted <= starts_[i] + views_[i].size) {
+                std::memcpy(out, views_[i].data + (offset - starts_[i]), wanted);
+                count = wanted;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ByteSource& source_;
+    uint64_t size_;
+    std::vector<uint8_t> scratch_;
+    detail::ProbeView views_[2];
+    uint64_t starts_[2] = {0, 0};
+};
+
+/// 依据已检测的格式判断是否加密
+/// @param head 文件头数据
+bool detect_encryption(ByteSource& reader, const uint8_t* head, size_t head_size,
+                       Format format) {
+    return detail::is_encrypted_document(reader, head, head_size, format) ||
+           detail::is_encrypted_archive(reader, head, head_size, format);
+}
+
+/// 文件头之后的公共步骤：确认格式（尾部校验、远偏移探测）并判断加密
+/// 所有访问完整文件的 API（路径、数据源、文件描述符）都经由此处，同一文件得到相同的格式与加密判断
+/// @param head 文件头数据
+/// @param check_encryption 是否判断加密（只返回 Format 的 API 不需要）
+void confirm_format(ByteSource& reader, const uint8_t* head, size_t head_size, Format head_format,
+                    bool check_encryption, DetectResult& result) {
+    result.format = detect_beyond_header(reader, head_format);
+    result.encrypted =
+        check_encryption && detect_encryption(reader, head, head_size, result.format);
+}
+
+/// 路径 API 的公共流程：读取文件头 → detect() → confirm_format()，之后在同一数据源上执行附加步骤
+/// @param need_file 以 (头部格式, 文件头) 判断附加步骤是否需要文件头之外的数据
+/// @param step 以 (数据源, 文件头, 头部格式, 结果) 调用；文件为空或读取失败时不调用
+/// @return 文件头读取失败时为对应错误，需要定位读取但无法打开文件时为 io_error
+template <typename NeedFile, typename Step>
+DetectResult detect_path(const std::string& path, bool check_encryption, NeedFile&& need_file,
+                         Step&& step) {
+    DetectResult result;
+    auto header = read_file_header(path, kMaxHeaderSize);
+    const std::vector<uint8_t>& head = header.first;
+    result.error = header.second;
+    if (result.error || head.empty()) {
+        return result;
+    }
+
+    Format format = detect(head.data(), head.size());
+    bool need = needs_beyond_header(format) ||
+                (check_encryption && needs_encryption_probe(format)) || need_file(format, head);
+    bool opened = with_reader(path, head, need, [&](ByteSource& reader) {
+        confirm_format(reader, head.data(), head.size(), format, check_encryption, result);
+        step(reader, head, format, result);
+    });
+    if (!opened) {
+        result.error = std::make_error_code(std::errc::io_error);
+    }
+    return result;
+}
+
+/// 无附加步骤的路径检测
+DetectResult detect_path(const std::string& path, bool check_encryption) {
+    return detect_path(
+        path, check_encryption, [](Format, const std::vector<uint8_t>&) { return false; },
+        [](ByteSource&, const std::vector<uint8_t>&, Format, DetectResult&) {});
+}
+
 }  // namespace
 
 //==============================================================================
@@ -174,7 +423,7 @@ Format detect(const uint8_t* data, size_t size) noexcept {
         return fmt;
     }
 
-    // 4. 电子书格式
+    // 4. 电子书格式（FB2 在文本格式中识别）
     if (auto fmt = detail::detect_ebook(data, size); fmt != Format::Unknown) {
         return fmt;
     }
@@ -189,15 +438,26 @@ Format detect(const uint8_t* data, size_t size) noexcept {
         return fmt;
     }
 
+    // 7. 数据湖/数据库格式（SQLite 头为可打印文本，须在文本检测之前）
+    if (auto fmt = detail::detect_data(data, size); fmt != Format::Unknown) {
+        return fmt;
+    }
+
+    // 8. 磁盘镜像格式（VMDK 描述文件为文本，须在文本检测之前；远偏移格式见 detect_beyond_header）
+    if (auto fmt = detail::detect_disk_image(data, size); fmt != Format::Unknown) {
+        return fmt;
+    }
+
+    // 9. 文本格式（无 magic bytes，单遍扫描头部缓冲区）
+    if (auto fmt = detail::detect_text(data, size); fmt != Format::Unknown) {
+        return fmt;
+    }
+
     return Format::Unknown;
 }
 
 Format detect(const std::string& path) noexcept {
-    auto [buffer, error] = read_file_header(path, kMaxHeaderSize);
-    if (error || buffer.empty()) {
-        return Format::Unknown;
-    }
-    return detect(buffer.data(), buffer.size());
+    return detect_path(path, false).format;
 }
 
 Format detect(std::istream& stream) noexcept {
@@ -224,44 +484,607 @@ Format detect(std::istream& stream) noexcept {
     return detect(buffer.data(), bytes_read);
 }
 
+namespace {
+
+// 分段输入的签名窥视大小：覆盖各签名与 ZIP 首个本地文件头（30 字节）及较短的文件名
+constexpr size_t kSegmentPeekSize = 64;
+constexpr size_t kZipLocalHeaderSize = 30;
+constexpr uint8_t kUstarMagic[] = {'u', 's', 't', 'a', 'r'};
+constexpr std::string_view kOoxmlContentTypes = "[Content_Types].xml";
+
+/// 按拼接后的逻辑偏移读取分段输入，只复制请求的字节
+class SegmentCursor {
+public:
+    SegmentCursor(const ByteSegment* segments, size_t count) noexcept
+        : segments_(segments), count_(count) {}
+
+    /// 复制 [offset, offset + length) 到 out
+    /// @return 实际复制的字节数，越过数据末尾时小于 length
+    size_t copy(size_t offset, uint8_t* out, size_t length) const noexcept {
+        size_t copied = 0;
+        size_t base = 0;
+        for (size_t i = 0; i < count_ && copied < length; ++i) {
+            const ByteSegment& segment = segments_[i];
+            if (segment.data == nullptr || segment.size == 0) {
+                continue;
+            }
+            size_t position = offset + copied;
+            if (position < base + segment.size) {
+                size_t skip = position - base;
+                size_t n = std::min(segment.size - skip, length - copied);
+                std::memcpy(out + copied, segment.data + skip, n);
+                copied += n;
+            }
+            base += segment.size;
+        }
+        return copied;
+    }
+
+private:
+    const ByteSegment* segments_;
+    size_t count_;
+};
+
+/// 只依据开头的签名判定分段输入的格式，不收集整个检测窗口
+/// @return 签名足以确定 detect() 对整个窗口的结果时返回该格式，否则返回 Unknown
+///         （由调用方收集窗口后做结构检查）
+Format detect_segment_signature(const SegmentCursor& cursor, size_t window) noexcept {
+    std::array<uint8_t, kSegmentPeekSize> peek;
+    size_t peeked = cursor.copy(0, peek.data(), std::min(window, peek.size()));
+    Format format = detect(peek.data(), peeked);
+    switch (format) {
+        // 图像层最先检测，这些签名之前没有更深的检查
+        case Format::PNG:
+        case Format::JPEG:
+        case Format::GIF:
+        case Format::WebP:
+        case Format::RAR:
+        case Format::SevenZip:
+            return format;
+        // ZIP 由第一个文件名细分：文件名须在窥视范围内；OOXML 需要扫描整个窗口
+        case Format::ZIP:
+        case Format::EPUB:
+        case Format::DOCX: {
+            size_t name_length = static_cast<size_t>(peek[26]) | (static_cast<size_t>(peek[27]) << 8);
+            if (peeked < kZipLocalHeaderSize + name_length) {
+                return Format::Unknown;
+            }
+            std::string_view name(reinterpret_cast<const char*>(peek.data()) + kZipLocalHeaderSize,
+                                  name_length);
+            return name == kOoxmlContentTypes ? Format::Unknown : format;
+        }
+        // 文档层在归档层之后：须确认偏移 257 处没有 TAR 的 ustar 魔数
+        case Format::PDF:
+        case Format::DOC: {
+            uint8_t magic[sizeof(kUstarMagic)];
+            size_t n = cursor.copy(detail::kTarMagicOffset, magic, sizeof(magic));
+            bool tar = n == sizeof(magic) && std::memcmp(magic, kUstarMagic, n) == 0;
+            return tar ? Format::Unknown : format;
+        }
+        default:
+            return Format::Unknown;
+    }
+}
+
+}  // namespace
+
+Format detect_segments(const ByteSegment* segments, size_t count) noexcept {
+    if (segments == nullptr) {
+        return Format::Unknown;
+    }
+
+    // 检测窗口：拼接数据的前 kMaxHeaderSize 字节；同时判断窗口是否在内存中连续
+    const uint8_t* start = nullptr;
+    size_t window = 0;
+    bool contiguous = true;
+    for (size_t i = 0; i < count && window < kMaxHeaderSize; ++i) {
+        const ByteSegment& segment = segments[i];
+        if (segment.data == nullptr || segment.size == 0) {
+            continue;
+        }
+        if (start == nullptr) {
+            start = segment.data;
+        } else if (reinterpret_cast<uintptr_t>(segment.data) !=
+                   reinterpret_cast<uintptr_t>(start) + window) {
+            contiguous = false;
+        }
+        window += std::min(segment.size, kMaxHeaderSize - window);
+    }
+    if (window < kMinHeaderSize) {
+        return Format::Unknown;
+    }
+    if (contiguous) {
+        return detect(start, window);
+    }
+
+    // 签名经游标窥视即可判定时不收集窗口
+    SegmentCursor cursor(segments, count);
+    if (window <= kSegmentPeekSize) {
+        std::array<uint8_t, kSegmentPeekSize> peek;
+        return detect(peek.data(), cursor.copy(0, peek.data(), window));
+    }
+    if (auto fmt = detect_segment_signature(cursor, window); fmt != Format::Unknown) {
+        return fmt;
+    }
+
+    // 跨越段边界的结构检查（BMP/TIFF 头、TAR 校验和、OOXML 目录、文本统计）需要线性视图，
+    // 只收集窗口内的字节
+    std::array<uint8_t, kMaxHeaderSize> buffer;
+    return detect(buffer.data(), cursor.copy(0, buffer.data(), window));
+}
+
 //==============================================================================
 // 安全检测 API
 //==============================================================================
 
 DetectResult detect_safe(const std::string& path) noexcept {
+    return detect_path(path, true);
+}
+
+DetectResult detect_safe(ByteSource& source) noexcept {
     DetectResult result;
+    if (source.size() == 0) {
+        return result;
+    }
 
-    auto [buffer, error] = read_file_header(path, kMaxHeaderSize);
-    result.error = error;
+    PrefetchedSource reader(source);
+    if (!reader.prefetch()) {
+        result.error = std::make_error_code(std::errc::io_error);
+        return result;
+    }
 
-    if (error) {
+    Format format = detect(reader.head(), reader.head_size());
+    confirm_format(reader, reader.head(), reader.head_size(), format, true, result);
+    return result;
+}
+
+bool is_encrypted(const uint8_t* data, size_t size) noexcept {
+    if (data == nullptr || size == 0) {
+        return false;
+    }
+    MemorySource reader(data, size);
+    return detect_encryption(reader, data, size, detect(data, size));
+}
+
+#if !defined(_WIN32)
+
+//==============================================================================
+// 文件描述符 API
+//==============================================================================
+
+namespace {
+
+/// 文件描述符数据源：以 pread 定位读取，不改变描述符的文件位置
+class DescriptorSource final : public ByteSource {
+public:
+    DescriptorSource(int fd, uint64_t size) noexcept : fd_(fd), size_(size) {}
+
+    uint64_t size() const noexcept override { return size_; }
+
+    size_t read_at(uint64_t offset, uint8_t* out, size_t length) noexcept override {
+        if (offset >= size_) {
+            return 0;
+        }
+        size_t total = 0;
+        while (total < length) {
+            ssize_t count = ::pread(fd_, out + total, length - total,
+                                    static_cast<off_t>(offset + total));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                break;
+            }
+            total += static_cast<size_t>(count);
+        }
+        return total;
+    }
+
+private:
+    int fd_;
+    uint64_t size_;
+};
+
+/// 对已打开的描述符执行 detect_safe 的流程：读取文件头，按需定位读取
+DetectResult detect_descriptor(int fd) {
+    DetectResult result;
+
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+        result.error = std::error_code(errno, std::generic_category());
         return result;
     }
+    if (S_ISDIR(status.st_mode)) {
+        result.error = std::make_error_code(std::errc::is_a_directory);
+        return result;
+    }
+    if (!S_ISREG(status.st_mode)) {
+        result.error = std::make_error_code(std::errc::invalid_argument);
+        return result;
+    }
+    if (status.st_size == 0) {
+        return result;  // 空文件，无错误
+    }
 
-    if (buffer.empty()) {
-        result.format = Format::Unknown;
+    DescriptorSource source(fd, static_cast<uint64_t>(status.st_size));
+    std::vector<uint8_t> head(static_cast<size_t>(std::min<uint64_t>(source.size(), kMaxHeaderSize)));
+    if (source.read_at(0, head.data(), head.size()) != head.size()) {
+        result.error = std::make_error_code(std::errc::io_error);
         return result;
     }
 
-    result.format = detect(buffer.data(), buffer.size());
+    // 文件完整位于头部缓冲区时，之后的确认步骤不再发出系统调用
+    MemorySource memory(head.data(), head.size());
+    ByteSource& reader = head.size() < source.size() ? static_cast<ByteSource&>(source) : memory;
+    Format format = detect(head.data(), head.size());
+    confirm_format(reader, head.data(), head.size(), format, true, result);
     return result;
 }
 
+}  // namespace
+
+DetectResult detect_fd(int fd) noexcept {
+    if (fd < 0) {
+        DetectResult result;
+        result.error = std::make_error_code(std::errc::bad_file_descriptor);
+        return result;
+    }
+    return detect_descriptor(fd);
+}
+
+DetectResult detect_at(int dirfd, const char* name) noexcept {
+    DetectResult result;
+    if (name == nullptr || *name == '\0') {
+        result.error = std::make_error_code(std::errc::invalid_argument);
+        return result;
+    }
+
+    // O_NONBLOCK：名称指向 FIFO 时打开不阻塞（随后按非普通文件报告）
+    int fd = ::openat(dirfd, name, O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        result.error = std::error_code(errno, std::generic_category());
+        return result;
+    }
+    result = detect_descriptor(fd);
+    ::close(fd);
+    return result;
+}
+
+#endif  // !defined(_WIN32)
+
 //==============================================================================
-// 异常检测 API
+// 内容分析 API
 //==============================================================================
 
-Format detect_or_throw(const std::string& path) {
-    auto [buffer, error] = read_file_header(path, kMaxHeaderSize);
-    if (error) {
-        throw std::system_error(error, "Failed to read file: " + path);
+// 直方图是对缓冲区的第二遍扫描：签名命中时检测只触及少量字节，不与文本层的遍历合并
+Format detect(const uint8_t* data, size_t size, ContentProfile& profile) noexcept {
+    profile = analyze_content(data, size);
+    return detect(data, size);
+}
+
+DetectResult detect_safe(const std::string& path, ContentProfile& profile) noexcept {
+    profile = ContentProfile{};
+    return detect_path(
+        path, true, [](Format, const std::vector<uint8_t>&) { return false; },
+        [&](ByteSource&, const std::vector<uint8_t>& head, Format, DetectResult&) {
+            profile = analyze_content(head.data(), head.size());
+        });
+}
+
+//==============================================================================
+// 可执行文件信息 API
+//==============================================================================
+
+DetectResult detect_safe(const std::string& path, ExecutableInfo& info) noexcept {
+    info = ExecutableInfo{};
+    return detect_path(
+        path, true, [](Format, const std::vector<uint8_t>&) { return false; },
+        [&](ByteSource&, const std::vector<uint8_t>& head, Format, DetectResult& detected) {
+            if (get_info(detected.format).category == Category::Executable) {
+                info = probe_executable(head.data(), head.size());
+            }
+            info.format = detected.format;
+        });
+}
+
+//==============================================================================
+// 音视频信息 API
+//==============================================================================
+
+DetectResult detect_safe(const std::string& path, MediaInfo& info) noexcept {
+    info = MediaInfo{};
+    return detect_path(
+        path, true,
+        [](Format format, const std::vector<uint8_t>&) {
+            return get_info(format).category == Category::Media;
+        },
+        [&](ByteSource& reader, const std::vector<uint8_t>&, Format, DetectResult& detected) {
+            info.format = detected.format;
+            if (get_info(detected.format).category == Category::Media) {
+                info = detail::probe_media(reader, detected.format);
+            }
+        });
+}
+
+//==============================================================================
+// 布局探测 API
+//==============================================================================
+
+namespace {
+
+bool is_isobmff(Format format) {
+    return format == Format::MP4 || format == Format::M4A || format == Format::MOV ||
+           format == Format::ThreeGP;
+}
+
+/// 依据已检测的格式填充布局信息
+/// @param head 文件头数据
+LayoutInfo probe_layout(const uint8_t* head, size_t head_size, Format format,
+                        ByteSource& reader) {
+    LayoutInfo info;
+    info.format = format;
+    if (format == Format::PDF) {
+        info.known = true;
+        info.linearized = detail::is_linearized_pdf(head, head_size, reader.size());
+    } else if (is_isobmff(format)) {
+        info.known = detail::probe_fast_start(reader, info.fast_start);
+    }
+    return info;
+}
+
+}  // namespace
+
+LayoutInfo probe_layout(const uint8_t* data, size_t size) noexcept {
+    MemorySource reader(data, size);
+    return probe_layout(data, size, detect(data, size), reader);
+}
+
+DetectResult detect_safe(const std::string& path, LayoutInfo& info) noexcept {
+    info = LayoutInfo{};
+    return detect_path(
+        path, true,
+        [](Format format, const std::vector<uint8_t>&) {
+            return format == Format::PDF || is_isobmff(format);
+        },
+        [&](ByteSource& reader, const std::vector<uint8_t>& head, Format, DetectResult& detected) {
+            info = probe_layout(head.data(), head.size(), detected.format, reader);
+        });
+}
+
+//==============================================================================
+// 完整性检查 API
+//==============================================================================
+
+namespace {
+
+// 结束标记所在的尾部窗口：ZIP 的 EOCD 之后可有最长 65535 字节的注释，其他格式 1 KB 足够
+constexpr size_t kEndMarkerWindow = 1024;
+constexpr size_t kZipEndMarkerWindow = 22 + 65535;
+
+/// 校验结束标记所需的文件尾窗口大小，0 表示无需读取文件尾
+size_t end_marker_window(Format format) {
+    switch (format) {
+        case Format::PNG:
+        case Format::JPEG:
+        case Format::PDF:
+        case Format::GZip:
+            return kEndMarkerWindow;
+        case Format::ZIP:
+        case Format::DOCX:
+        case Format::XLSX:
+        case Format::PPTX:
+        case Format::EPUB:
+            return kZipEndMarkerWindow;
+        default:
+            return 0;
+    }
+}
+
+/// RIFF 容器只需比较头部声明的大小与文件大小，不读取文件尾
+bool is_riff(Format format) {
+    return format == Format::WAV || format == Format::AVI || format == Format::WebP;
+}
+
+/// 依据已检测的格式校验结束标记，最多发出一次文件尾读取
+/// @param head 文件头数据
+/// @param head_format 文件头检测出的格式
+/// @param format 经 confirm_format() 确认后的格式（列式格式尾部魔数缺失时为 Unknown）
+Completeness check_end(ByteSource& reader, const uint8_t* head, size_t head_size,
+                       Format head_format, Format format) {
+    // Parquet/ORC/Arrow 的尾部已在确认格式时校验过
+    if (detail::has_footer(head_format)) {
+        return format == head_format ? Completeness::Complete : Completeness::Truncated;
+    }
+    if (is_riff(format)) {
+        return detail::check_riff_end(head, head_size, reader.size());
     }
+    size_t window = end_marker_window(format);
+    if (window == 0) {
+        return Completeness::Unchecked;
+    }
+
+    std::vector<uint8_t> scratch;
+    detail::ProbeView tail;
+    const detail::ProbeRange range{-static_cast<int64_t>(window), static_cast<uint32_t>(window)};
+    detail::read_probes(reader, &range, 1, scratch, &tail);
+
+    Completeness status = detail::check_image_end(format, tail.data, tail.size);
+    if (status == Completeness::Unchecked) {
+        status = detail::check_document_end(format, tail.data, tail.size);
+    }
+    if (status == Completeness::Unchecked) {
+        status = detail::check_archive_end(format, tail.data, tail.size, reader.size());
+    }
+    return status;
+}
+
+}  // namespace
+
+CompletenessResult check_complete(const uint8_t* data, size_t size) noexcept {
+    CompletenessResult result;
+    if (data == nullptr || size == 0) {
+        return result;
+    }
+    MemorySource reader(data, size);
+    Format head_format = detect(data, size);
+    DetectResult detected;
+    confirm_format(reader, data, size, head_format, false, detected);
+    result.format = detected.format;
+    result.completeness = check_end(reader, data, size, head_format, detected.format);
+    return result;
+}
+
+CompletenessResult check_complete(const std::string& path) noexcept {
+    CompletenessResult result;
+    DetectResult detected = detect_path(
+        path, false,
+        [](Format format, const std::vector<uint8_t>&) {
+            return is_riff(format) || end_marker_window(format) != 0;
+        },
+        [&](ByteSource& reader, const std::vector<uint8_t>& head, Format head_format,
+            DetectResult& confirmed) {
+            result.completeness =
+                check_end(reader, head.data(), head.size(), head_format, confirmed.format);
+        });
+    result.format = detected.format;
+    result.error = detected.error;
+    return result;
+}
+
+//==============================================================================
+// 分层检测 API
+//==============================================================================
+
+namespace {
+
+// 内层检测解压的载荷字节数（覆盖 TAR 的 ustar 偏移及常见格式头）
+constexpr size_t kInnerPeekSize = 1024;
+
+}  // namespace
+
+LayeredFormat detect_layered(const uint8_t* data, size_t size) noexcept {
+    LayeredFormat result;
+    result.outer = detect(data, size);
+    if (result.outer != Format::GZip) {
+        return result;
+    }
+
+    std::array<uint8_t, kInnerPeekSize> payload;
+    size_t produced = detail::gunzip_prefix(data, size, payload.data(), payload.size());
+    result.inner = detect(payload.data(), produced);
+    return result;
+}
+
+LayeredFormat detect_layered(const std::string& path) noexcept {
+    LayeredFormat layered;
+    detect_path(
+        path, false, [](Format, const std::vector<uint8_t>&) { return false; },
+        [&](ByteSource&, const std::vector<uint8_t>& head, Format, DetectResult& detected) {
+            layered = detect_layered(head.data(), head.size());
+            layered.outer = detected.format;
+        });
+    return layered;
+}
+
+//==============================================================================
+// 编码输入检测 API
+//==============================================================================
+
+namespace {
+
+// data: URI 的媒体类型部分在此范围内查找 ","（RFC 2397）
+constexpr size_t kDataUriHeaderLimit = 256;
+constexpr std::string_view kDataUriScheme = "data:";
 
-    if (buffer.empty()) {
+/// 跳过 "data:<mime>;base64," 前缀，不是 data: URI 时返回 0
+size_t data_uri_payload_offset(const uint8_t* data, size_t size) {
+    std::string_view text(reinterpret_cast<const char*>(data),
+                          std::min(size, kDataUriHeaderLimit));
+    if (text.substr(0, kDataUriScheme.size()) != kDataUriScheme) {
+        return 0;
+    }
+    size_t comma = text.find(',');
+    return comma == std::string_view::npos ? 0 : comma + 1;
+}
+
+}  // namespace
+
+Format detect_encoded(const uint8_t* data, size_t size, TransferEncoding encoding) noexcept {
+    if (data == nullptr || size == 0) {
         return Format::Unknown;
     }
 
-    return detect(buffer.data(), buffer.size());
+    std::array<uint8_t, kMaxHeaderSize> decoded;
+    size_t produced = 0;
+    switch (encoding) {
+        case TransferEncoding::Base64: {
+            size_t offset = data_uri_payload_offset(data, size);
+            produced = detail::decode_base64_prefix(data + offset, size - offset, decoded.data(),
+                                                    decoded.size());
+            break;
+        }
+        case TransferEncoding::QuotedPrintable:
+            produced = detail::decode_quoted_printable_prefix(data, size, decoded.data(),
+                                                              decoded.size());
+            break;
+    }
+    return detect(decoded.data(), produced);
+}
+
+//==============================================================================
+// 图像信息 API
+//==============================================================================
+
+namespace {
+
+// JPEG 在文件头之外继续查找 SOFn 的最多读取次数（跳过 EXIF 缩略图等大段 APPn）
+constexpr int kMaxImageResumeReads = 16;
+
+}  // namespace
+
+DetectResult detect_safe(const std::string& path, ImageInfo& info) noexcept {
+    info = ImageInfo{};
+    return detect_path(
+        path, true,
+        [](Format format, const std::vector<uint8_t>& head) {
+            return format == Format::JPEG && probe_image(head.data(), head.size()).resume_offset != 0;
+        },
+        [&](ByteSource& reader, const std::vector<uint8_t>& head, Format, DetectResult& detected) {
+            info.format = detected.format;
+            if (get_info(detected.format).category != Category::Image) {
+                return;
+            }
+            info = probe_image(head.data(), head.size());
+            info.format = detected.format;
+
+            // 按 resume_offset 做有限次定位读取
+            std::vector<uint8_t> buffer(info.resume_offset != 0 ? kMaxHeaderSize : 0);
+            for (int i = 0; i < kMaxImageResumeReads && info.resume_offset != 0; ++i) {
+                size_t bytes_read = reader.read_at(info.resume_offset, buffer.data(), buffer.size());
+                if (bytes_read == 0) {
+                    break;
+                }
+                uint64_t previous = info.resume_offset;
+                info = resume_probe_image(info, buffer.data(), bytes_read);
+                // 偏移未前进：文件在标记段中间结束，重复读取只会得到相同结果
+                if (info.resume_offset <= previous) {
+                    break;
+                }
+            }
+            info.resume_offset = 0;
+        });
+}
+
+//==============================================================================
+// 异常检测 API
+//==============================================================================
+
+Format detect_or_throw(const std::string& path) {
+    DetectResult result = detect_path(path, false);
+    if (result.error) {
+        throw std::system_error(result.error, "Failed to read file: " + path);
+    }
+    return result.format;
 }
 
 //==============================================================================
@@ -2,6 +2,13 @@
 
 #include <algorithm>
 #include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "formats/byte_utils.hpp"
+#include "formats/crc32.hpp"
+#include "formats/multi_matcher.hpp"
+#include "formats/reader.hpp"
 
 namespace fileformat {
 namespace detail {
@@ -16,14 +23,405 @@ constexpr uint8_t kRarMagic[] = {0x52, 0x61, 0x72, 0x21, 0x1A, 0x07};  // "Rar!"
 constexpr uint8_t kSevenZipMagic[] = {0x37, 0x7A, 0xBC, 0xAF, 0x27, 0x1C};  // 7z
 constexpr uint8_t kGzipMagic[] = {0x1F, 0x8B};
 constexpr uint8_t kTarUstarMagic[] = {0x75, 0x73, 0x74, 0x61, 0x72};  // "ustar" at offset 257
+constexpr uint8_t kZstdMagic[] = {0x28, 0xB5, 0x2F, 0xFD};
+constexpr uint8_t kXzMagic[] = {0xFD, 0x37, 0x7A, 0x58, 0x5A, 0x00};  // "\xFD7zXZ\0"
+constexpr uint8_t kBzip2Magic[] = {0x42, 0x5A, 0x68};  // "BZh"
+constexpr uint8_t kLz4FrameMagic[] = {0x04, 0x22, 0x4D, 0x18};
+constexpr uint8_t kLz4LegacyMagic[] = {0x02, 0x21, 0x4C, 0x18};
+constexpr uint8_t kBrotliFrameMagic[] = {0xCE, 0xB2, 0xCF, 0x81};  // brotli framing format 草案
+constexpr uint8_t kCompressMagic[] = {0x1F, 0x9D};  // Unix compress (LZW)
+
+// OOXML 特征目录（位序号即优先级：word/ > xl/ > ppt/）
+constexpr MultiMatcher<3, 16> kOoxmlDirMatcher({"word/", "xl/", "ppt/"});
+constexpr uint32_t kOoxmlWord = 1u << 0;
+constexpr uint32_t kOoxmlExcel = 1u << 1;
+constexpr uint32_t kOoxmlPowerPoint = 1u << 2;
+
+// GZIP 头字段（RFC 1952）
+constexpr uint8_t kGzipMethodDeflate = 0x08;   // CM = 8 (deflate)
+constexpr uint8_t kGzipReservedFlags = 0xE0;   // FLG 的 bit 5-7 保留，必须为 0
+
+// GZIP 成员的最小长度：10 字节头 + 2 字节空 deflate 块 + 8 字节尾部（CRC32 + ISIZE）
+constexpr uint64_t kGzipHeaderSize = 10;
+constexpr uint64_t kGzipTrailerSize = 8;
+constexpr uint64_t kGzipMinMemberSize = 20;
+// deflate 的压缩比上限约为 1032:1（每个长度 258 的匹配至少占 2 位）
+constexpr uint64_t kDeflateMaxRatio = 1032;
+
+// ZIP 中央目录结束记录（APPNOTE 4.3.16）与 ZIP64 EOCD 定位器（4.3.15）
+constexpr uint32_t kZipEocdSignature = 0x06054B50;
+constexpr uint32_t kZipCentralSignature = 0x02014B50;
+constexpr uint32_t kZip64LocatorSignature = 0x07064B50;
+constexpr size_t kZipEocdSize = 22;
+constexpr size_t kZip64LocatorSize = 20;
+constexpr uint32_t kZip64Marker = 0xFFFFFFFF;
+
+// zstd 帧头（RFC 8878 3.1.1.1）
+constexpr uint8_t kZstdReservedBit = 0x08;
+constexpr uint8_t kZstdSingleSegment = 0x20;
+constexpr uint8_t kZstdMaxWindowLog = 31;  // 参考实现 64 位平台的上限
+
+// xz 流头（xz-file-format 2.1.1）：magic(6) + Stream Flags(2) + CRC32(4)
+constexpr size_t kXzStreamHeaderSize = 12;
+
+// bzip2 块头（π 的 BCD）或空流的流结束标记（√π 的 BCD）
+constexpr uint8_t kBzip2BlockMagic[] = {0x31, 0x41, 0x59, 0x26, 0x53, 0x59};
+constexpr uint8_t kBzip2EndMagic[] = {0x17, 0x72, 0x45, 0x38, 0x50, 0x90};
+
+// LZ4 帧描述符（lz4_Frame_format 2.2）
+constexpr uint8_t kLz4VersionMask = 0xC0;
+constexpr uint8_t kLz4Version = 0x40;
+constexpr uint8_t kLz4FlagReserved = 0x02;
+constexpr uint8_t kLz4BdReserved = 0x8F;
+
+// ZIP 本地文件头（APPNOTE 4.3.7、4.4.4、附录 E）
+constexpr uint32_t kZipLocalHeaderSignature = 0x04034B50;
+constexpr size_t kZipLocalHeaderSize = 30;
+constexpr uint16_t kZipFlagEncrypted = 0x0001;
+constexpr uint16_t kZipFlagDataDescriptor = 0x0008;
+constexpr uint16_t kZipMethodAes = 99;
+constexpr uint16_t kZipExtraAes = 0x9901;  // WinZip AES 扩展字段
+constexpr size_t kZipMaxEntriesChecked = 16;
+
+// RAR 4.x 块头（RAR 4 technote）
+constexpr size_t kRar4MarkerSize = 7;
+constexpr uint8_t kRar4MainHeader = 0x73;
+constexpr uint8_t kRar4FileHeader = 0x74;
+constexpr uint16_t kRar4MainPassword = 0x0080;  // 块头加密
+constexpr uint16_t kRar4FilePassword = 0x0004;  // 文件数据加密
+
+// RAR 5.0 头部（RAR 5.0 archive format）
+constexpr uint8_t kRar5Magic[] = {0x52, 0x61, 0x72, 0x21, 0x1A, 0x07, 0x01, 0x00};
+constexpr uint64_t kRar5MainHeader = 1;
+constexpr uint64_t kRar5FileHeader = 2;
+constexpr uint64_t kRar5EncryptionHeader = 4;  // 头部加密
+constexpr uint64_t kRar5FlagExtraArea = 0x01;
+constexpr uint64_t kRar5FlagDataArea = 0x02;
+constexpr uint64_t kRar5ExtraEncryption = 0x01;
+
+// 7z 签名头：签名(6) + 版本(2) + StartHeaderCRC(4) + NextHeaderOffset(8) + NextHeaderSize(8) + CRC(4)
+constexpr size_t kSevenZipSignatureHeaderSize = 32;
+constexpr size_t kSevenZipHeaderSearchSize = 1024;
+constexpr uint8_t kSevenZipAesCoder[] = {0x06, 0xF1, 0x07, 0x01};  // 7zAES 编码器 ID
+
+// compress 头第三字节：bit 0-4 最大码长（9-16），bit 5-6 保留
+constexpr uint8_t kCompressBitsMask = 0x1F;
+constexpr uint8_t kCompressReserved = 0x60;
 
 /// 比较内存
 inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
     return std::memcmp(data, pattern, len) == 0;
 }
 
+/// 校验 GZIP 头：压缩方法必须为 deflate，保留标志位必须为 0
+bool is_valid_gzip(const uint8_t* data, size_t size) {
+    if (size < 4) {
+        return false;
+    }
+    return data[2] == kGzipMethodDeflate && (data[3] & kGzipReservedFlags) == 0;
+}
+
+/// 校验 zstd 帧头：保留位为 0；非单段帧的窗口描述符不超过解码器上限
+bool is_valid_zstd(const uint8_t* data, size_t size) {
+    if (size < 5) {
+        return true;  // 只有魔数时无法进一步校验
+    }
+    uint8_t descriptor = data[4];
+    if ((descriptor & kZstdReservedBit) != 0) {
+        return false;
+    }
+    if ((descriptor & kZstdSingleSegment) != 0 || size < 6) {
+        return true;
+    }
+    return 10 + (data[5] >> 3) <= kZstdMaxWindowLog;
+}
+
+/// 校验 xz 流头：Stream Flags 首字节为 0、第二字节高 4 位为 0，且 CRC32 一致
+bool is_valid_xz(const uint8_t* data, size_t size) {
+    if (size < kXzStreamHeaderSize) {
+        return true;
+    }
+    if (data[6] != 0 || (data[7] & 0xF0) != 0) {
+        return false;
+    }
+    return crc32(data + 6, 2) == read_le32(data + 8);
+}
+
+/// 校验 bzip2 头：块大小为 '1'-'9'，其后是块头或流结束标记
+bool is_valid_bzip2(const uint8_t* data, size_t size) {
+    if (size < 4 || data[3] < '1' || data[3] > '9') {
+        return false;
+    }
+    if (size < 10) {
+        return true;
+    }
+    return mem_equal(data + 4, kBzip2BlockMagic, 6) || mem_equal(data + 4, kBzip2EndMagic, 6);
+}
+
+/// 校验 LZ4 帧描述符：版本号为 01，FLG/BD 保留位为 0，块最大尺寸为 4-7
+/// （头校验和 HC 基于 xxHash32，不做校验）
+bool is_valid_lz4_frame(const uint8_t* data, size_t size) {
+    if (size < 6) {
+        return true;
+    }
+    uint8_t flags = data[4];
+    uint8_t block = data[5];
+    return (flags & kLz4VersionMask) == kLz4Version && (flags & kLz4FlagReserved) == 0 &&
+           (block & kLz4BdReserved) == 0 && (block >> 4) >= 4;
+}
+
+/// 校验 compress 头：最大码长 9-16，保留位为 0
+bool is_valid_compress(const uint8_t* data, size_t size) {
+    if (size < 3) {
+        return false;
+    }
+    uint8_t bits = data[2] & kCompressBitsMask;
+    return (data[2] & kCompressReserved) == 0 && bits >= 9 && bits <= 16;
+}
+
+uint64_t read_le64(const uint8_t* p) {
+    return static_cast<uint64_t>(read_le32(p)) | (static_cast<uint64_t>(read_le32(p + 4)) << 32);
+}
+
+/// ZIP：遍历头部缓冲区内的本地文件头，任一条目带加密标志或 AES 扩展字段即视为加密
+bool is_encrypted_zip(const uint8_t* data, size_t size) {
+    size_t pos = 0;
+    for (size_t i = 0; i < kZipMaxEntriesChecked && pos + kZipLocalHeaderSize <= size &&
+                       read_le32(data + pos) == kZipLocalHeaderSignature;
+         ++i) {
+        const uint8_t* header = data + pos;
+        uint16_t flags = read_le16(header + 6);
+        uint16_t method = read_le16(header + 8);
+        if ((flags & kZipFlagEncrypted) != 0 || method == kZipMethodAes) {
+            return true;
+        }
+
+        size_t name_len = read_le16(header + 26);
+        size_t extra_len = read_le16(header + 28);
+        size_t extra = pos + kZipLocalHeaderSize + name_len;
+        for (size_t field = extra; field + 4 <= std::min(size, extra + extra_len);
+             field += 4 + read_le16(data + field + 2)) {
+            if (read_le16(data + field) == kZipExtraAes) {
+                return true;
+            }
+        }
+
+        // 大小记录在数据描述符中时无法定位下一个条目
+        uint32_t compressed_size = read_le32(header + 18);
+        if ((flags & kZipFlagDataDescriptor) != 0 && compressed_size == 0) {
+            break;
+        }
+        pos = extra + extra_len + compressed_size;
+    }
+    return false;
+}
+
+/// 读取 RAR5 变长整数（每字节低 7 位，最高位表示后续还有字节）
+bool read_rar5_vint(const uint8_t* data, size_t size, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && pos < size; shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// RAR5：头部加密头，或第一个文件头的扩展区中有加密记录
+bool is_encrypted_rar5(const uint8_t* data, size_t size) {
+    size_t pos = sizeof(kRar5Magic);
+    for (int i = 0; i < 2; ++i) {
+        // CRC32(4) + 头大小 + 头类型 + 头标志
+        size_t start = pos + 4;
+        size_t cursor = start;
+        uint64_t header_size = 0;
+        uint64_t type = 0;
+        uint64_t flags = 0;
+        if (!read_rar5_vint(data, size, cursor, header_size)) {
+            return false;
+        }
+        size_t header_end = cursor + static_cast<size_t>(std::min<uint64_t>(header_size, size));
+        if (!read_rar5_vint(data, size, cursor, type) ||
+            !read_rar5_vint(data, size, cursor, flags)) {
+            return false;
+        }
+        if (type == kRar5EncryptionHeader) {
+            return true;
+        }
+
+        uint64_t extra_size = 0;
+        uint64_t data_size = 0;
+        if ((flags & kRar5FlagExtraArea) != 0 && !read_rar5_vint(data, size, cursor, extra_size)) {
+            return false;
+        }
+        if ((flags & kRar5FlagDataArea) != 0 && !read_rar5_vint(data, size, cursor, data_size)) {
+            return false;
+        }
+
+        if (type == kRar5FileHeader) {
+            // 扩展区位于头部末尾，每条记录为：大小（从类型字段起算）+ 类型 + 数据
+            size_t record = header_end - std::min<size_t>(header_end, static_cast<size_t>(extra_size));
+            while (record < header_end) {
+                uint64_t record_size = 0;
+                uint64_t record_type = 0;
+                if (!read_rar5_vint(data, size, record, record_size) || record_size == 0) {
+                    return false;
+                }
+                size_t record_end = record + static_cast<size_t>(std::min<uint64_t>(record_size, size));
+                if (!read_rar5_vint(data, size, record, record_type)) {
+                    return false;
+                }
+                if (record_type == kRar5ExtraEncryption) {
+                    return true;
+                }
+                record = record_end;
+            }
+            return false;
+        }
+        if (type != kRar5MainHeader) {
+            return false;
+        }
+        pos = header_end + static_cast<size_t>(data_size);
+    }
+    return false;
+}
+
+/// RAR 4.x：主头的块头加密标志，或第一个文件头的文件加密标志
+bool is_encrypted_rar4(const uint8_t* data, size_t size) {
+    // 块头：CRC(2) + 类型(1) + 标志(2) + 头大小(2)
+    size_t pos = kRar4MarkerSize;
+    if (pos + 7 > size || data[pos + 2] != kRar4MainHeader) {
+        return false;
+    }
+    if ((read_le16(data + pos + 3) & kRar4MainPassword) != 0) {
+        return true;
+    }
+    pos += read_le16(data + pos + 5);
+    if (pos + 7 > size || data[pos + 2] != kRar4FileHeader) {
+        return false;
+    }
+    return (read_le16(data + pos + 3) & kRar4FilePassword) != 0;
+}
+
+/// 7z：按签名头读取下一个头部的开头，查找 7zAES 编码器 ID
+/// （头部加密时编码头的编码器链包含 AES；仅数据加密且头部经 LZMA 压缩时无法识别）
+bool is_encrypted_7z(ByteSource& reader, const uint8_t* head, size_t head_size) {
+    if (head_size < kSevenZipSignatureHeaderSize) {
+        return false;
+    }
+    uint64_t next_offset = read_le64(head + 12);
+    uint64_t next_size = read_le64(head + 20);
+    if (next_offset > reader.size() || next_size == 0) {
+        return false;
+    }
+
+    uint8_t header[kSevenZipHeaderSearchSize];
+    size_t length = static_cast<size_t>(std::min<uint64_t>(next_size, sizeof(header)));
+    size_t count = reader.read_at(kSevenZipSignatureHeaderSize + next_offset, header, length);
+    std::string_view text(reinterpret_cast<const char*>(header), count);
+    std::string_view coder(reinterpret_cast<const char*>(kSevenZipAesCoder),
+                           sizeof(kSevenZipAesCoder));
+    return text.find(coder) != std::string_view::npos;
+}
+
+/// ZIP：自文件尾向前查找 EOCD，校验注释长度不越过文件尾、中央目录位于 EOCD 之前，
+/// 中央目录起点落在尾部窗口内时再校验其签名
+Completeness check_zip_end(const uint8_t* tail, size_t size, uint64_t file_size) {
+    if (size < kZipEocdSize) {
+        return Completeness::Truncated;
+    }
+    uint64_t tail_start = file_size - size;
+    for (size_t pos = size - kZipEocdSize + 1; pos-- > 0;) {
+        const uint8_t* eocd = tail + pos;
+        if (read_le32(eocd) != kZipEocdSignature ||
+            pos + kZipEocdSize + read_le16(eocd + 20) > size) {
+            continue;
+        }
+
+        uint32_t cd_size = read_le32(eocd + 12);
+        uint32_t cd_offset = read_le32(eocd + 16);
+        if (cd_offset == kZip64Marker || cd_size == kZip64Marker) {
+            // ZIP64：目录范围记录在定位器指向的 ZIP64 EOCD 中，此处只确认定位器存在
+            bool has_locator = pos >= kZip64LocatorSize &&
+                               read_le32(eocd - kZip64LocatorSize) == kZip64LocatorSignature;
+            return has_locator ? Completeness::Complete : Completeness::Truncated;
+        }
+
+        uint64_t eocd_offset = tail_start + pos;
+        if (static_cast<uint64_t>(cd_offset) + cd_size > eocd_offset) {
+            return Completeness::Truncated;
+        }
+        // 自解压包等在 ZIP 之前附加了数据时，目录实际位于 eocd_offset - cd_size
+        uint64_t cd_start = eocd_offset - cd_size;
+        if (cd_size >= 4 && cd_start >= tail_start &&
+            read_le32(tail + (cd_start - tail_start)) != kZipCentralSignature) {
+            return Completeness::Truncated;
+        }
+        return Completeness::Complete;
+    }
+    return Completeness::Truncated;
+}
+
+/// GZIP：无法在不解压的情况下校验 CRC32，只确认尾部存在且 ISIZE 不超过压缩数据可能展开的大小
+Completeness check_gzip_end(const uint8_t* tail, size_t size, uint64_t file_size) {
+    if (file_size < kGzipMinMemberSize || size < kGzipTrailerSize) {
+        return Completeness::Truncated;
+    }
+    uint64_t isize = read_le32(tail + size - 4);
+    uint64_t max_expanded = (file_size - kGzipHeaderSize - kGzipTrailerSize) * kDeflateMaxRatio;
+    // ISIZE 为原始大小对 2^32 取模，展开上限超过 2^32 时无法据此判断
+    if (max_expanded < (uint64_t{1} << 32) && isize > max_expanded) {
+        return Completeness::Truncated;
+    }
+    return Completeness::Complete;
+}
+
 }  // namespace
 
+Completeness check_archive_end(Format format, const uint8_t* tail, size_t size,
+                               uint64_t file_size) noexcept {
+    if (tail == nullptr || size > file_size) {
+        return Completeness::Unchecked;
+    }
+    switch (format) {
+        case Format::ZIP:
+        case Format::DOCX:
+        case Format::XLSX:
+        case Format::PPTX:
+        case Format::EPUB:
+            return check_zip_end(tail, size, file_size);
+        case Format::GZip:
+            return check_gzip_end(tail, size, file_size);
+        default:
+            return Completeness::Unchecked;
+    }
+}
+
+bool is_encrypted_archive(ByteSource& reader, const uint8_t* head, size_t head_size,
+                          Format format) noexcept {
+    if (head == nullptr) {
+        return false;
+    }
+    switch (format) {
+        case Format::ZIP:
+        case Format::DOCX:
+        case Format::XLSX:
+        case Format::PPTX:
+        case Format::EPUB:
+            return is_encrypted_zip(head, head_size);
+        case Format::RAR:
+            return head_size >= sizeof(kRar5Magic) && mem_equal(head, kRar5Magic, sizeof(kRar5Magic))
+                       ? is_encrypted_rar5(head, head_size)
+                       : is_encrypted_rar4(head, head_size);
+        case Format::SevenZip:
+            return is_encrypted_7z(reader, head, head_size);
+        default:
+            return false;
+    }
+}
+
 Format detect_archive(const uint8_t* data, size_t size) noexcept {
     if (data == nullptr || size < 2) {
         return Format::Unknown;
@@ -47,11 +445,44 @@ Format detect_archive(const uint8_t* data, size_t size) noexcept {
         return Format::SevenZip;
     }
 
-    // GZIP: 1F 8B
-    if (size >= 2 && mem_equal(data, kGzipMagic, 2)) {
+    // GZIP: 1F 8B + CM/FLG 校验
+    if (size >= 2 && mem_equal(data, kGzipMagic, 2) && is_valid_gzip(data, size)) {
         return Format::GZip;
     }
 
+    // zstd: 28 B5 2F FD + 帧头描述符/窗口描述符校验
+    if (size >= 4 && mem_equal(data, kZstdMagic, 4) && is_valid_zstd(data, size)) {
+        return Format::Zstd;
+    }
+
+    // xz: FD 37 7A 58 5A 00 + Stream Flags CRC32 校验
+    if (size >= 6 && mem_equal(data, kXzMagic, 6) && is_valid_xz(data, size)) {
+        return Format::XZ;
+    }
+
+    // bzip2: "BZh" + 块大小 + 块头魔数
+    if (size >= 3 && mem_equal(data, kBzip2Magic, 3) && is_valid_bzip2(data, size)) {
+        return Format::BZip2;
+    }
+
+    // LZ4: 帧格式 04 22 4D 18（校验帧描述符）或旧版格式 02 21 4C 18
+    if (size >= 4) {
+        if ((mem_equal(data, kLz4FrameMagic, 4) && is_valid_lz4_frame(data, size)) ||
+            mem_equal(data, kLz4LegacyMagic, 4)) {
+            return Format::LZ4;
+        }
+    }
+
+    // Brotli: 原始 brotli 流没有魔数，只识别带帧头的封装
+    if (size >= 4 && mem_equal(data, kBrotliFrameMagic, 4)) {
+        return Format::Brotli;
+    }
+
+    // Unix compress: 1F 9D + 最大码长
+    if (size >= 2 && mem_equal(data, kCompressMagic, 2) && is_valid_compress(data, size)) {
+        return Format::UnixCompress;
+    }
+
     // TAR: "ustar" at offset 257
     if (size >= 262 && mem_equal(data + 257, kTarUstarMagic, 5)) {
         return Format::Tar;
@@ -86,7 +517,7 @@ Format detect_zip_content(const uint8_t* data, size_t size) noexcept {
     uint16_t extra_len = static_cast<uint16_t>(data[28]) |
                          (static_cast<uint16_t>(data[29]) << 8);
 
-    if (size < 30 + filename_len) {
+    if (size < 30 + static_cast<size_t>(filename_len)) {
         return Format::Unknown;
     }
 
@@ -112,17 +543,16 @@ Format detect_zip_content(const uint8_t* data, size_t size) noexcept {
         // 简化：查找特定目录
         // 完整实现需要解析 ZIP 中央目录
         
-        // 在数据中搜索特征字符串
-        std::string_view data_view(reinterpret_cast<const char*>(data),
-                                   std::min(size, static_cast<size_t>(4096)));
-        
-        if (data_view.find("word/") != std::string_view::npos) {
+        // 单遍搜索所有特征目录，命中最高优先级的 word/ 即可提前结束
+        uint32_t dirs = kOoxmlDirMatcher.scan(data, std::min(size, kMaxHeaderSize), kOoxmlWord);
+
+        if (dirs & kOoxmlWord) {
             return Format::DOCX;
         }
-        if (data_view.find("xl/") != std::string_view::npos) {
+        if (dirs & kOoxmlExcel) {
             return Format::XLSX;
         }
-        if (data_view.find("ppt/") != std::string_view::npos) {
+        if (dirs & kOoxmlPowerPoint) {
             return Format::PPTX;
         }
         
@@ -0,0 +1,37 @@
+#ifndef FILEFORMAT_FORMATS_BYTE_UTILS_HPP
+#define FILEFORMAT_FORMATS_BYTE_UTILS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fileformat {
+namespace detail {
+
+// 检测器内部共用的定长整数读取工具（调用方负责边界检查）
+
+/// 读取小端 16 位整数
+inline uint16_t read_le16(const uint8_t* p) noexcept {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+/// 读取小端 32 位整数
+inline uint32_t read_le32(const uint8_t* p) noexcept {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/// 读取大端 16 位整数
+inline uint16_t read_be16(const uint8_t* p) noexcept {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+/// 读取大端 32 位整数
+inline uint32_t read_be32(const uint8_t* p) noexcept {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_BYTE_UTILS_HPP
@@ -0,0 +1,37 @@
+#ifndef FILEFORMAT_FORMATS_CRC32_HPP
+#define FILEFORMAT_FORMATS_CRC32_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace fileformat {
+namespace detail {
+
+/// CRC-32（ISO-HDLC，与 zlib/PNG/GZIP/XZ 相同）查找表，编译期生成
+inline constexpr std::array<uint32_t, 256> kCrc32Table = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+/// 计算 CRC-32，可传入上一段的结果继续累计
+/// @param crc 之前数据的 CRC（首段为 0）
+inline uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) noexcept {
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCrc32Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_CRC32_HPP
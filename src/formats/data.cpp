@@ -0,0 +1,112 @@
+#include "fileformat/detector.hpp"
+
+#include <cstring>
+
+#include "formats/byte_utils.hpp"
+
+namespace fileformat {
+namespace detail {
+
+namespace {
+
+// Magic bytes 常量
+constexpr uint8_t kParquetMagic[] = {0x50, 0x41, 0x52, 0x31};  // "PAR1"
+constexpr uint8_t kParquetEncryptedMagic[] = {0x50, 0x41, 0x52, 0x45};  // "PARE"（加密页脚）
+constexpr uint8_t kOrcMagic[] = {0x4F, 0x52, 0x43};  // "ORC"
+constexpr uint8_t kAvroMagic[] = {0x4F, 0x62, 0x6A, 0x01};  // "Obj\x01"
+constexpr uint8_t kArrowMagic[] = {0x41, 0x52, 0x52, 0x4F, 0x57, 0x31};  // "ARROW1"
+constexpr uint8_t kSqliteMagic[] = {0x53, 0x51, 0x4C, 0x69, 0x74, 0x65, 0x20, 0x66, 0x6F,
+                                    0x72, 0x6D, 0x61, 0x74, 0x20, 0x33, 0x00};  // "SQLite format 3\0"
+
+// SQLite 数据库头中的页大小字段（大端，1 表示 65536）
+constexpr size_t kSqlitePageSizeOffset = 16;
+
+/// 比较内存
+inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
+    return std::memcmp(data, pattern, len) == 0;
+}
+
+bool is_ascii_alnum(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+/// 校验 SQLite 页大小：512 到 32768 之间的 2 的幂，或 1（65536）
+bool is_valid_sqlite(const uint8_t* data, size_t size) {
+    if (size < kSqlitePageSizeOffset + 2) {
+        return true;
+    }
+    uint16_t page_size = read_be16(data + kSqlitePageSizeOffset);
+    if (page_size == 1) {
+        return true;
+    }
+    return page_size >= 512 && (page_size & (page_size - 1)) == 0;
+}
+
+}  // namespace
+
+Format detect_data(const uint8_t* data, size_t size) noexcept {
+    if (data == nullptr || size < 3) {
+        return Format::Unknown;
+    }
+
+    // Parquet: 头尾均为 "PAR1"（头部在加密页脚模式下同样是 "PAR1"）
+    if (size >= 4 && mem_equal(data, kParquetMagic, 4)) {
+        return Format::Parquet;
+    }
+
+    // Avro 对象容器文件: "Obj\x01"
+    if (size >= 4 && mem_equal(data, kAvroMagic, 4)) {
+        return Format::Avro;
+    }
+
+    // Arrow IPC 文件格式（Feather v2）: "ARROW1" + 2 字节填充
+    if (size >= 6 && mem_equal(data, kArrowMagic, 6)) {
+        return Format::Arrow;
+    }
+
+    // SQLite 3: "SQLite format 3\0" + 页大小校验
+    if (size >= 16 && mem_equal(data, kSqliteMagic, 16) && is_valid_sqlite(data, size)) {
+        return Format::SQLite;
+    }
+
+    // ORC: 头部只有 3 字节 "ORC"，紧跟字母或数字时视为普通文本（如 "ORCHESTRA"）
+    if (mem_equal(data, kOrcMagic, 3) && (size == 3 || !is_ascii_alnum(data[3]))) {
+        return Format::ORC;
+    }
+
+    return Format::Unknown;
+}
+
+bool has_footer(Format format) noexcept {
+    return format == Format::Parquet || format == Format::ORC || format == Format::Arrow;
+}
+
+bool check_footer(Format format, const uint8_t* tail, size_t size) noexcept {
+    if (!has_footer(format)) {
+        return true;
+    }
+    if (tail == nullptr) {
+        return false;
+    }
+
+    switch (format) {
+        case Format::Parquet:
+            // 文件以 4 字节页脚长度 + "PAR1"/"PARE" 结束
+            return size >= 8 && (mem_equal(tail + size - 4, kParquetMagic, 4) ||
+                                 mem_equal(tail + size - 4, kParquetEncryptedMagic, 4));
+        case Format::ORC: {
+            // 最后一个字节是 postscript 长度，postscript 以字段 magic = "ORC" 结束
+            if (size < 4) {
+                return false;
+            }
+            return tail[size - 1] >= sizeof(kOrcMagic) && mem_equal(tail + size - 4, kOrcMagic, 3);
+        }
+        case Format::Arrow:
+            return size >= 6 && mem_equal(tail + size - 6, kArrowMagic, 6);
+        default:
+            return true;
+    }
+}
+
+}  // namespace detail
+}  // namespace fileformat
@@ -0,0 +1,121 @@
+#include "fileformat/detector.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include "formats/byte_utils.hpp"
+#include "formats/reader.hpp"
+
+namespace fileformat {
+namespace detail {
+
+namespace {
+
+// Magic bytes 常量
+constexpr uint8_t kQcowMagic[] = {0x51, 0x46, 0x49, 0xFB};  // "QFI\xFB"
+constexpr uint8_t kVhdxMagic[] = {0x76, 0x68, 0x64, 0x78, 0x66, 0x69, 0x6C, 0x65};  // "vhdxfile"
+constexpr uint8_t kVmdkSparseMagic[] = {0x4B, 0x44, 0x4D, 0x56};  // "KDMV"
+constexpr uint8_t kVhdCookie[] = {0x63, 0x6F, 0x6E, 0x65, 0x63, 0x74, 0x69, 0x78};  // "conectix"
+constexpr char kVmdkDescriptor[] = "# Disk DescriptorFile";
+
+// 卷识别序列中的标准标识（ECMA-119、ECMA-167）
+constexpr uint8_t kIso9660Id[] = {0x43, 0x44, 0x30, 0x30, 0x31};  // "CD001"
+constexpr uint8_t kUdfNsr02Id[] = {0x4E, 0x53, 0x52, 0x30, 0x32};  // "NSR02"
+constexpr uint8_t kUdfNsr03Id[] = {0x4E, 0x53, 0x52, 0x30, 0x33};  // "NSR03"
+
+// 卷识别序列从第 16 个 2048 字节扇区开始，每个描述符的标识位于偏移 1
+constexpr int64_t kVolumeSectorSize = 2048;
+constexpr int64_t kVolumeFirstSector = 16;
+constexpr size_t kVolumeProbeCount = 8;
+
+// 远偏移探测：卷识别序列的前 8 个描述符 + VHD 尾部 footer（早期 Virtual PC 写入 511 字节）
+constexpr ProbeRange kDiskImageProbes[] = {
+    {(kVolumeFirstSector + 0) * kVolumeSectorSize + 1, 5},
+    {(kVolumeFirstSector + 1) * kVolumeSectorSize + 1, 5},
+    {(kVolumeFirstSector + 2) * kVolumeSectorSize + 1, 5},
+    {(kVolumeFirstSector + 3) * kVolumeSectorSize + 1, 5},
+    {(kVolumeFirstSector + 4) * kVolumeSectorSize + 1, 5},
+    {(kVolumeFirstSector + 5) * kVolumeSectorSize + 1, 5},
+    {(kVolumeFirstSector + 6) * kVolumeSectorSize + 1, 5},
+    {(kVolumeFirstSector + 7) * kVolumeSectorSize + 1, 5},
+    {-512, 8},
+    {-511, 8},
+};
+constexpr size_t kDiskImageProbeCount = sizeof(kDiskImageProbes) / sizeof(kDiskImageProbes[0]);
+static_assert(kDiskImageProbeCount <= kMaxProbeRanges, "too many disk image probes");
+
+/// 比较内存
+inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
+    return std::memcmp(data, pattern, len) == 0;
+}
+
+bool view_equal(const ProbeView& view, const uint8_t* pattern, size_t len) {
+    return view.size >= len && mem_equal(view.data, pattern, len);
+}
+
+}  // namespace
+
+Format detect_disk_image(const uint8_t* data, size_t size) noexcept {
+    if (data == nullptr || size < 4) {
+        return Format::Unknown;
+    }
+
+    // qcow2: "QFI\xFB" + 版本号 2 或 3（大端）
+    if (size >= 8 && mem_equal(data, kQcowMagic, 4)) {
+        uint32_t version = read_be32(data + 4);
+        if (version == 2 || version == 3) {
+            return Format::QCOW2;
+        }
+    }
+
+    // VHDX: 文件类型标识 "vhdxfile"
+    if (size >= 8 && mem_equal(data, kVhdxMagic, 8)) {
+        return Format::VHDX;
+    }
+
+    // VHD 动态/差分磁盘: 文件开头有 footer 的副本
+    if (size >= 8 && mem_equal(data, kVhdCookie, 8)) {
+        return Format::VHD;
+    }
+
+    // VMDK: 稀疏扩展头 "KDMV" 或文本描述文件
+    if (mem_equal(data, kVmdkSparseMagic, 4)) {
+        return Format::VMDK;
+    }
+    constexpr size_t descriptor_len = sizeof(kVmdkDescriptor) - 1;
+    if (size >= descriptor_len && std::memcmp(data, kVmdkDescriptor, descriptor_len) == 0) {
+        return Format::VMDK;
+    }
+
+    return Format::Unknown;
+}
+
+Format detect_disk_image_far(ByteSource& reader) noexcept {
+    std::vector<uint8_t> scratch;
+    ProbeView views[kDiskImageProbeCount];
+    read_probes(reader, kDiskImageProbes, kDiskImageProbeCount, scratch, views);
+
+    // ISO 9660 主卷描述符位于第 16 扇区（ISO/UDF 桥接格式同样如此）
+    if (view_equal(views[0], kIso9660Id, sizeof(kIso9660Id))) {
+        return Format::ISO9660;
+    }
+
+    // 纯 UDF：卷识别序列中出现 NSR02/NSR03
+    for (size_t i = 0; i < kVolumeProbeCount; ++i) {
+        if (view_equal(views[i], kUdfNsr02Id, sizeof(kUdfNsr02Id)) ||
+            view_equal(views[i], kUdfNsr03Id, sizeof(kUdfNsr03Id))) {
+            return Format::UDF;
+        }
+    }
+
+    // 固定大小 VHD：只有文件尾的 footer
+    if (view_equal(views[kVolumeProbeCount], kVhdCookie, sizeof(kVhdCookie)) ||
+        view_equal(views[kVolumeProbeCount + 1], kVhdCookie, sizeof(kVhdCookie))) {
+        return Format::VHD;
+    }
+
+    return Format::Unknown;
+}
+
+}  // namespace detail
+}  // namespace fileformat
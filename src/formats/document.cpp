@@ -1,6 +1,12 @@
 #include "fileformat/detector.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "formats/byte_utils.hpp"
+#include "formats/reader.hpp"
 
 namespace fileformat {
 namespace detail {
@@ -11,6 +17,31 @@ namespace {
 constexpr uint8_t kPdfMagic[] = {0x25, 0x50, 0x44, 0x46};  // "%PDF"
 constexpr uint8_t kOleMagic[] = {0xD0, 0xCF, 0x11, 0xE0, 0xA1, 0xB1, 0x1A, 0xE1};
 
+// 线性化字典必须是文件中的第一个对象，位于前 1 KB 内（PDF 32000-1 附录 F）
+constexpr size_t kLinearizedSearchSize = 1024;
+
+// PDF 的 /Encrypt 引用位于 trailer 字典（或交叉引用流的字典）中，二者都在文件尾附近
+constexpr size_t kPdfTrailerSearchSize = 1024;
+constexpr std::string_view kPdfEncryptKey = "/Encrypt";
+constexpr std::string_view kPdfStartXref = "startxref";
+
+// 文件结束标记须位于最后 1024 字节内（PDF 32000-1 附录 H.3 的实现说明）
+constexpr size_t kPdfEofSearchSize = 1024;
+constexpr std::string_view kPdfEofMarker = "%%EOF";
+
+// OLE 复合文档头与目录条目（MS-CFB 2.2、2.6）
+constexpr size_t kOleSectorShiftOffset = 0x1E;
+constexpr size_t kOleFirstDirSectorOffset = 0x30;
+constexpr size_t kOleDifatOffset = 0x4C;      // 头部中的 109 个 DIFAT 条目（FAT 扇区号）
+constexpr size_t kOleHeaderDifatCount = 109;
+constexpr uint32_t kOleMaxRegularSector = 0xFFFFFFFA;  // 更大的值为 ENDOFCHAIN、FREESECT 等标记
+// 目录链最多跟随的扇区数：防止损坏或恶意构造的 FAT 形成环
+constexpr size_t kOleMaxDirSectors = 64;
+constexpr size_t kOleDirEntrySize = 128;
+constexpr size_t kOleDirNameLengthOffset = 0x40;
+// 加密的 OOXML 文档以 OLE 容器保存，数据位于 EncryptedPackage 流（MS-OFFCRYPTO 2.3.4.4）
+constexpr char16_t kOleEncryptedPackage[] = u"EncryptedPackage";
+
 /// 比较内存
 inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
     return std::memcmp(data, pattern, len) == 0;
@@ -26,8 +57,184 @@ Format detect_ole_type(const uint8_t* data, size_t size) {
     return Format::DOC;
 }
 
+std::string_view as_text(const uint8_t* data, size_t size) {
+    return {reinterpret_cast<const char*>(data), size};
+}
+
+/// 解析 startxref 之后的十进制偏移
+bool parse_startxref(std::string_view tail, uint64_t& offset) {
+    size_t pos = tail.rfind(kPdfStartXref);
+    if (pos == std::string_view::npos) {
+        return false;
+    }
+    pos += kPdfStartXref.size();
+    while (pos < tail.size() && (tail[pos] == ' ' || tail[pos] == '\r' || tail[pos] == '\n')) {
+        ++pos;
+    }
+    size_t digits = 0;
+    offset = 0;
+    for (; pos < tail.size() && tail[pos] >= '0' && tail[pos] <= '9'; ++pos, ++digits) {
+        offset = offset * 10 + static_cast<uint64_t>(tail[pos] - '0');
+    }
+    return digits > 0;
+}
+
+/// PDF：文件头（线性化文件的首页 trailer）与文件尾的 trailer 中是否引用了加密字典；
+/// 交叉引用流的字典不在文件尾时，按 startxref 再读取一次
+bool is_encrypted_pdf(ByteSource& reader, const uint8_t* head, size_t head_size) {
+    if (as_text(head, head_size).find(kPdfEncryptKey) != std::string_view::npos) {
+        return true;
+    }
+
+    std::vector<uint8_t> scratch;
+    ProbeView tail;
+    const ProbeRange trailer{-static_cast<int64_t>(kPdfTrailerSearchSize), kPdfTrailerSearchSize};
+    read_probes(reader, &trailer, 1, scratch, &tail);
+    std::string_view tail_text = as_text(tail.data, tail.size);
+    if (tail_text.find(kPdfEncryptKey) != std::string_view::npos) {
+        return true;
+    }
+
+    uint64_t xref = 0;
+    uint64_t tail_start = reader.size() - tail.size;
+    if (!parse_startxref(tail_text, xref) || xref < head_size || xref >= tail_start) {
+        return false;
+    }
+    uint8_t dict[kPdfTrailerSearchSize];
+    size_t count = reader.read_at(xref, dict, sizeof(dict));
+    return as_text(dict, count).find(kPdfEncryptKey) != std::string_view::npos;
+}
+
+/// 扇区中是否有名为 EncryptedPackage 的目录条目
+bool has_encrypted_package(const uint8_t* sector, size_t count) {
+    constexpr size_t name_units = sizeof(kOleEncryptedPackage) / sizeof(char16_t);
+    for (size_t entry = 0; entry + kOleDirEntrySize <= count; entry += kOleDirEntrySize) {
+        const uint8_t* name = sector + entry;
+        if (read_le16(name + kOleDirNameLengthOffset) != name_units * 2) {
+            continue;
+        }
+        bool match = true;
+        for (size_t i = 0; i < name_units && match; ++i) {
+            match = read_le16(name + i * 2) == static_cast<uint16_t>(kOleEncryptedPackage[i]);
+        }
+        if (match) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// 按 FAT 查找 sector 的下一个扇区；FAT 扇区号取自头部的 DIFAT，超出时返回 ENDOFCHAIN
+uint32_t next_ole_sector(ByteSource& reader, const uint8_t* head, size_t head_size,
+                         uint16_t shift, uint32_t sector) {
+    uint32_t per_fat_sector = (uint32_t{1} << shift) / 4;
+    uint32_t fat_index = sector / per_fat_sector;
+    size_t difat_entry = kOleDifatOffset + size_t{fat_index} * 4;
+    if (fat_index >= kOleHeaderDifatCount || difat_entry + 4 > head_size) {
+        return kOleMaxRegularSector;
+    }
+    uint32_t fat_sector = read_le32(head + difat_entry);
+    if (fat_sector >= kOleMaxRegularSector) {
+        return kOleMaxRegularSector;
+    }
+    uint64_t offset = ((static_cast<uint64_t>(fat_sector) + 1) << shift) +
+                      uint64_t{sector % per_fat_sector} * 4;
+    uint8_t next[4];
+    if (reader.read_at(offset, next, sizeof(next)) != sizeof(next)) {
+        return kOleMaxRegularSector;
+    }
+    return read_le32(next);
+}
+
+/// OLE：目录链中是否有 EncryptedPackage 流（沿 FAT 跟随至多 kOleMaxDirSectors 个扇区）
+bool is_encrypted_ole(ByteSource& reader, const uint8_t* head, size_t head_size) {
+    if (head_size < kOleFirstDirSectorOffset + 4) {
+        return false;
+    }
+    uint16_t shift = read_le16(head + kOleSectorShiftOffset);
+    if (shift != 9 && shift != 12) {
+        return false;
+    }
+    size_t sector_size = size_t{1} << shift;
+    uint32_t dir_sector = read_le32(head + kOleFirstDirSectorOffset);
+
+    std::vector<uint8_t> sector(sector_size);
+    for (size_t visited = 0; visited < kOleMaxDirSectors && dir_sector < kOleMaxRegularSector;
+         ++visited) {
+        uint64_t offset = (static_cast<uint64_t>(dir_sector) + 1) << shift;
+        size_t count = reader.read_at(offset, sector.data(), sector_size);
+        if (has_encrypted_package(sector.data(), count)) {
+            return true;
+        }
+        if (count < sector_size) {
+            break;
+        }
+        dir_sector = next_ole_sector(reader, head, head_size, shift, dir_sector);
+    }
+    return false;
+}
+
 }  // namespace
 
+bool is_encrypted_document(ByteSource& reader, const uint8_t* head, size_t head_size,
+                           Format format) noexcept {
+    if (head == nullptr) {
+        return false;
+    }
+    if (format == Format::PDF) {
+        return is_encrypted_pdf(reader, head, head_size);
+    }
+    if (head_size >= 8 && mem_equal(head, kOleMagic, 8)) {
+        return is_encrypted_ole(reader, head, head_size);
+    }
+    return false;
+}
+
+Completeness check_document_end(Format format, const uint8_t* tail, size_t size) noexcept {
+    if (tail == nullptr || format != Format::PDF) {
+        return Completeness::Unchecked;
+    }
+    size_t window = std::min(size, kPdfEofSearchSize);
+    std::string_view text = as_text(tail + size - window, window);
+    return text.find(kPdfEofMarker) != std::string_view::npos ? Completeness::Complete
+                                                              : Completeness::Truncated;
+}
+
+bool is_linearized_pdf(const uint8_t* data, size_t size, uint64_t file_size) noexcept {
+    if (data == nullptr) {
+        return false;
+    }
+    std::string_view head(reinterpret_cast<const char*>(data),
+                          std::min(size, kLinearizedSearchSize));
+    size_t dict = head.find("/Linearized");
+    if (dict == std::string_view::npos) {
+        return false;
+    }
+
+    // /L 记录线性化时的文件长度，增量更新后不再一致，此时线性化失效
+    size_t end = head.find(">>", dict);
+    std::string_view entries = head.substr(dict + 11, end == std::string_view::npos ? end : end - dict - 11);
+    for (size_t key = entries.find("/L"); key != std::string_view::npos;
+         key = entries.find("/L", key + 2)) {
+        size_t pos = key + 2;
+        if (pos < entries.size() && entries[pos] != ' ' && entries[pos] != '\r' &&
+            entries[pos] != '\n') {
+            continue;  // 其他以 /L 开头的键
+        }
+        while (pos < entries.size() && (entries[pos] == ' ' || entries[pos] == '\r' ||
+                                        entries[pos] == '\n')) {
+            ++pos;
+        }
+        uint64_t length = 0;
+        size_t digits = 0;
+        for (; pos < entries.size() && entries[pos] >= '0' && entries[pos] <= '9'; ++pos, ++digits) {
+            length = length * 10 + static_cast<uint64_t>(entries[pos] - '0');
+        }
+        return digits > 0 && length == file_size;
+    }
+    return true;  // 字典不完整或缺少 /L 时只依据 /Linearized 判断
+}
+
 Format detect_document(const uint8_t* data, size_t size) noexcept {
     if (data == nullptr || size < 4) {
         return Format::Unknown;
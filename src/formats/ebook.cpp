@@ -2,6 +2,8 @@
 
 #include <cstring>
 
+#include "formats/multi_matcher.hpp"
+
 namespace fileformat {
 namespace detail {
 
@@ -10,21 +12,15 @@ namespace {
 // Magic bytes 常量
 constexpr uint8_t kMobiMagic[] = {0x42, 0x4F, 0x4F, 0x4B, 0x4D, 0x4F, 0x42, 0x49};  // "BOOKMOBI"
 constexpr uint8_t kDjvuMagic[] = {0x41, 0x54, 0x26, 0x54, 0x46, 0x4F, 0x52, 0x4D};  // "AT&TFORM"
-constexpr uint8_t kXmlMagic[] = {0x3C, 0x3F, 0x78, 0x6D, 0x6C};  // "<?xml"
+
+// KF8 标记
+constexpr MultiMatcher<1, 4> kKf8Matcher({"KF8"});
 
 /// 比较内存
 inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
     return std::memcmp(data, pattern, len) == 0;
 }
 
-/// 检查 FB2 格式（XML 中包含 FictionBook 根元素）
-bool is_fb2(const uint8_t* data, size_t size) {
-    // 简单搜索 "FictionBook" 字符串
-    std::string_view view(reinterpret_cast<const char*>(data),
-                          std::min(size, static_cast<size_t>(1024)));
-    return view.find("FictionBook") != std::string_view::npos;
-}
-
 /// 检查 MOBI 是否为 AZW3/KF8 格式
 bool is_azw3(const uint8_t* data, size_t size) {
     // AZW3 在 EXTH 头中包含特定标记
@@ -39,13 +35,8 @@ bool is_azw3(const uint8_t* data, size_t size) {
     // 检查 EXTH 标志（位于 PalmDOC header 之后）
     // 这是简化检测，真实实现需要完整解析 MOBI 结构
     
-    std::string_view view(reinterpret_cast<const char*>(data), size);
     // KF8 标记通常在 EXTH 记录中
-    if (view.find("KF8") != std::string_view::npos) {
-        return true;
-    }
-    
-    return false;
+    return kKf8Matcher.scan(data, size) != 0;
 }
 
 }  // namespace
@@ -71,14 +62,8 @@ Format detect_ebook(const uint8_t* data, size_t size) noexcept {
         return Format::DJVU;
     }
 
-    // FB2: XML with FictionBook
-    if (size >= 5 && mem_equal(data, kXmlMagic, 5)) {
-        if (is_fb2(data, size)) {
-            return Format::FB2;
-        }
-    }
-
     // EPUB 检测在 archive.cpp 的 detect_zip_content 中处理
+    // FB2 检测在 text.cpp 的 XML 分类中处理
 
     return Format::Unknown;
 }
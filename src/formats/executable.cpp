@@ -2,6 +2,8 @@
 
 #include <cstring>
 
+#include "formats/byte_utils.hpp"
+
 namespace fileformat {
 namespace detail {
 
@@ -15,12 +17,276 @@ constexpr uint8_t kMachoMagic64[] = {0xFE, 0xED, 0xFA, 0xCF};  // Mach-O 64-bit
 constexpr uint8_t kMachoMagic32Rev[] = {0xCE, 0xFA, 0xED, 0xFE};  // Mach-O 32-bit (reversed)
 constexpr uint8_t kMachoMagic64Rev[] = {0xCF, 0xFA, 0xED, 0xFE};  // Mach-O 64-bit (reversed)
 constexpr uint8_t kMachoFatMagic[] = {0xCA, 0xFE, 0xBA, 0xBE};  // Mach-O Fat binary
+constexpr uint8_t kMachoFatMagic64[] = {0xCA, 0xFE, 0xBA, 0xBF};  // Mach-O Fat binary（64 位偏移）
+constexpr uint8_t kPeSignature[] = {0x50, 0x45, 0x00, 0x00};  // "PE\0\0"
+
+// DOS 头中 e_lfanew 字段的偏移（指向 PE 签名）
+constexpr size_t kLfanewOffset = 0x3C;
+
+// ELF 头（System V ABI）
+constexpr uint8_t kElfClass32 = 1;
+constexpr uint8_t kElfClass64 = 2;
+constexpr uint8_t kElfDataMsb = 2;
+constexpr uint16_t kElfTypeRel = 1;
+constexpr uint16_t kElfTypeExec = 2;
+constexpr uint16_t kElfTypeDyn = 3;
+constexpr uint16_t kElfTypeCore = 4;
+constexpr uint32_t kElfProgramInterp = 3;  // PT_INTERP
+
+// PE/COFF 头（PE Format 规范）
+constexpr size_t kCoffHeaderSize = 20;
+constexpr uint16_t kCoffExecutableImage = 0x0002;
+constexpr uint16_t kCoffDll = 0x2000;
+constexpr uint16_t kPeOptionalMagic32 = 0x10B;
+constexpr uint16_t kPeOptionalMagic64 = 0x20B;
+
+// Mach-O 头（mach-o/loader.h、mach-o/fat.h）
+constexpr uint32_t kMachoCpuArch64 = 0x01000000;
+constexpr uint32_t kMachoFileObject = 1;
+constexpr uint32_t kMachoFileExecute = 2;
+constexpr uint32_t kMachoFileCore = 4;
+constexpr uint32_t kMachoFileDylib = 6;
+constexpr uint32_t kMachoFileBundle = 8;
+constexpr size_t kMachoFatArchSize = 20;
+constexpr size_t kMachoFatArch64Size = 32;  // fat_arch_64：offset/size 为 64 位，另有保留字段
+// Java class 文件同样以 CAFEBABE 开头，其主版本号（>= 45）落在 nfat_arch 位置
+constexpr uint32_t kMachoMaxFatArch = 30;
 
 /// 比较内存
 inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
     return std::memcmp(data, pattern, len) == 0;
 }
 
+/// 校验 PE 文件：e_lfanew 必须指向头部缓冲区内的 "PE\0\0" 签名
+bool is_valid_pe(const uint8_t* data, size_t size) {
+    if (size < kLfanewOffset + 4) {
+        return false;
+    }
+    size_t pe_offset = read_le32(data + kLfanewOffset);
+    // PE 签名不能与 DOS 头重叠
+    if (pe_offset < kLfanewOffset + 4 || pe_offset > size - 4) {
+        return false;
+    }
+    return mem_equal(data + pe_offset, kPeSignature, 4);
+}
+
+Architecture elf_architecture(uint16_t machine) {
+    switch (machine) {
+        case 3:  // EM_386
+            return Architecture::X86;
+        case 62:  // EM_X86_64
+            return Architecture::X86_64;
+        case 40:  // EM_ARM
+            return Architecture::ARM;
+        case 183:  // EM_AARCH64
+            return Architecture::ARM64;
+        case 20:  // EM_PPC
+            return Architecture::PowerPC;
+        case 21:  // EM_PPC64
+            return Architecture::PowerPC64;
+        case 8:  // EM_MIPS
+            return Architecture::MIPS;
+        case 243:  // EM_RISCV
+            return Architecture::RISCV;
+        default:
+            return Architecture::Unknown;
+    }
+}
+
+Architecture coff_architecture(uint16_t machine) {
+    switch (machine) {
+        case 0x014C:
+            return Architecture::X86;
+        case 0x8664:
+            return Architecture::X86_64;
+        case 0x01C0:
+        case 0x01C4:
+            return Architecture::ARM;
+        case 0xAA64:
+            return Architecture::ARM64;
+        case 0x01F0:
+            return Architecture::PowerPC;
+        case 0x5032:
+        case 0x5064:
+            return Architecture::RISCV;
+        default:
+            return Architecture::Unknown;
+    }
+}
+
+Architecture macho_architecture(uint32_t cputype) {
+    switch (cputype) {
+        case 7:  // CPU_TYPE_X86
+            return Architecture::X86;
+        case 7 | kMachoCpuArch64:
+            return Architecture::X86_64;
+        case 12:  // CPU_TYPE_ARM
+            return Architecture::ARM;
+        case 12 | kMachoCpuArch64:
+            return Architecture::ARM64;
+        case 18:  // CPU_TYPE_POWERPC
+            return Architecture::PowerPC;
+        case 18 | kMachoCpuArch64:
+            return Architecture::PowerPC64;
+        default:
+            return Architecture::Unknown;
+    }
+}
+
+/// 按 ELF 头声明的字节序读取整数
+struct ElfReader {
+    const uint8_t* data;
+    bool big_endian;
+
+    uint16_t u16(size_t offset) const {
+        return big_endian ? read_be16(data + offset) : read_le16(data + offset);
+    }
+    uint32_t u32(size_t offset) const {
+        return big_endian ? read_be32(data + offset) : read_le32(data + offset);
+    }
+    uint64_t u64(size_t offset) const {
+        uint64_t high = u32(offset + (big_endian ? 0 : 4));
+        uint64_t low = u32(offset + (big_endian ? 4 : 0));
+        return (high << 32) | low;
+    }
+};
+
+/// 程序头表是否包含 PT_INTERP（ET_DYN 中区分 PIE 可执行程序与共享库）
+bool elf_has_interpreter(const ElfReader& elf, size_t size, bool is_64) {
+    uint64_t phoff = is_64 ? elf.u64(32) : elf.u32(28);
+    size_t entry_size = elf.u16(is_64 ? 54 : 42);
+    size_t count = elf.u16(is_64 ? 56 : 44);
+    if (entry_size < 4 || phoff >= size) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t entry = phoff + i * entry_size;
+        if (entry + 4 > size) {
+            break;
+        }
+        if (elf.u32(static_cast<size_t>(entry)) == kElfProgramInterp) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void probe_elf(const uint8_t* data, size_t size, ExecutableInfo& info) {
+    // e_ident(16) + e_type(2) + e_machine(2)
+    if (size < 20) {
+        return;
+    }
+    uint8_t elf_class = data[4];
+    info.big_endian = data[5] == kElfDataMsb;
+    info.bits = elf_class == kElfClass64 ? 64 : (elf_class == kElfClass32 ? 32 : 0);
+
+    ElfReader elf{data, info.big_endian};
+    info.machine = elf.u16(18);
+    info.architecture = elf_architecture(static_cast<uint16_t>(info.machine));
+
+    switch (elf.u16(16)) {
+        case kElfTypeRel:
+            info.kind = BinaryKind::Object;
+            break;
+        case kElfTypeExec:
+            info.kind = BinaryKind::Executable;
+            break;
+        case kElfTypeCore:
+            info.kind = BinaryKind::Core;
+            break;
+        case kElfTypeDyn: {
+            bool is_64 = info.bits == 64;
+            bool has_header = size >= (is_64 ? 64u : 52u);
+            info.kind = has_header && info.bits != 0 && elf_has_interpreter(elf, size, is_64)
+                            ? BinaryKind::Executable
+                            : BinaryKind::SharedLibrary;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void probe_pe(const uint8_t* data, size_t size, ExecutableInfo& info) {
+    // is_valid_pe 已保证签名位于缓冲区内
+    size_t coff = read_le32(data + kLfanewOffset) + 4;
+    if (coff + kCoffHeaderSize > size) {
+        return;
+    }
+    info.machine = read_le16(data + coff);
+    info.architecture = coff_architecture(static_cast<uint16_t>(info.machine));
+
+    uint16_t characteristics = read_le16(data + coff + 18);
+    if ((characteristics & kCoffDll) != 0) {
+        info.kind = BinaryKind::SharedLibrary;
+    } else if ((characteristics & kCoffExecutableImage) != 0) {
+        info.kind = BinaryKind::Executable;
+    }
+    // 两者都未置位的映像无法装载，不能据此推断为目标文件（COFF .obj 没有 MZ 头），保持 Unknown
+
+    size_t optional = coff + kCoffHeaderSize;
+    uint16_t optional_size = read_le16(data + coff + 16);
+    if (optional_size >= 2 && optional + 2 <= size) {
+        uint16_t magic = read_le16(data + optional);
+        info.bits = magic == kPeOptionalMagic64 ? 64 : (magic == kPeOptionalMagic32 ? 32 : 0);
+    }
+}
+
+void probe_macho(const uint8_t* data, size_t size, ExecutableInfo& info) {
+    bool fat64 = mem_equal(data, kMachoFatMagic64, 4);
+    if (fat64 || mem_equal(data, kMachoFatMagic, 4)) {
+        // fat_header 与 fat_arch(_64) 总是大端序，二者的 cputype 都位于条目开头
+        if (size < 8) {
+            return;
+        }
+        uint32_t count = read_be32(data + 4);
+        if (count == 0 || count > kMachoMaxFatArch) {
+            return;
+        }
+        info.fat = true;
+        info.big_endian = true;
+        for (uint32_t i = 0; i < count && info.slice_count < ExecutableInfo::kMaxSlices; ++i) {
+            size_t arch_size = fat64 ? kMachoFatArch64Size : kMachoFatArchSize;
+            size_t entry = 8 + static_cast<size_t>(i) * arch_size;
+            if (entry + arch_size > size) {
+                break;
+            }
+            info.slices[info.slice_count++] = macho_architecture(read_be32(data + entry));
+        }
+        return;
+    }
+
+    // mach_header：magic, cputype, cpusubtype, filetype
+    if (size < 16) {
+        return;
+    }
+    info.big_endian = mem_equal(data, kMachoMagic32, 4) || mem_equal(data, kMachoMagic64, 4);
+    info.bits = mem_equal(data, kMachoMagic64, 4) || mem_equal(data, kMachoMagic64Rev, 4) ? 64 : 32;
+    auto u32 = [&](size_t offset) {
+        return info.big_endian ? read_be32(data + offset) : read_le32(data + offset);
+    };
+    info.machine = u32(4);
+    info.architecture = macho_architecture(info.machine);
+
+    switch (u32(12)) {
+        case kMachoFileObject:
+            info.kind = BinaryKind::Object;
+            break;
+        case kMachoFileExecute:
+            info.kind = BinaryKind::Executable;
+            break;
+        case kMachoFileCore:
+            info.kind = BinaryKind::Core;
+            break;
+        case kMachoFileDylib:
+        case kMachoFileBundle:
+            info.kind = BinaryKind::SharedLibrary;
+            break;
+        default:
+            break;
+    }
+}
+
 }  // namespace
 
 Format detect_executable(const uint8_t* data, size_t size) noexcept {
@@ -28,8 +294,8 @@ Format detect_executable(const uint8_t* data, size_t size) noexcept {
         return Format::Unknown;
     }
 
-    // Windows PE/COFF: MZ header
-    if (size >= 2 && mem_equal(data, kMzMagic, 2)) {
+    // Windows PE/COFF: MZ header + e_lfanew 指向的 PE 签名
+    if (size >= 2 && mem_equal(data, kMzMagic, 2) && is_valid_pe(data, size)) {
         return Format::EXE;
     }
 
@@ -44,7 +310,8 @@ Format detect_executable(const uint8_t* data, size_t size) noexcept {
             mem_equal(data, kMachoMagic64, 4) ||
             mem_equal(data, kMachoMagic32Rev, 4) ||
             mem_equal(data, kMachoMagic64Rev, 4) ||
-            mem_equal(data, kMachoFatMagic, 4)) {
+            mem_equal(data, kMachoFatMagic, 4) ||
+            mem_equal(data, kMachoFatMagic64, 4)) {
             return Format::MachO;
         }
     }
@@ -53,5 +320,23 @@ Format detect_executable(const uint8_t* data, size_t size) noexcept {
 }
 
 }  // namespace detail
+
+//==============================================================================
+// 可执行文件信息
+//==============================================================================
+
+ExecutableInfo probe_executable(const uint8_t* data, size_t size) noexcept {
+    ExecutableInfo info;
+    info.format = detect(data, size);
+    switch (info.format) {
+        case Format::ELF:   detail::probe_elf(data, size, info); break;
+        case Format::EXE:   detail::probe_pe(data, size, info); break;
+        case Format::MachO: detail::probe_macho(data, size, info); break;
+        default:
+            break;
+    }
+    return info;
+}
+
 }  // namespace fileformat
 
@@ -1,6 +1,13 @@
 #include "fileformat/detector.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <string_view>
+
+#include "formats/byte_utils.hpp"
+#include "formats/crc32.hpp"
+#include "formats/reader.hpp"
 
 namespace fileformat {
 namespace detail {
@@ -18,11 +25,405 @@ constexpr uint8_t kWebpMagic[] = {0x57, 0x45, 0x42, 0x50};  // "WEBP"
 constexpr uint8_t kTiffLeMagic[] = {0x49, 0x49, 0x2A, 0x00};  // Little-endian
 constexpr uint8_t kTiffBeMagic[] = {0x4D, 0x4D, 0x00, 0x2A};  // Big-endian
 
+// PNG 的最后一个块：长度 0 + "IEND" + CRC
+constexpr uint8_t kPngIendType[] = {0x49, 0x45, 0x4E, 0x44};  // "IEND"
+constexpr size_t kPngIendChunkSize = 12;
+
 /// 比较内存
 inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
     return std::memcmp(data, pattern, len) == 0;
 }
 
+/// 校验 BMP 文件头："BM" 之后偏移 14 处的 DIB 头大小必须是已知取值
+bool is_valid_bmp(const uint8_t* data, size_t size) {
+    // BITMAPFILEHEADER (14 字节) + DIB 头大小字段 (4 字节)
+    if (size < 18) {
+        return false;
+    }
+    switch (read_le32(data + 14)) {
+        case 12:   // BITMAPCOREHEADER / OS21XBITMAPHEADER
+        case 16:   // OS22XBITMAPHEADER（精简版）
+        case 40:   // BITMAPINFOHEADER
+        case 52:   // BITMAPV2INFOHEADER
+        case 56:   // BITMAPV3INFOHEADER
+        case 64:   // OS22XBITMAPHEADER
+        case 108:  // BITMAPV4HEADER
+        case 124:  // BITMAPV5HEADER
+            return true;
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+// 图像头部解析
+//==============================================================================
+
+// PNG IHDR 颜色类型 -> 通道数（无效类型为 0）
+constexpr uint8_t kPngChannels[7] = {1, 0, 3, 1, 2, 0, 4};
+
+// JPEG 标记
+constexpr uint8_t kJpegSoi = 0xD8;
+constexpr uint8_t kJpegEoi = 0xD9;
+constexpr uint8_t kJpegSos = 0xDA;
+constexpr uint8_t kJpegTem = 0x01;
+
+// TIFF 标签与字段类型
+constexpr uint16_t kTiffTagImageWidth = 256;
+constexpr uint16_t kTiffTagImageLength = 257;
+constexpr uint16_t kTiffTagBitsPerSample = 258;
+constexpr uint16_t kTiffTagSamplesPerPixel = 277;
+constexpr uint16_t kTiffTagMake = 271;
+constexpr uint16_t kTiffTagPhotometric = 262;
+constexpr uint16_t kTiffTagSubIfds = 330;
+constexpr uint16_t kTiffTagDngVersion = 50706;
+constexpr uint16_t kTiffTagSr2Private = 50740;  // Sony ARW 在 IFD0 中的私有数据（DNGPrivateData）
+constexpr uint32_t kTiffPhotometricCfa = 32803;  // 拜耳阵列原始数据
+constexpr uint16_t kTiffTypeAscii = 2;
+constexpr uint16_t kTiffTypeShort = 3;
+constexpr uint16_t kTiffTypeLong = 4;
+constexpr uint16_t kTiffTypeIfd = 13;
+constexpr size_t kTiffEntrySize = 12;
+
+// IFD0 遍历的条目上限（相机 RAW 的 IFD0 通常只有几十个条目）
+constexpr size_t kMaxTiffEntries = 256;
+constexpr size_t kMaxTiffSubIfds = 4;  // 检查的 SubIFDs 条目数上限
+
+/// PNG：IHDR 必须是第一个块
+void probe_png(const uint8_t* data, size_t size, ImageInfo& info) {
+    if (size < 26 || std::memcmp(data + 12, "IHDR", 4) != 0) {
+        return;
+    }
+    uint8_t color_type = data[25];
+    if (color_type >= sizeof(kPngChannels) || kPngChannels[color_type] == 0) {
+        return;
+    }
+    info.width = read_be32(data + 16);
+    info.height = read_be32(data + 20);
+    info.bit_depth = data[24];
+    info.channels = kPngChannels[color_type];
+}
+
+/// SOF0..SOF15，排除 DHT (C4)、JPG (C8)、DAC (CC)
+bool is_jpeg_sof(uint8_t marker) {
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+           marker != 0xCC;
+}
+
+/// 从 pos 开始逐段扫描 JPEG 标记直到 SOFn
+/// @param base data[0] 在文件中的偏移
+/// 所需数据超出缓冲区时把下一个标记的文件偏移写入 info.resume_offset
+void scan_jpeg_markers(const uint8_t* data, size_t size, size_t pos, uint64_t base,
+                       ImageInfo& info) {
+    while (true) {
+        if (pos > size || size - pos < 4) {
+            info.resume_offset = base + pos;
+            return;
+        }
+        if (data[pos] != 0xFF) {
+            return;  // 标记段损坏
+        }
+        uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            ++pos;  // 填充字节
+            continue;
+        }
+        if (marker == kJpegSoi || marker == kJpegTem || (marker >= 0xD0 && marker <= 0xD7)) {
+            pos += 2;  // 无长度字段的独立标记
+            continue;
+        }
+        if (marker == kJpegEoi || marker == kJpegSos) {
+            return;  // 图像数据之前没有帧头
+        }
+
+        size_t length = read_be16(data + pos + 2);
+        if (length < 2) {
+            return;
+        }
+        if (is_jpeg_sof(marker)) {
+            // 长度(2) 精度(1) 高(2) 宽(2) 分量数(1)
+            if (size - pos < 10) {
+                info.resume_offset = base + pos;
+                return;
+            }
+            info.bit_depth = data[pos + 4];
+            info.height = read_be16(data + pos + 5);
+            info.width = read_be16(data + pos + 7);
+            info.channels = data[pos + 9];
+            return;
+        }
+        pos += 2 + length;
+    }
+}
+
+/// GIF：逻辑屏幕描述符紧随 6 字节签名
+void probe_gif(const uint8_t* data, size_t size, ImageInfo& info) {
+    if (size < 11) {
+        return;
+    }
+    uint8_t packed = data[10];
+    info.width = read_le16(data + 6);
+    info.height = read_le16(data + 8);
+    // 有全局调色板时按调色板大小，否则按原始颜色分辨率
+    info.bit_depth = static_cast<uint8_t>(((packed & 0x80) ? (packed & 0x07) : ((packed >> 4) & 0x07)) + 1);
+    info.channels = 1;
+}
+
+/// BMP：BITMAPCOREHEADER 使用 16 位宽高，其余 DIB 头使用有符号 32 位（高度为负表示自上而下）
+void probe_bmp(const uint8_t* data, size_t size, ImageInfo& info) {
+    uint32_t dib_size = read_le32(data + 14);
+    uint16_t bits_per_pixel = 0;
+    if (dib_size == 12) {
+        if (size < 26) {
+            return;
+        }
+        info.width = read_le16(data + 18);
+        info.height = read_le16(data + 20);
+        bits_per_pixel = read_le16(data + 24);
+    } else {
+        if (size < 30) {
+            return;
+        }
+        auto width = static_cast<int32_t>(read_le32(data + 18));
+        auto height = static_cast<int32_t>(read_le32(data + 22));
+        info.width = static_cast<uint32_t>(std::abs(static_cast<int64_t>(width)));
+        info.height = static_cast<uint32_t>(std::abs(static_cast<int64_t>(height)));
+        bits_per_pixel = read_le16(data + 28);
+    }
+
+    switch (bits_per_pixel) {
+        case 32:
+            info.bit_depth = 8;
+            info.channels = 4;
+            break;
+        case 24:
+            info.bit_depth = 8;
+            info.channels = 3;
+            break;
+        case 16:
+            info.bit_depth = 5;
+            info.channels = 3;
+            break;
+        default:
+            info.bit_depth = static_cast<uint8_t>(bits_per_pixel);
+            info.channels = 1;
+            break;
+    }
+}
+
+/// WebP：RIFF 头之后的第一个块为 VP8（有损）、VP8L（无损）或 VP8X（扩展）
+void probe_webp(const uint8_t* data, size_t size, ImageInfo& info) {
+    if (size < 30) {
+        return;
+    }
+    const uint8_t* chunk = data + 12;
+    info.bit_depth = 8;
+    if (std::memcmp(chunk, "VP8 ", 4) == 0) {
+        // 3 字节帧标记 + 起始码 9D 01 2A + 14 位宽高
+        if (chunk[11] != 0x9D || chunk[12] != 0x01 || chunk[13] != 0x2A) {
+            info.bit_depth = 0;
+            return;
+        }
+        info.width = read_le16(chunk + 14) & 0x3FFF;
+        info.height = read_le16(chunk + 16) & 0x3FFF;
+        info.channels = 3;
+    } else if (std::memcmp(chunk, "VP8L", 4) == 0) {
+        // 签名 0x2F + 14 位 (宽-1) + 14 位 (高-1) + 1 位 alpha
+        if (chunk[8] != 0x2F) {
+            info.bit_depth = 0;
+            return;
+        }
+        uint32_t bits = read_le32(chunk + 9);
+        info.width = (bits & 0x3FFF) + 1;
+        info.height = ((bits >> 14) & 0x3FFF) + 1;
+        info.channels = (bits >> 28) & 0x01 ? 4 : 3;
+    } else if (std::memcmp(chunk, "VP8X", 4) == 0) {
+        // 标志(1) 保留(3) + 24 位 (画布宽-1) + 24 位 (画布高-1)
+        uint32_t flags = chunk[8];
+        info.width = (read_le16(chunk + 12) | (static_cast<uint32_t>(chunk[14]) << 16)) + 1;
+        info.height = (read_le16(chunk + 15) | (static_cast<uint32_t>(chunk[17]) << 16)) + 1;
+        info.channels = (flags & 0x10) ? 4 : 3;
+    } else {
+        info.bit_depth = 0;
+    }
+}
+
+/// 按 TIFF 头声明的字节序读取
+struct TiffReader {
+    const uint8_t* data;
+    size_t size;
+    bool big_endian;
+
+    uint16_t u16(size_t offset) const {
+        return big_endian ? read_be16(data + offset) : read_le16(data + offset);
+    }
+    uint32_t u32(size_t offset) const {
+        return big_endian ? read_be32(data + offset) : read_le32(data + offset);
+    }
+
+    /// 读取 IFD 条目的第一个 SHORT/LONG 值（值超过 4 字节时按偏移读取）
+    bool first_value(size_t entry, uint32_t& value) const {
+        uint16_t type = u16(entry + 2);
+        uint32_t count = u32(entry + 4);
+        size_t width = type == kTiffTypeShort ? 2 : type == kTiffTypeLong ? 4 : 0;
+        if (width == 0 || count == 0) {
+            return false;
+        }
+        size_t pos = entry + 8;
+        if (count * width > 4) {
+            pos = u32(entry + 8);
+            if (pos > size || size - pos < width) {
+                return false;
+            }
+        }
+        value = width == 2 ? u16(pos) : u32(pos);
+        return true;
+    }
+
+    /// 读取 IFD 条目的 ASCII 值（不含结尾 NUL），值不在缓冲区内时返回空
+    std::string_view ascii(size_t entry) const {
+        uint32_t count = u32(entry + 4);
+        if (u16(entry + 2) != kTiffTypeAscii || count == 0) {
+            return {};
+        }
+        size_t pos = entry + 8;
+        if (count > 4) {
+            pos = u32(entry + 8);
+            if (pos > size || size - pos < count) {
+                return {};
+            }
+        }
+        std::string_view value(reinterpret_cast<const char*>(data + pos), count);
+        return value.substr(0, value.find('\0'));
+    }
+};
+
+/// SubIFDs 指向的子 IFD 中是否有 CFA 原始数据（只检查缓冲区内的前几个子 IFD）
+bool has_cfa_subifd(const TiffReader& tiff, size_t entry) {
+    uint16_t type = tiff.u16(entry + 2);
+    if (type != kTiffTypeLong && type != kTiffTypeIfd) {
+        return false;
+    }
+    uint32_t count = tiff.u32(entry + 4);
+    size_t pos = entry + 8;
+    if (count > 1) {
+        pos = tiff.u32(entry + 8);
+    }
+    size_t subifds = std::min<size_t>(count, kMaxTiffSubIfds);
+    for (size_t i = 0; i < subifds; ++i) {
+        if (pos > tiff.size || (tiff.size - pos) / 4 <= i) {
+            return false;
+        }
+        size_t ifd = tiff.u32(pos + i * 4);
+        if (ifd > tiff.size || tiff.size - ifd < 2) {
+            continue;
+        }
+        size_t entries = std::min<size_t>(tiff.u16(ifd), kMaxTiffEntries);
+        entries = std::min(entries, (tiff.size - ifd - 2) / kTiffEntrySize);
+        for (size_t e = 0; e < entries; ++e) {
+            size_t sub = ifd + 2 + e * kTiffEntrySize;
+            uint32_t photometric = 0;
+            if (tiff.u16(sub) == kTiffTagPhotometric && tiff.first_value(sub, photometric) &&
+                photometric == kTiffPhotometricCfa) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// TIFF 派生格式：CR2 在头部偏移 8 处有 "CR" 标记，DNG 在 IFD0 中有 DNGVersion；
+/// NEF/ARW 除 IFD0 的 Make 标签外还要求原始数据的标志（含 CFA 数据的 SubIFDs，ARW 另可为
+/// SR2Private），仅有厂商名的 TIFF（如相机导出的处理后图像）仍为 TIFF。
+/// 只遍历头部缓冲区内的 IFD0 及其子 IFD，条目数有上限
+Format classify_tiff(const uint8_t* data, size_t size) {
+    if (size >= 10 && data[0] == 'I' && data[8] == 'C' && data[9] == 'R') {
+        return Format::CR2;
+    }
+    if (size < 8) {
+        return Format::TIFF;
+    }
+    TiffReader tiff{data, size, data[0] == 'M'};
+    size_t ifd = tiff.u32(4);
+    if (ifd > size || size - ifd < 2) {
+        return Format::TIFF;
+    }
+
+    size_t count = std::min<size_t>(tiff.u16(ifd), kMaxTiffEntries);
+    size_t entries = std::min(count, (size - ifd - 2) / kTiffEntrySize);
+    std::string_view make;
+    bool cfa = false;
+    bool sr2 = false;
+    for (size_t i = 0; i < entries; ++i) {
+        size_t entry = ifd + 2 + i * kTiffEntrySize;
+        uint16_t tag = tiff.u16(entry);
+        if (tag == kTiffTagDngVersion) {
+            return Format::DNG;  // DNG 可能由任何厂商的相机生成，优先于 Make
+        }
+        if (tag == kTiffTagMake) {
+            make = tiff.ascii(entry);
+        } else if (tag == kTiffTagSubIfds) {
+            cfa = has_cfa_subifd(tiff, entry);
+        } else if (tag == kTiffTagSr2Private) {
+            sr2 = true;
+        }
+    }
+
+    if (make.substr(0, 5) == "NIKON" && cfa) {
+        return Format::NEF;
+    }
+    if (make.substr(0, 4) == "SONY" && (cfa || sr2)) {
+        return Format::ARW;
+    }
+    return Format::TIFF;
+}
+
+/// TIFF：遍历 IFD0 中的宽高、位深与每像素样本数
+void probe_tiff(const uint8_t* data, size_t size, ImageInfo& info) {
+    if (size < 8) {
+        return;
+    }
+    TiffReader tiff{data, size, data[0] == 'M'};
+    size_t ifd = tiff.u32(4);
+    if (ifd > size || size - ifd < 2) {
+        return;
+    }
+
+    size_t count = tiff.u16(ifd);
+    size_t entries = std::min(count, (size - ifd - 2) / kTiffEntrySize);
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t bits = 1;      // BitsPerSample 缺省值
+    uint32_t samples = 1;   // SamplesPerPixel 缺省值
+    for (size_t i = 0; i < entries; ++i) {
+        size_t entry = ifd + 2 + i * kTiffEntrySize;
+        switch (tiff.u16(entry)) {
+            case kTiffTagImageWidth:
+                tiff.first_value(entry, width);
+                break;
+            case kTiffTagImageLength:
+                tiff.first_value(entry, height);
+                break;
+            case kTiffTagBitsPerSample:
+                tiff.first_value(entry, bits);
+                break;
+            case kTiffTagSamplesPerPixel:
+                tiff.first_value(entry, samples);
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (width == 0 || height == 0) {
+        return;
+    }
+    info.width = width;
+    info.height = height;
+    info.bit_depth = static_cast<uint8_t>(bits);
+    info.channels = static_cast<uint8_t>(samples);
+}
+
 }  // namespace
 
 Format detect_image(const uint8_t* data, size_t size) noexcept {
@@ -40,8 +441,8 @@ Format detect_image(const uint8_t* data, size_t size) noexcept {
         return Format::JPEG;
     }
 
-    // BMP: 42 4D ("BM")
-    if (size >= 2 && mem_equal(data, kBmpMagic, 2)) {
+    // BMP: 42 4D ("BM") + 合法的 DIB 头大小
+    if (size >= 2 && mem_equal(data, kBmpMagic, 2) && is_valid_bmp(data, size)) {
         return Format::BMP;
     }
 
@@ -61,16 +462,90 @@ Format detect_image(const uint8_t* data, size_t size) noexcept {
         // WAV 和 AVI 在 media.cpp 中处理
     }
 
-    // TIFF: II*\0 (little-endian) 或 MM\0* (big-endian)
+    // TIFF: II*\0 (little-endian) 或 MM\0* (big-endian)，再区分相机 RAW
     if (size >= 4) {
         if (mem_equal(data, kTiffLeMagic, 4) || mem_equal(data, kTiffBeMagic, 4)) {
-            return Format::TIFF;
+            return classify_tiff(data, size);
         }
     }
 
     return Format::Unknown;
 }
 
+Completeness check_image_end(Format format, const uint8_t* tail, size_t size) noexcept {
+    if (tail == nullptr) {
+        return Completeness::Unchecked;
+    }
+
+    if (format == Format::PNG) {
+        // IEND 是最后一个块，其后允许附加数据
+        uint32_t iend_crc = crc32(kPngIendType, sizeof(kPngIendType));
+        for (size_t end = size; end >= kPngIendChunkSize; --end) {
+            const uint8_t* chunk = tail + end - kPngIendChunkSize;
+            if (read_be32(chunk) == 0 && mem_equal(chunk + 4, kPngIendType, 4) &&
+                read_be32(chunk + 8) == iend_crc) {
+                return Completeness::Complete;
+            }
+        }
+        return Completeness::Truncated;
+    }
+
+    if (format == Format::JPEG) {
+        // EOI 之后常见补零或换行填充
+        size_t end = size;
+        while (end > 0 && (tail[end - 1] == 0x00 || tail[end - 1] == '\r' || tail[end - 1] == '\n')) {
+            --end;
+        }
+        bool has_eoi = end >= 2 && tail[end - 2] == 0xFF && tail[end - 1] == kJpegEoi;
+        return has_eoi ? Completeness::Complete : Completeness::Truncated;
+    }
+
+    return Completeness::Unchecked;
+}
+
 }  // namespace detail
-}  // namespace fileformat
 
+//==============================================================================
+// 图像信息 API
+//==============================================================================
+
+ImageInfo probe_image(const uint8_t* data, size_t size) noexcept {
+    ImageInfo info;
+    info.format = detail::detect_image(data, size);
+
+    switch (info.format) {
+        case Format::PNG:
+            detail::probe_png(data, size, info);
+            break;
+        case Format::JPEG:
+            detail::scan_jpeg_markers(data, size, 2, 0, info);
+            break;
+        case Format::GIF:
+            detail::probe_gif(data, size, info);
+            break;
+        case Format::BMP:
+            detail::probe_bmp(data, size, info);
+            break;
+        case Format::WebP:
+            detail::probe_webp(data, size, info);
+            break;
+        case Format::TIFF:
+            detail::probe_tiff(data, size, info);
+            break;
+        default:
+            break;
+    }
+    return info;
+}
+
+ImageInfo resume_probe_image(const ImageInfo& partial, const uint8_t* data, size_t size) noexcept {
+    ImageInfo info = partial;
+    if (partial.format != Format::JPEG || partial.resume_offset == 0 || data == nullptr) {
+        return info;
+    }
+    info.resume_offset = 0;
+    detail::scan_jpeg_markers(data, size, 0, partial.resume_offset, info);
+    return info;
+}
+
+}  // namespace fileformat
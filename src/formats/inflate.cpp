@@ -0,0 +1,384 @@
+#include "formats/inflate.hpp"
+
+#include <array>
+#include <cstring>
+
+#include "formats/byte_utils.hpp"
+
+namespace fileformat {
+namespace detail {
+
+namespace {
+
+// deflate 编码参数（RFC 1951 3.2.5）
+constexpr int kMaxBits = 15;            // Huffman 码最大长度
+constexpr int kMaxLengthCodes = 286;    // 字面量/长度码数量上限
+constexpr int kMaxDistanceCodes = 30;   // 距离码数量上限
+constexpr int kFixedLengthCodes = 288;  // 固定 Huffman 表的字面量/长度码数量
+constexpr int kEndOfBlock = 256;
+
+// 长度码 257..285 的基础值与附加位数
+constexpr std::array<uint16_t, 29> kLengthBase = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<uint8_t, 29> kLengthExtra = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+// 距离码 0..29 的基础值与附加位数
+constexpr std::array<uint16_t, 30> kDistanceBase = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<uint8_t, 30> kDistanceExtra = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// 动态块中码长码的传输顺序
+constexpr std::array<uint8_t, 19> kCodeLengthOrder = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// GZIP 头标志位（RFC 1952）
+constexpr uint8_t kGzipFlagHcrc = 0x02;
+constexpr uint8_t kGzipFlagExtra = 0x04;
+constexpr uint8_t kGzipFlagName = 0x08;
+constexpr uint8_t kGzipFlagComment = 0x10;
+constexpr size_t kGzipHeaderSize = 10;
+
+/// 规范 Huffman 表：按码长计数，符号按码值顺序排列
+struct Huffman {
+    std::array<uint16_t, kMaxBits + 1> count{};
+    std::array<uint16_t, kFixedLengthCodes> symbol{};
+};
+
+/// 由码长数组构建 Huffman 表，码长超额分配时返回 false（不完整的码表允许，解码时按错误处理）
+bool build_huffman(Huffman& h, const uint8_t* lengths, int n) {
+    h.count.fill(0);
+    for (int i = 0; i < n; ++i) {
+        ++h.count[lengths[i]];
+    }
+    if (h.count[0] == n) {
+        return true;  // 无任何编码，解码时遇到即为错误
+    }
+
+    int left = 1;
+    for (int len = 1; len <= kMaxBits; ++len) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    std::array<uint16_t, kMaxBits + 1> offsets{};
+    for (int len = 1; len < kMaxBits; ++len) {
+        offsets[len + 1] = static_cast<uint16_t>(offsets[len] + h.count[len]);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (lengths[i] != 0) {
+            h.symbol[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+        }
+    }
+    return true;
+}
+
+/// 固定 Huffman 表（RFC 1951 3.2.6），首次使用时构建
+struct FixedTables {
+    Huffman lengths;
+    Huffman distances;
+
+    FixedTables() {
+        std::array<uint8_t, kFixedLengthCodes> bits{};
+        for (int i = 0; i < kFixedLengthCodes; ++i) {
+            bits[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        }
+        build_huffman(lengths, bits.data(), kFixedLengthCodes);
+        bits.fill(5);
+        build_huffman(distances, bits.data(), kMaxDistanceCodes);
+    }
+};
+
+/// 有界解压状态
+class Inflater {
+public:
+    Inflater(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size)
+        : in_(in), in_size_(in_size), out_(out), out_size_(out_size) {}
+
+    size_t run() {
+        bool last = false;
+        while (!last && !stopped()) {
+            last = bits(1) != 0;
+            int type = bits(2);
+            if (stopped()) {
+                break;
+            }
+            switch (type) {
+                case 0:
+                    stored();
+                    break;
+                case 1: {
+                    static const FixedTables kFixed;
+                    codes(kFixed.lengths, kFixed.distances);
+                    break;
+                }
+                case 2:
+                    dynamic();
+                    break;
+                default:
+                    failed_ = true;
+                    break;
+            }
+        }
+        return produced_;
+    }
+
+private:
+    /// 输入耗尽、输出写满或数据损坏时停止
+    bool stopped() const { return failed_ || produced_ == out_size_; }
+
+    /// 从输入读取 need 位（LSB 优先），输入不足时置失败标志
+    int bits(int need) {
+        uint32_t value = bit_buffer_;
+        while (bit_count_ < need) {
+            if (in_pos_ == in_size_) {
+                failed_ = true;
+                return 0;
+            }
+            value |= static_cast<uint32_t>(in_[in_pos_++]) << bit_count_;
+            bit_count_ += 8;
+        }
+        bit_buffer_ = value >> need;
+        bit_count_ -= need;
+        return static_cast<int>(value & ((1u << need) - 1));
+    }
+
+    /// 逐位解码一个符号，失败时返回 -1
+    int decode(const Huffman& h) {
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int len = 1; len <= kMaxBits; ++len) {
+            code |= bits(1);
+            if (failed_) {
+                return -1;
+            }
+            int count = h.count[len];
+            if (code - count < first) {
+                return h.symbol[index + (code - first)];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        failed_ = true;
+        return -1;
+    }
+
+    /// 未压缩块：LEN/NLEN 后直接复制
+    void stored() {
+        bit_buffer_ = 0;
+        bit_count_ = 0;
+        if (in_size_ - in_pos_ < 4) {
+            failed_ = true;
+            return;
+        }
+        uint16_t len = read_le16(in_ + in_pos_);
+        uint16_t nlen = read_le16(in_ + in_pos_ + 2);
+        in_pos_ += 4;
+        if (len != static_cast<uint16_t>(~nlen)) {
+            failed_ = true;
+            return;
+        }
+
+        size_t copy = len;
+        if (copy > in_size_ - in_pos_) {
+            copy = in_size_ - in_pos_;
+            failed_ = true;  // 截断：复制已有部分后停止
+        }
+        if (copy > out_size_ - produced_) {
+            copy = out_size_ - produced_;
+        }
+        std::memcpy(out_ + produced_, in_ + in_pos_, copy);
+        produced_ += copy;
+        in_pos_ += copy;
+    }
+
+    /// 按给定 Huffman 表解码一个压缩块的数据
+    void codes(const Huffman& lengths, const Huffman& distances) {
+        while (!stopped()) {
+            int symbol = decode(lengths);
+            if (symbol < 0 || symbol == kEndOfBlock) {
+                return;
+            }
+            if (symbol < kEndOfBlock) {
+                out_[produced_++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+
+            symbol -= kEndOfBlock + 1;
+            if (symbol >= static_cast<int>(kLengthBase.size())) {
+                failed_ = true;
+                return;
+            }
+            size_t len = kLengthBase[symbol] + static_cast<size_t>(bits(kLengthExtra[symbol]));
+
+            symbol = decode(distances);
+            if (symbol < 0 || symbol >= kMaxDistanceCodes) {
+                failed_ = true;
+                return;
+            }
+            size_t dist = kDistanceBase[symbol] + static_cast<size_t>(bits(kDistanceExtra[symbol]));
+            if (failed_ || dist > produced_) {
+                failed_ = true;  // 回溯超出已输出数据
+                return;
+            }
+
+            // 逐字节复制以支持重叠回溯（dist < len）
+            if (len > out_size_ - produced_) {
+                len = out_size_ - produced_;
+            }
+            for (size_t i = 0; i < len; ++i) {
+                out_[produced_] = out_[produced_ - dist];
+                ++produced_;
+            }
+        }
+    }
+
+    /// 动态 Huffman 块：先读码长码表，再读字面量/长度与距离码长
+    void dynamic() {
+        int nlen = bits(5) + 257;
+        int ndist = bits(5) + 1;
+        int ncode = bits(4) + 4;
+        if (failed_ || nlen > kMaxLengthCodes || ndist > kMaxDistanceCodes) {
+            failed_ = true;
+            return;
+        }
+
+        std::array<uint8_t, kMaxLengthCodes + kMaxDistanceCodes> lengths{};
+        for (int i = 0; i < ncode; ++i) {
+            lengths[kCodeLengthOrder[i]] = static_cast<uint8_t>(bits(3));
+        }
+        Huffman code_lengths;
+        if (failed_ || !build_huffman(code_lengths, lengths.data(), 19)) {
+            failed_ = true;
+            return;
+        }
+
+        int index = 0;
+        while (index < nlen + ndist) {
+            int symbol = decode(code_lengths);
+            if (symbol < 0) {
+                return;
+            }
+            if (symbol < 16) {
+                lengths[index++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+
+            uint8_t repeat_len = 0;
+            int repeat = 0;
+            if (symbol == 16) {
+                if (index == 0) {
+                    failed_ = true;
+                    return;
+                }
+                repeat_len = lengths[index - 1];
+                repeat = 3 + bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            if (failed_ || index + repeat > nlen + ndist) {
+                failed_ = true;
+                return;
+            }
+            while (repeat-- > 0) {
+                lengths[index++] = repeat_len;
+            }
+        }
+
+        // 块结束符必须有编码
+        if (lengths[kEndOfBlock] == 0) {
+            failed_ = true;
+            return;
+        }
+
+        Huffman literal_codes;
+        Huffman distance_codes;
+        if (!build_huffman(literal_codes, lengths.data(), nlen) ||
+            !build_huffman(distance_codes, lengths.data() + nlen, ndist)) {
+            failed_ = true;
+            return;
+        }
+        codes(literal_codes, distance_codes);
+    }
+
+    const uint8_t* in_;
+    size_t in_size_;
+    size_t in_pos_ = 0;
+    uint32_t bit_buffer_ = 0;
+    int bit_count_ = 0;
+
+    uint8_t* out_;
+    size_t out_size_;
+    size_t produced_ = 0;
+    bool failed_ = false;
+};
+
+/// 跳过以 0 结尾的字符串字段，返回其后的偏移，越界时返回 0
+size_t skip_zero_terminated(const uint8_t* data, size_t size, size_t pos) {
+    const void* end = std::memchr(data + pos, 0, size - pos);
+    if (end == nullptr) {
+        return 0;
+    }
+    return static_cast<size_t>(static_cast<const uint8_t*>(end) - data) + 1;
+}
+
+}  // namespace
+
+size_t inflate_prefix(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) noexcept {
+    if (in == nullptr || out == nullptr || out_size == 0) {
+        return 0;
+    }
+    return Inflater(in, in_size, out, out_size).run();
+}
+
+size_t gunzip_prefix(const uint8_t* data, size_t size, uint8_t* out, size_t out_size) noexcept {
+    // 10 字节固定头：ID1 ID2 CM FLG MTIME(4) XFL OS
+    if (data == nullptr || size < kGzipHeaderSize) {
+        return 0;
+    }
+    uint8_t flags = data[3];
+    size_t pos = kGzipHeaderSize;
+
+    if (flags & kGzipFlagExtra) {
+        if (size - pos < 2) {
+            return 0;
+        }
+        size_t extra_len = read_le16(data + pos);
+        pos += 2;
+        if (size - pos < extra_len) {
+            return 0;
+        }
+        pos += extra_len;
+    }
+    if (flags & kGzipFlagName) {
+        if ((pos = skip_zero_terminated(data, size, pos)) == 0) {
+            return 0;
+        }
+    }
+    if (flags & kGzipFlagComment) {
+        if ((pos = skip_zero_terminated(data, size, pos)) == 0) {
+            return 0;
+        }
+    }
+    if (flags & kGzipFlagHcrc) {
+        pos += 2;
+    }
+    if (pos >= size) {
+        return 0;
+    }
+
+    return inflate_prefix(data + pos, size - pos, out, out_size);
+}
+
+}  // namespace detail
+}  // namespace fileformat
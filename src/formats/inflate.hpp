@@ -0,0 +1,28 @@
+#ifndef FILEFORMAT_FORMATS_INFLATE_HPP
+#define FILEFORMAT_FORMATS_INFLATE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fileformat {
+namespace detail {
+
+/// 解压 raw deflate 流（RFC 1951）的开头部分
+///
+/// 仅用于窥视压缩载荷的类型：输出缓冲区写满、输入耗尽、遇到最后一个块结束或数据损坏时停止，
+/// 不分配内存。回溯距离只能落在已输出的数据内，因此无需额外的滑动窗口。
+/// @param in deflate 数据
+/// @param in_size 数据大小
+/// @param out 输出缓冲区
+/// @param out_size 输出缓冲区大小
+/// @return 写入 out 的字节数（数据损坏时返回损坏点之前已解出的字节数）
+size_t inflate_prefix(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) noexcept;
+
+/// 跳过 GZIP 成员头（RFC 1952，含 FEXTRA/FNAME/FCOMMENT/FHCRC）并解压载荷的开头部分
+/// @return 写入 out 的字节数，头部不完整或无效时返回 0
+size_t gunzip_prefix(const uint8_t* data, size_t size, uint8_t* out, size_t out_size) noexcept;
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_INFLATE_HPP
@@ -0,0 +1,68 @@
+#ifndef FILEFORMAT_FORMATS_ISOBMFF_HPP
+#define FILEFORMAT_FORMATS_ISOBMFF_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "formats/byte_utils.hpp"
+
+namespace fileformat {
+namespace detail {
+
+// ISO 基础媒体文件格式（ISO/IEC 14496-12）的 box 头解析工具
+
+/// 由四字符码构造 box 类型
+constexpr uint32_t fourcc(const char (&code)[5]) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(code[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(code[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(code[2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(code[3]));
+}
+
+/// box 头
+struct BoxHeader {
+    uint32_t type = 0;
+    uint64_t size = 0;         // 含头部的整个 box 大小；size 字段为 0 时表示延伸到文件末尾
+    size_t header_size = 0;    // 8，或带 64 位 largesize 时为 16
+    bool to_end = false;       // size 字段为 0
+};
+
+/// 解析 pos 处的 box 头
+/// @return 头部完整且大小合法（不小于头部本身）时返回 true
+inline bool read_box_header(const uint8_t* data, size_t size, size_t pos,
+                            BoxHeader& box) noexcept {
+    if (pos > size || size - pos < 8) {
+        return false;
+    }
+    uint64_t box_size = read_be32(data + pos);
+    box.type = read_be32(data + pos + 4);
+    box.header_size = 8;
+    box.to_end = box_size == 0;
+
+    if (box_size == 1) {
+        if (size - pos < 16) {
+            return false;
+        }
+        box_size = (static_cast<uint64_t>(read_be32(data + pos + 8)) << 32) |
+                   read_be32(data + pos + 12);
+        box.header_size = 16;
+    }
+    box.size = box_size;
+    return box.to_end || box_size >= box.header_size;
+}
+
+/// box 类型的四个字节是否都是可打印 ASCII（用于排除随机数据）
+inline bool is_printable_fourcc(uint32_t type) noexcept {
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint8_t c = static_cast<uint8_t>(type >> shift);
+        if (c < 0x20 || c > 0x7E) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_ISOBMFF_HPP
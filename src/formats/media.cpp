@@ -1,6 +1,13 @@
 #include "fileformat/detector.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
+#include <string_view>
+
+#include "formats/isobmff.hpp"
+#include "formats/reader.hpp"
 
 namespace fileformat {
 namespace detail {
@@ -9,33 +16,618 @@ namespace {
 
 // Magic bytes 常量
 constexpr uint8_t kId3Magic[] = {0x49, 0x44, 0x33};  // "ID3"
-constexpr uint8_t kMp3SyncMagic[] = {0xFF, 0xFB};    // MP3 frame sync
-constexpr uint8_t kMp3SyncMagic2[] = {0xFF, 0xFA};   // MP3 frame sync (variant)
-constexpr uint8_t kMp3SyncMagic3[] = {0xFF, 0xF3};   // MP3 frame sync (variant)
-constexpr uint8_t kMp3SyncMagic4[] = {0xFF, 0xF2};   // MP3 frame sync (variant)
 constexpr uint8_t kRiffMagic[] = {0x52, 0x49, 0x46, 0x46};  // "RIFF"
 constexpr uint8_t kWaveMagic[] = {0x57, 0x41, 0x56, 0x45};  // "WAVE"
 constexpr uint8_t kAviMagic[] = {0x41, 0x56, 0x49, 0x20};   // "AVI "
-constexpr uint8_t kFtypMagic[] = {0x66, 0x74, 0x79, 0x70};  // "ftyp"
 constexpr uint8_t kMkvMagic[] = {0x1A, 0x45, 0xDF, 0xA3};   // EBML header
 
+// RIFF 头：magic(4) + 大小(4，不含这 8 字节)；流式写入器在结束前以 0 或 0xFFFFFFFF 占位
+constexpr uint64_t kRiffHeaderSize = 8;
+constexpr uint32_t kRiffSizeUnset = 0;
+constexpr uint32_t kRiffSizeStreaming = 0xFFFFFFFF;
+
 /// 比较内存
 inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
     return std::memcmp(data, pattern, len) == 0;
 }
 
-/// 检查 MP3 帧同步
-bool is_mp3_frame_sync(const uint8_t* data) {
-    return mem_equal(data, kMp3SyncMagic, 2) ||
-           mem_equal(data, kMp3SyncMagic2, 2) ||
-           mem_equal(data, kMp3SyncMagic3, 2) ||
-           mem_equal(data, kMp3SyncMagic4, 2);
+// MPEG Layer III 比特率表（kbps），索引 0 (free) 和 15 (bad) 无效
+constexpr uint16_t kMp3BitrateV1[16] = {0,   32,  40,  48,  56,  64,  80,  96,
+                                        112, 128, 160, 192, 224, 256, 320, 0};
+constexpr uint16_t kMp3BitrateV2[16] = {0,  8,  16, 24,  32,  40,  48,  56,
+                                        64, 80, 96, 112, 128, 144, 160, 0};
+
+// 采样率表（Hz），按 MPEG1 / MPEG2 / MPEG2.5 排列，索引 3 保留
+constexpr uint32_t kMp3SampleRate[3][3] = {
+    {44100, 48000, 32000}, {22050, 24000, 16000}, {11025, 12000, 8000}};
+
+/// 解析后的 MPEG 音频帧头
+struct Mp3FrameHeader {
+    uint8_t version_bits;      // 00=MPEG2.5, 10=MPEG2, 11=MPEG1
+    uint8_t sample_rate_index;
+    size_t frame_length;       // 含帧头的整帧字节数
+    uint32_t bitrate;          // kbps
+    uint32_t sample_rate;      // Hz
+    uint16_t channels;
+    uint16_t samples_per_frame;
+};
+
+/// 解析 MPEG-1/2/2.5 Layer III 帧头
+/// @return 帧头合法时返回 true 并填充 header
+bool parse_mp3_frame_header(const uint8_t* p, Mp3FrameHeader& header) {
+    // 11 位帧同步
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    uint8_t version_bits = (p[1] >> 3) & 0x03;
+    uint8_t layer_bits = (p[1] >> 1) & 0x03;
+    uint8_t bitrate_index = (p[2] >> 4) & 0x0F;
+    uint8_t sample_rate_index = (p[2] >> 2) & 0x03;
+    uint8_t padding = (p[2] >> 1) & 0x01;
+    uint8_t emphasis = p[3] & 0x03;
+
+    // 版本 01 保留；只接受 Layer III (01)；强调模式 10 保留
+    if (version_bits == 0x01 || layer_bits != 0x01 || sample_rate_index == 0x03 ||
+        emphasis == 0x02) {
+        return false;
+    }
+
+    bool is_v1 = version_bits == 0x03;
+    uint32_t bitrate = (is_v1 ? kMp3BitrateV1 : kMp3BitrateV2)[bitrate_index];
+    if (bitrate == 0) {
+        return false;  // free format 无法计算帧长，按无效处理
+    }
+
+    size_t rate_row = is_v1 ? 0 : (version_bits == 0x02 ? 1 : 2);
+    uint32_t sample_rate = kMp3SampleRate[rate_row][sample_rate_index];
+
+    header.version_bits = version_bits;
+    header.sample_rate_index = sample_rate_index;
+    header.frame_length = (is_v1 ? 144 : 72) * bitrate * 1000 / sample_rate + padding;
+    header.bitrate = bitrate;
+    header.sample_rate = sample_rate;
+    header.channels = ((p[3] >> 6) & 0x03) == 0x03 ? 1 : 2;  // 声道模式 11 为单声道
+    header.samples_per_frame = is_v1 ? 1152 : 576;
+    return true;
+}
+
+/// 检查 MP3 帧同步：首帧头合法，且缓冲区内的下一帧与之版本/采样率一致
+bool is_mp3_frame_sync(const uint8_t* data, size_t size) {
+    Mp3FrameHeader first{};
+    if (size < 4 || !parse_mp3_frame_header(data, first)) {
+        return false;
+    }
+
+    // 下一帧超出头部缓冲区时只能依据首帧判断
+    size_t next = first.frame_length;
+    if (next > size - 4) {
+        return true;
+    }
+
+    Mp3FrameHeader second{};
+    return parse_mp3_frame_header(data + next, second) &&
+           second.version_bits == first.version_bits &&
+           second.sample_rate_index == first.sample_rate_index;
+}
+
+// ISO-BMFF box 类型
+constexpr uint32_t kBoxFtyp = fourcc("ftyp");
+constexpr uint32_t kBoxMoov = fourcc("moov");
+constexpr uint32_t kBoxMdat = fourcc("mdat");
+constexpr uint32_t kBoxFree = fourcc("free");
+constexpr uint32_t kBoxSkip = fourcc("skip");
+constexpr uint32_t kBoxWide = fourcc("wide");
+constexpr uint32_t kBoxPnot = fourcc("pnot");  // QuickTime 预览
+
+// EBML 头元素 ID（RFC 8794）
+constexpr uint32_t kEbmlDocTypeId = 0x4282;
+
+// 只在前若干字节内查找 DocType（EBML 头通常不足 64 字节）
+constexpr size_t kEbmlHeaderScanLimit = 256;
+
+// 无 ftyp 时最多检查的前导 box 数
+constexpr int kMaxLeadingBoxes = 8;
+
+// 无 ftyp 的前导 box（mdat 除外）大小上限，用于排除以文本开头的数据
+constexpr uint64_t kMaxLeadingBoxSize = 1u << 24;
+
+/// 品牌到格式的映射，按优先级排列（major brand 未命中时取 compatible brands 中优先级最高者）
+struct BrandFormat {
+    uint32_t brand;
+    Format format;
+};
+
+constexpr BrandFormat kBrandFormats[] = {
+    // AV1 图像 (AVIF)
+    {fourcc("avif"), Format::AVIF},
+    {fourcc("avis"), Format::AVIF},
+    // HEVC 图像 (HEIC)
+    {fourcc("heic"), Format::HEIC},
+    {fourcc("heix"), Format::HEIC},
+    {fourcc("heim"), Format::HEIC},
+    {fourcc("heis"), Format::HEIC},
+    {fourcc("hevc"), Format::HEIC},
+    {fourcc("hevx"), Format::HEIC},
+    // iTunes 音频 / 有声书
+    {fourcc("M4A "), Format::M4A},
+    {fourcc("M4B "), Format::M4A},
+    {fourcc("M4P "), Format::M4A},
+    {fourcc("F4A "), Format::M4A},
+    {fourcc("F4B "), Format::M4A},
+    // QuickTime
+    {fourcc("qt  "), Format::MOV},
+};
+
+// 通用 HEIF 品牌：没有更具体的品牌时按 HEIC 处理
+constexpr uint32_t kBrandMif1 = fourcc("mif1");
+constexpr uint32_t kBrandMsf1 = fourcc("msf1");
+
+// MP4 视频 major brand：compatible brands 只声明兼容性，不据此细分为 3GP/MOV/M4A 等
+// （iTunes 视频 M4V 与 Flash 视频 F4V 常把 "M4A " 列为兼容品牌）
+constexpr uint32_t kGenericMp4Brands[] = {
+    fourcc("isom"), fourcc("iso2"), fourcc("iso4"), fourcc("iso5"), fourcc("iso6"),
+    fourcc("mp41"), fourcc("mp42"), fourcc("avc1"), fourcc("dash"),
+    fourcc("M4V "), fourcc("M4VH"), fourcc("M4VP"), fourcc("f4v "),
+};
+
+bool is_generic_mp4_brand(uint32_t brand) {
+    return std::find(std::begin(kGenericMp4Brands), std::end(kGenericMp4Brands), brand) !=
+           std::end(kGenericMp4Brands);
+}
+
+/// 查找品牌对应的格式及其优先级（下标越小越优先），未知品牌返回 false
+bool lookup_brand(uint32_t brand, Format& format, size_t& rank) {
+    // 3GPP / 3GPP2："3gp?"、"3g2?" 及 3GPP 配置品牌 "3ge?"、"3gg?"、"3gs?"
+    if ((brand >> 16) == ((static_cast<uint32_t>('3') << 8) | 'g')) {
+        format = Format::ThreeGP;
+        rank = std::size(kBrandFormats);
+        return true;
+    }
+    for (size_t i = 0; i < std::size(kBrandFormats); ++i) {
+        if (kBrandFormats[i].brand == brand) {
+            format = kBrandFormats[i].format;
+            rank = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// 根据 ftyp box 的 major brand 与 compatible brands 区分 MP4/M4A/MOV/3GP/HEIC/AVIF
+Format classify_ftyp(const uint8_t* box, size_t available, const BoxHeader& header) {
+    // payload: major_brand(4) minor_version(4) compatible_brands(4 * n)
+    size_t end = available;
+    if (!header.to_end && header.size < end) {
+        end = static_cast<size_t>(header.size);
+    }
+    if (end < 12) {
+        return Format::MP4;
+    }
+
+    Format format = Format::Unknown;
+    size_t rank = 0;
+    uint32_t major = read_be32(box + 8);
+    if (lookup_brand(major, format, rank)) {
+        return format;
+    }
+    // 只有 major brand 未知或为通用 HEIF 品牌时才参考 compatible brands
+    if (is_generic_mp4_brand(major)) {
+        return Format::MP4;
+    }
+
+    bool heif = major == kBrandMif1 || major == kBrandMsf1;
+    Format best = Format::Unknown;
+    size_t best_rank = SIZE_MAX;
+    for (size_t pos = 16; pos + 4 <= end; pos += 4) {
+        uint32_t brand = read_be32(box + pos);
+        if (lookup_brand(brand, format, rank) && rank < best_rank) {
+            best = format;
+            best_rank = rank;
+        }
+        heif = heif || brand == kBrandMif1 || brand == kBrandMsf1;
+    }
+
+    if (best != Format::Unknown) {
+        return best;
+    }
+    return heif ? Format::HEIC : Format::MP4;
+}
+
+/// QuickTime 文件可能没有 ftyp，而以这些 box 开头
+bool is_leading_box(uint32_t type) {
+    return type == kBoxMoov || type == kBoxMdat || type == kBoxFree || type == kBoxSkip ||
+           type == kBoxWide || type == kBoxPnot;
+}
+
+/// ISO-BMFF / QuickTime：ftyp 在首个 box，或位于有限个前导 box 之后
+Format detect_isobmff(const uint8_t* data, size_t size) {
+    BoxHeader box;
+    if (!read_box_header(data, size, 0, box)) {
+        return Format::Unknown;
+    }
+    if (box.type == kBoxFtyp) {
+        return classify_ftyp(data, size, box);
+    }
+    if (!is_leading_box(box.type) ||
+        (box.type != kBoxMdat && box.header_size == 8 && box.size >= kMaxLeadingBoxSize)) {
+        return Format::Unknown;
+    }
+
+    // 有界 box 遍历：跳过前导 box 查找后置的 ftyp，超出缓冲区即停止
+    size_t pos = 0;
+    for (int i = 0; i < kMaxLeadingBoxes; ++i) {
+        if (!read_box_header(data, size, pos, box) || !is_printable_fourcc(box.type)) {
+            break;
+        }
+        if (box.type == kBoxFtyp) {
+            return classify_ftyp(data + pos, size - pos, box);
+        }
+        if (box.to_end || box.size > size - pos) {
+            break;
+        }
+        pos += static_cast<size_t>(box.size);
+    }
+    return Format::MOV;
+}
+
+/// 读取 EBML 变长整数（VINT）
+/// @param keep_marker 为 true 时保留长度标记位（元素 ID），否则去掉（元素大小）
+/// @param unknown 输出大小是否为保留的"未知大小"（数据位全 1）
+/// @return 读取成功时返回 true 并前移 pos
+bool read_ebml_vint(const uint8_t* data, size_t size, size_t& pos, bool keep_marker,
+                    uint64_t& value, bool& unknown) {
+    if (pos >= size || data[pos] == 0) {
+        return false;  // 首字节为 0 表示长度超过 8 字节
+    }
+    size_t length = 1;
+    while ((data[pos] & (0x80 >> (length - 1))) == 0) {
+        ++length;
+    }
+    if (size - pos < length) {
+        return false;
+    }
+
+    uint8_t marker = static_cast<uint8_t>(0x80 >> (length - 1));
+    value = keep_marker ? data[pos] : (data[pos] & (marker - 1));
+    bool all_ones = (data[pos] & (marker - 1)) == marker - 1;
+    for (size_t i = 1; i < length; ++i) {
+        value = (value << 8) | data[pos + i];
+        all_ones = all_ones && data[pos + i] == 0xFF;
+    }
+    unknown = all_ones;
+    pos += length;
+    return true;
+}
+
+/// 遍历 EBML 头的子元素，依据 DocType 区分 WebM 与 Matroska
+/// （DocType 缺省值为 "matroska"）
+Format classify_ebml(const uint8_t* data, size_t size) {
+    size_t limit = std::min(size, kEbmlHeaderScanLimit);
+    size_t pos = 4;  // 跳过 EBML 头 ID
+    uint64_t header_size = 0;
+    bool unknown = false;
+    if (!read_ebml_vint(data, limit, pos, false, header_size, unknown)) {
+        return Format::MKV;
+    }
+    size_t end = limit;
+    if (!unknown && header_size < end - pos) {
+        end = pos + static_cast<size_t>(header_size);
+    }
+
+    while (pos < end) {
+        uint64_t id = 0;
+        uint64_t element_size = 0;
+        if (!read_ebml_vint(data, end, pos, true, id, unknown) ||
+            !read_ebml_vint(data, end, pos, false, element_size, unknown) || unknown ||
+            element_size > end - pos) {
+            break;
+        }
+        if (id == kEbmlDocTypeId) {
+            // 字符串元素可能以 0 填充
+            std::string_view doc_type(reinterpret_cast<const char*>(data + pos),
+                                      static_cast<size_t>(element_size));
+            doc_type = doc_type.substr(0, doc_type.find('\0'));
+            return doc_type == "webm" ? Format::WebM : Format::MKV;
+        }
+        pos += static_cast<size_t>(element_size);
+    }
+    return Format::MKV;
+}
+
+//==============================================================================
+// 音视频流参数解析
+//==============================================================================
+
+// 块/box 遍历上限
+constexpr int kMaxProbeChunks = 64;
+
+// MP3 帧同步与 Xing/VBRI 头的读取窗口
+constexpr size_t kMp3ProbeWindow = 2048;
+
+// ID3v2 头
+constexpr size_t kId3HeaderSize = 10;
+constexpr uint8_t kId3FlagFooter = 0x10;
+
+// Xing/Info 标志位
+constexpr uint32_t kXingFrames = 0x01;
+constexpr uint32_t kXingBytes = 0x02;
+
+// VBRI 头固定位于帧头之后 32 字节
+constexpr size_t kVbriOffset = 4 + 32;
+
+// RIFF/ISO-BMFF 类型码
+constexpr uint32_t kChunkFmt = fourcc("fmt ");
+constexpr uint32_t kChunkData = fourcc("data");
+constexpr uint32_t kChunkList = fourcc("LIST");
+constexpr uint32_t kChunkHdrl = fourcc("hdrl");
+constexpr uint32_t kChunkAvih = fourcc("avih");
+constexpr uint32_t kBoxMvhd = fourcc("mvhd");
+
+/// RIFF 块类型按大端四字符码比较，大小为小端
+uint32_t riff_type(const uint8_t* p) {
+    return read_be32(p);
+}
+
+/// value * 1000 / scale，避免中间结果溢出
+uint64_t scale_to_ms(uint64_t value, uint64_t scale) {
+    return value / scale * 1000 + value % scale * 1000 / scale;
+}
+
+/// 依据时长与字节数计算平均码率
+uint32_t average_bitrate(uint64_t bytes, uint64_t duration_ms) {
+    if (duration_ms == 0) {
+        return 0;
+    }
+    uint64_t bitrate = bytes / duration_ms * 8000 + bytes % duration_ms * 8000 / duration_ms;
+    return bitrate > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(bitrate);
+}
+
+/// WAV：遍历 RIFF 块，取 fmt 的声道/采样率/字节率与 data 块大小
+void probe_wav(ByteSource& reader, MediaInfo& info) {
+    uint64_t file_size = reader.size();
+    uint64_t pos = 12;
+    uint32_t byte_rate = 0;
+    uint64_t data_size = 0;
+    bool have_data = false;
+
+    for (int i = 0; i < kMaxProbeChunks && !(byte_rate != 0 && have_data); ++i) {
+        uint8_t header[8];
+        if (reader.read_at(pos, header, sizeof(header)) != sizeof(header)) {
+            break;
+        }
+        uint32_t type = riff_type(header);
+        uint64_t chunk_size = read_le32(header + 4);
+
+        if (type == kChunkFmt) {
+            uint8_t fmt[16];
+            if (chunk_size < sizeof(fmt) || reader.read_at(pos + 8, fmt, sizeof(fmt)) != sizeof(fmt)) {
+                return;
+            }
+            info.channels = read_le16(fmt + 2);
+            info.sample_rate = read_le32(fmt + 4);
+            byte_rate = read_le32(fmt + 8);
+        } else if (type == kChunkData) {
+            // 流式写入的 WAV 可能把 data 大小留为 0 或 0xFFFFFFFF
+            uint64_t available = file_size > pos + 8 ? file_size - pos - 8 : 0;
+            data_size = chunk_size == 0 || chunk_size > available ? available : chunk_size;
+            have_data = true;
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);  // 块按偶数字节对齐
+    }
+
+    info.bitrate = byte_rate * 8;
+    if (byte_rate != 0 && have_data) {
+        info.duration_ms = scale_to_ms(data_size, byte_rate);
+    }
+}
+
+/// AVI：RIFF 'AVI ' 之后的第一个 LIST 'hdrl' 以 avih 主头开始
+void probe_avi(ByteSource& reader, MediaInfo& info) {
+    // LIST(4) size(4) 'hdrl'(4) 'avih'(4) size(4) + MainAVIHeader 前 40 字节
+    uint8_t header[60];
+    if (reader.read_at(12, header, sizeof(header)) != sizeof(header) ||
+        riff_type(header) != kChunkList || riff_type(header + 8) != kChunkHdrl ||
+        riff_type(header + 12) != kChunkAvih) {
+        return;
+    }
+    const uint8_t* avih = header + 20;
+    uint32_t usec_per_frame = read_le32(avih);
+    uint32_t max_bytes_per_sec = read_le32(avih + 4);
+    uint32_t total_frames = read_le32(avih + 16);
+    info.width = static_cast<uint16_t>(std::min<uint32_t>(read_le32(avih + 32), UINT16_MAX));
+    info.height = static_cast<uint16_t>(std::min<uint32_t>(read_le32(avih + 36), UINT16_MAX));
+
+    info.duration_ms = static_cast<uint64_t>(total_frames) * usec_per_frame / 1000;
+    info.bitrate = info.duration_ms != 0 ? average_bitrate(reader.size(), info.duration_ms)
+                                         : max_bytes_per_sec * 8;
+}
+
+/// MP3：跳过 ID3v2 标签，解析首帧头；VBR 文件依据 Xing/Info 或 VBRI 头的帧数计算时长
+void probe_mp3(ByteSource& reader, MediaInfo& info) {
+    uint64_t file_size = reader.size();
+    uint64_t pos = 0;
+
+    uint8_t id3[kId3HeaderSize];
+    if (reader.read_at(0, id3, sizeof(id3)) == sizeof(id3) && mem_equal(id3, kId3Magic, 3)) {
+        // 标签大小为 4 个 7 位的 syncsafe 整数
+        uint32_t tag_size = (static_cast<uint32_t>(id3[6] & 0x7F) << 21) |
+                            (static_cast<uint32_t>(id3[7] & 0x7F) << 14) |
+                            (static_cast<uint32_t>(id3[8] & 0x7F) << 7) | (id3[9] & 0x7F);
+        pos = kId3HeaderSize + tag_size + ((id3[5] & kId3FlagFooter) ? kId3HeaderSize : 0);
+    }
+
+    // 标签后可能有填充，在窗口内查找首个合法帧头
+    uint8_t window[kMp3ProbeWindow];
+    size_t count = reader.read_at(pos, window, sizeof(window));
+    Mp3FrameHeader frame{};
+    size_t offset = 0;
+    while (offset + 4 <= count && !parse_mp3_frame_header(window + offset, frame)) {
+        ++offset;
+    }
+    if (offset + 4 > count) {
+        return;
+    }
+    info.sample_rate = frame.sample_rate;
+    info.channels = frame.channels;
+
+    uint64_t audio_bytes = file_size - (pos + offset);
+    uint64_t frames = 0;
+
+    // Xing/Info 位于边信息之后：MPEG1 立体声 32、单声道 17；MPEG2/2.5 立体声 17、单声道 9
+    bool is_v1 = frame.version_bits == 0x03;
+    size_t side_info = is_v1 ? (frame.channels == 1 ? 17 : 32) : (frame.channels == 1 ? 9 : 17);
+    const uint8_t* xing = window + offset + 4 + side_info;
+    const uint8_t* vbri = window + offset + kVbriOffset;
+    if (offset + 4 + side_info + 16 <= count &&
+        (std::memcmp(xing, "Xing", 4) == 0 || std::memcmp(xing, "Info", 4) == 0)) {
+        uint32_t flags = read_be32(xing + 4);
+        const uint8_t* field = xing + 8;
+        if (flags & kXingFrames) {
+            frames = read_be32(field);
+            field += 4;
+        }
+        if ((flags & kXingBytes) && read_be32(field) != 0) {
+            audio_bytes = read_be32(field);
+        }
+    } else if (offset + kVbriOffset + 18 <= count && std::memcmp(vbri, "VBRI", 4) == 0) {
+        audio_bytes = read_be32(vbri + 10);
+        frames = read_be32(vbri + 14);
+    }
+
+    if (frames != 0) {
+        info.duration_ms = scale_to_ms(frames * frame.samples_per_frame, frame.sample_rate);
+        info.bitrate = average_bitrate(audio_bytes, info.duration_ms);
+    } else {
+        // CBR：按首帧码率与音频数据大小估算
+        info.bitrate = frame.bitrate * 1000;
+        info.duration_ms = audio_bytes * 8000 / info.bitrate;
+    }
+}
+
+/// 在 [begin, end) 范围内遍历 box，返回第一个指定类型的 box 的位置
+bool find_box(ByteSource& reader, uint64_t begin, uint64_t end, uint32_t type,
+              uint64_t& found, BoxHeader& box) {
+    uint64_t pos = begin;
+    for (int i = 0; i < kMaxProbeChunks && pos < end; ++i) {
+        uint8_t header[16];
+        size_t count = reader.read_at(pos, header, sizeof(header));
+        if (!read_box_header(header, count, 0, box)) {
+            return false;
+        }
+        if (box.to_end) {
+            box.size = end - pos;
+        }
+        if (box.type == type) {
+            found = pos;
+            return true;
+        }
+        pos += box.size;
+    }
+    return false;
+}
+
+/// ISO-BMFF：有界的顶层 box 遍历定位 moov（可能位于 mdat 之后），再读取其中的 mvhd
+void probe_isobmff(ByteSource& reader, MediaInfo& info) {
+    uint64_t file_size = reader.size();
+    uint64_t moov = 0;
+    uint64_t mvhd = 0;
+    BoxHeader box;
+    if (!find_box(reader, 0, file_size, kBoxMoov, moov, box)) {
+        return;
+    }
+    uint64_t moov_end = moov + box.size;
+    if (!find_box(reader, moov + box.header_size, moov_end, kBoxMvhd, mvhd, box)) {
+        return;
+    }
+
+    // version(1) flags(3)，version 1 使用 64 位时间与时长
+    uint8_t payload[32];
+    if (reader.read_at(mvhd + box.header_size, payload, sizeof(payload)) != sizeof(payload)) {
+        return;
+    }
+    uint64_t timescale = 0;
+    uint64_t duration = 0;
+    if (payload[0] == 1) {
+        timescale = read_be32(payload + 20);
+        duration = (static_cast<uint64_t>(read_be32(payload + 24)) << 32) | read_be32(payload + 28);
+    } else {
+        timescale = read_be32(payload + 12);
+        duration = read_be32(payload + 16);
+        if (duration == UINT32_MAX) {
+            duration = 0;  // 全 1 表示时长未知
+        }
+    }
+    if (timescale == 0 || duration == UINT64_MAX) {
+        return;
+    }
+    info.duration_ms = scale_to_ms(duration, timescale);
+    info.bitrate = average_bitrate(file_size, info.duration_ms);
 }
 
 }  // namespace
 
+bool probe_fast_start(ByteSource& reader, bool& fast_start) noexcept {
+    uint64_t file_size = reader.size();
+    uint64_t pos = 0;
+    for (int i = 0; i < kMaxProbeChunks && pos < file_size; ++i) {
+        uint8_t header[16];
+        size_t count = reader.read_at(pos, header, sizeof(header));
+        BoxHeader box;
+        if (!read_box_header(header, count, 0, box)) {
+            return false;
+        }
+        if (box.type == kBoxMoov || box.type == kBoxMdat) {
+            fast_start = box.type == kBoxMoov;
+            return true;
+        }
+        if (box.to_end) {
+            return false;
+        }
+        pos += box.size;
+    }
+    return false;
+}
+
+Completeness check_riff_end(const uint8_t* head, size_t head_size, uint64_t file_size) noexcept {
+    if (head == nullptr || head_size < kRiffHeaderSize || !mem_equal(head, kRiffMagic, 4)) {
+        return Completeness::Unchecked;
+    }
+    uint32_t riff_size = read_le32(head + 4);
+    if (riff_size == kRiffSizeUnset || riff_size == kRiffSizeStreaming) {
+        return Completeness::Unchecked;
+    }
+    // 声明的大小之后允许附加数据（部分编辑器写入的尾部标签）
+    return file_size >= kRiffHeaderSize + riff_size ? Completeness::Complete
+                                                    : Completeness::Truncated;
+}
+
+MediaInfo probe_media(ByteSource& reader, Format format) noexcept {
+    MediaInfo info;
+    info.format = format;
+    switch (format) {
+        case Format::WAV:
+            probe_wav(reader, info);
+            break;
+        case Format::AVI:
+            probe_avi(reader, info);
+            break;
+        case Format::MP3:
+            probe_mp3(reader, info);
+            break;
+        case Format::MP4:
+        case Format::M4A:
+        case Format::MOV:
+        case Format::ThreeGP:
+            probe_isobmff(reader, info);
+            break;
+        default:
+            break;
+    }
+    return info;
+}
+
 Format detect_media(const uint8_t* data, size_t size) noexcept {
-    if (data == nullptr || size < 4) {
+    if (data == nullptr || size < 3) {
         return Format::Unknown;
     }
 
@@ -43,7 +635,7 @@ Format detect_media(const uint8_t* data, size_t size) noexcept {
     if (size >= 3 && mem_equal(data, kId3Magic, 3)) {
         return Format::MP3;
     }
-    if (size >= 2 && is_mp3_frame_sync(data)) {
+    if (is_mp3_frame_sync(data, size)) {
         return Format::MP3;
     }
 
@@ -57,22 +649,28 @@ Format detect_media(const uint8_t* data, size_t size) noexcept {
         }
     }
 
-    // MP4/M4A/MOV: ftyp box
-    if (size >= 8) {
-        // ftyp 在偏移 4 处
-        if (mem_equal(data + 4, kFtypMagic, 4)) {
-            return Format::MP4;
-        }
+    // ISO-BMFF 家族（MP4/M4A/MOV/3GP/HEIC/AVIF）：按 ftyp 品牌细分
+    if (auto fmt = detect_isobmff(data, size); fmt != Format::Unknown) {
+        return fmt;
     }
 
-    // MKV/WebM: EBML header
+    // MKV/WebM: EBML header，按 DocType 区分
     if (size >= 4 && mem_equal(data, kMkvMagic, 4)) {
-        return Format::MKV;
+        return classify_ebml(data, size);
     }
 
     return Format::Unknown;
 }
 
 }  // namespace detail
-}  // namespace fileformat
 
+//==============================================================================
+// 音视频信息 API
+//==============================================================================
+
+MediaInfo probe_media(const uint8_t* data, size_t size) noexcept {
+    MemorySource reader(data, size);
+    return detail::probe_media(reader, detect(data, size));
+}
+
+}  // namespace fileformat
@@ -0,0 +1,132 @@
+#ifndef FILEFORMAT_FORMATS_MULTI_MATCHER_HPP
+#define FILEFORMAT_FORMATS_MULTI_MATCHER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace fileformat {
+namespace detail {
+
+/// 编译期构建的 Aho-Corasick 多模式匹配器
+///
+/// 一次扫描即可确定多个子串是否出现，取代对同一缓冲区的多次 string_view::find。
+/// 状态转移表在编译期展开为完整 DFA（MaxStates x 256），扫描时每字节一次查表。
+/// 存在不区分大小写的子串时自动机按折叠后的字节运行，区分大小写的子串在命中时再逐字节核对原文。
+///
+/// @tparam NeedleCount 子串数量（不超过 32）
+/// @tparam MaxStates 状态数上限（>= 所有子串长度之和 + 1，且不超过 256）
+template <size_t NeedleCount, size_t MaxStates>
+class MultiMatcher {
+    static_assert(NeedleCount > 0 && NeedleCount <= 32, "needle mask is 32 bits wide");
+    static_assert(MaxStates <= 256, "state index is 8 bits wide");
+
+public:
+    /// @param needles 待查找的子串，下标即返回掩码中的位序号
+    /// @param fold_mask 按 ASCII 不区分大小写匹配的子串掩码，其余子串区分大小写
+    constexpr MultiMatcher(const std::array<std::string_view, NeedleCount>& needles,
+                           uint32_t fold_mask = 0)
+        : needles_(needles),
+          fold_case_((fold_mask & kAllNeedles) != 0),
+          verify_mask_(fold_case_ ? (~fold_mask & kAllNeedles) : 0) {
+        // 1. 构建 trie（0 表示无转移，根节点为状态 0，不会成为转移目标）
+        size_t state_count = 1;
+        for (size_t n = 0; n < NeedleCount; ++n) {
+            size_t state = 0;
+            for (char ch : needles[n]) {
+                auto c = fold(static_cast<uint8_t>(ch));
+                if (next_[state][c] == 0) {
+                    next_[state][c] = static_cast<uint8_t>(state_count++);
+                }
+                state = next_[state][c];
+            }
+            output_[state] |= 1u << n;
+        }
+
+        // 2. 按 BFS 顺序计算失配链接，并把缺失的转移补全为 DFA 转移
+        std::array<uint8_t, MaxStates> fail{};
+        std::array<uint8_t, MaxStates> queue{};
+        size_t head = 0;
+        size_t tail = 0;
+        for (size_t c = 0; c < 256; ++c) {
+            if (next_[0][c] != 0) {
+                queue[tail++] = next_[0][c];
+            }
+        }
+        while (head < tail) {
+            size_t state = queue[head++];
+            output_[state] |= output_[fail[state]];
+            for (size_t c = 0; c < 256; ++c) {
+                uint8_t child = next_[state][c];
+                if (child != 0) {
+                    fail[child] = next_[fail[state]][c];
+                    queue[tail++] = child;
+                } else {
+                    next_[state][c] = next_[fail[state]][c];
+                }
+            }
+        }
+    }
+
+    /// 单遍扫描数据，返回出现过的子串掩码
+    /// @param stop_mask 一旦命中其中任一子串即提前结束扫描（全部命中时总会提前结束）
+    uint32_t scan(const uint8_t* data, size_t size, uint32_t stop_mask = 0) const noexcept {
+        uint32_t found = 0;
+        size_t state = 0;
+        for (size_t i = 0; i < size; ++i) {
+            state = next_[state][fold(data[i])];
+            uint32_t hits = output_[state];
+            if ((hits & verify_mask_) != 0) {
+                hits = verify(data, i + 1, hits);
+            }
+            found |= hits;
+            if ((found & stop_mask) != 0 || found == kAllNeedles) {
+                break;
+            }
+        }
+        return found;
+    }
+
+    uint32_t scan(std::string_view text, uint32_t stop_mask = 0) const noexcept {
+        return scan(reinterpret_cast<const uint8_t*>(text.data()), text.size(), stop_mask);
+    }
+
+    static constexpr uint32_t kAllNeedles =
+        NeedleCount == 32 ? 0xFFFFFFFFu : ((1u << NeedleCount) - 1);
+
+private:
+    /// 核对以 end 结尾的区分大小写子串，清除原文大小写不符的位
+    uint32_t verify(const uint8_t* data, size_t end, uint32_t hits) const noexcept {
+        for (size_t n = 0; n < NeedleCount; ++n) {
+            uint32_t bit = 1u << n;
+            if ((hits & verify_mask_ & bit) == 0) {
+                continue;
+            }
+            std::string_view needle = needles_[n];
+            const uint8_t* start = data + end - needle.size();
+            for (size_t k = 0; k < needle.size(); ++k) {
+                if (start[k] != static_cast<uint8_t>(needle[k])) {
+                    hits &= ~bit;
+                    break;
+                }
+            }
+        }
+        return hits;
+    }
+
+    constexpr uint8_t fold(uint8_t c) const {
+        return (fold_case_ && c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c - 'A' + 'a') : c;
+    }
+
+    std::array<std::string_view, NeedleCount> needles_;
+    bool fold_case_;
+    uint32_t verify_mask_;
+    std::array<std::array<uint8_t, 256>, MaxStates> next_{};
+    std::array<uint32_t, MaxStates> output_{};
+};
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_MULTI_MATCHER_HPP
@@ -0,0 +1,103 @@
+#include "formats/reader.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace fileformat {
+namespace detail {
+
+namespace {
+
+/// 合并后的一次读取
+struct ProbeSegment {
+    uint64_t begin;
+    uint64_t end;
+    size_t scratch_offset;
+};
+
+}  // namespace
+
+size_t read_probes(ByteSource& reader, const ProbeRange* ranges, size_t count,
+                   std::vector<uint8_t>& scratch, ProbeView* views) noexcept {
+    count = std::min(count, kMaxProbeRanges);
+    uint64_t file_size = reader.size();
+
+    // 1. 换算为绝对区间 [begin, end)，截断到文件范围内
+    std::array<uint64_t, kMaxProbeRanges> begins{};
+    std::array<uint64_t, kMaxProbeRanges> ends{};
+    std::array<size_t, kMaxProbeRanges> order{};
+    size_t valid = 0;
+    for (size_t i = 0; i < count; ++i) {
+        views[i] = ProbeView{};
+        int64_t offset = ranges[i].offset;
+        uint64_t begin = static_cast<uint64_t>(offset);
+        uint64_t length = ranges[i].length;
+        if (offset < 0) {
+            // 超出文件开头的部分被截去
+            uint64_t distance = 0 - static_cast<uint64_t>(offset);
+            uint64_t before_start = distance > file_size ? distance - file_size : 0;
+            if (before_start >= length) {
+                continue;
+            }
+            begin = file_size - (distance - before_start);
+            length -= before_start;
+        }
+        if (begin >= file_size) {
+            continue;
+        }
+        begins[i] = begin;
+        ends[i] = std::min<uint64_t>(begin + length, file_size);
+        order[valid++] = i;
+    }
+    std::sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(valid),
+              [&](size_t a, size_t b) { return begins[a] < begins[b]; });
+
+    // 2. 合并间隔不超过 kProbeCoalesceGap 的区间
+    std::array<ProbeSegment, kMaxProbeRanges> segments{};
+    std::array<size_t, kMaxProbeRanges> segment_of{};
+    size_t segment_count = 0;
+    size_t total = 0;
+    for (size_t k = 0; k < valid; ++k) {
+        size_t i = order[k];
+        if (segment_count > 0 && begins[i] <= segments[segment_count - 1].end + kProbeCoalesceGap) {
+            ProbeSegment& last = segments[segment_count - 1];
+            if (ends[i] > last.end) {
+                total += static_cast<size_t>(ends[i] - last.end);
+                last.end = ends[i];
+            }
+        } else {
+            segments[segment_count++] = {begins[i], ends[i], total};
+            total += static_cast<size_t>(ends[i] - begins[i]);
+        }
+        segment_of[i] = segment_count - 1;
+    }
+
+    // 3. 合并后的各段作为一批交给数据源（远端数据源可在一次往返内完成），区间视图指向暂存区
+    scratch.resize(total);
+    std::array<ReadRequest, kMaxProbeRanges> requests{};
+    for (size_t s = 0; s < segment_count; ++s) {
+        const ProbeSegment& segment = segments[s];
+        requests[s].offset = segment.begin;
+        requests[s].out = scratch.data() + segment.scratch_offset;
+        requests[s].length = static_cast<size_t>(segment.end - segment.begin);
+    }
+    if (segment_count > 0) {
+        reader.read_batch(requests.data(), segment_count);
+    }
+    std::array<size_t, kMaxProbeRanges> filled{};
+    for (size_t s = 0; s < segment_count; ++s) {
+        filled[s] = std::min(requests[s].transferred, requests[s].length);
+    }
+    for (size_t k = 0; k < valid; ++k) {
+        size_t i = order[k];
+        const ProbeSegment& segment = segments[segment_of[i]];
+        auto relative = static_cast<size_t>(begins[i] - segment.begin);
+        size_t available = filled[segment_of[i]] > relative ? filled[segment_of[i]] - relative : 0;
+        views[i].data = scratch.data() + segment.scratch_offset + relative;
+        views[i].size = std::min(available, static_cast<size_t>(ends[i] - begins[i]));
+    }
+    return segment_count;
+}
+
+}  // namespace detail
+}  // namespace fileformat
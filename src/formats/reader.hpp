@@ -0,0 +1,88 @@
+#ifndef FILEFORMAT_FORMATS_READER_HPP
+#define FILEFORMAT_FORMATS_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fileformat/source.hpp"
+#include "fileformat/types.hpp"
+
+namespace fileformat {
+namespace detail {
+
+/// 检测器声明的定位探测区间
+struct ProbeRange {
+    int64_t offset;   // 起始偏移，负值相对文件末尾
+    uint32_t length;
+};
+
+/// 探测结果，与 ProbeRange 一一对应；区间越界时 size 小于请求长度（可能为 0），
+/// 负偏移超出文件开头时截去超出部分（视图从文件开头起）
+struct ProbeView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// 单批探测的区间数上限
+constexpr size_t kMaxProbeRanges = 16;
+
+// 间隔不超过该值的探测区间合并为一次读取
+constexpr uint64_t kProbeCoalesceGap = 16 * 1024;
+
+/// 批量执行定位探测：换算负偏移，按起始偏移排序，合并相邻区间后以一次 read_batch 读取
+/// @param ranges 探测区间（最多 kMaxProbeRanges 个，多余的忽略）
+/// @param scratch 读取暂存区，views 指向其内部
+/// @param views 输出，长度不小于 count
+/// @return 实际发出的读取次数
+size_t read_probes(ByteSource& reader, const ProbeRange* ranges, size_t count,
+                   std::vector<uint8_t>& scratch, ProbeView* views) noexcept;
+
+/// 文档是否加密：PDF trailer 中的 /Encrypt、OLE 容器中的 EncryptedPackage 流（加密的 OOXML）
+/// @param head 已读取的文件头
+bool is_encrypted_document(ByteSource& reader, const uint8_t* head, size_t head_size,
+                           Format format) noexcept;
+
+/// 压缩包是否加密：ZIP 本地文件头的加密标志位/AES 扩展字段、RAR 头部与文件加密标志、
+/// 7z 头部中的 AES 编码器
+bool is_encrypted_archive(ByteSource& reader, const uint8_t* head, size_t head_size,
+                          Format format) noexcept;
+
+/// 校验图像结束标记：PNG 的 IEND 块及其 CRC，JPEG 的 EOI（FF D9）
+/// @param tail 文件最后 size 字节
+Completeness check_image_end(Format format, const uint8_t* tail, size_t size) noexcept;
+
+/// 校验压缩包结束标记：ZIP 的 EOCD 与中央目录范围，GZIP 尾部（CRC32 + ISIZE）是否存在且合理
+/// @param tail 文件最后 size 字节
+/// @param file_size 文件总大小
+Completeness check_archive_end(Format format, const uint8_t* tail, size_t size,
+                               uint64_t file_size) noexcept;
+
+/// 校验文档结束标记：PDF 最后 1 KB 中的 %%EOF
+/// @param tail 文件最后 size 字节
+Completeness check_document_end(Format format, const uint8_t* tail, size_t size) noexcept;
+
+/// 校验 RIFF 头部声明的大小（WAV、AVI、WebP）与实际文件大小
+/// @param head 文件头
+/// @param file_size 文件总大小
+Completeness check_riff_end(const uint8_t* head, size_t head_size, uint64_t file_size) noexcept;
+
+/// 依据远偏移和文件尾识别光盘/磁盘镜像（ISO 9660、UDF、固定大小 VHD）
+Format detect_disk_image_far(ByteSource& reader) noexcept;
+
+/// 解析音视频流参数（WAV fmt/data、AVI avih、MP3 帧头与 Xing/VBRI、ISO-BMFF mvhd）
+/// @param format 已检测出的格式
+MediaInfo probe_media(ByteSource& reader, Format format) noexcept;
+
+/// 有界的顶层 box 遍历，判断 moov 是否位于 mdat 之前
+/// @return 在遍历上限内遇到 moov 或 mdat 时返回 true 并填充 fast_start
+bool probe_fast_start(ByteSource& reader, bool& fast_start) noexcept;
+
+/// 在 PDF 文件头的前 1 KB 中查找线性化字典，并以 /L 校验文件长度
+/// @param file_size 文件总大小
+bool is_linearized_pdf(const uint8_t* data, size_t size, uint64_t file_size) noexcept;
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_READER_HPP
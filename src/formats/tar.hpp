@@ -0,0 +1,69 @@
+#ifndef FILEFORMAT_FORMATS_TAR_HPP
+#define FILEFORMAT_FORMATS_TAR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fileformat {
+namespace detail {
+
+// TAR 头（POSIX ustar，GNU 扩展）
+constexpr size_t kTarBlockSize = 512;
+constexpr size_t kTarNameOffset = 0;
+constexpr size_t kTarNameLength = 100;
+constexpr size_t kTarSizeOffset = 124;
+constexpr size_t kTarSizeLength = 12;
+constexpr size_t kTarChecksumOffset = 148;
+constexpr size_t kTarChecksumLength = 8;
+constexpr size_t kTarTypeOffset = 156;
+constexpr size_t kTarMagicOffset = 257;
+constexpr size_t kTarPrefixOffset = 345;
+constexpr size_t kTarPrefixLength = 155;
+
+/// 解析 TAR 数字段：八进制（前导空格，以 NUL 或空格结束），或 GNU 的 base-256 编码
+/// （首字节最高位为 1，其余位按大端存放；负数视为非法）
+/// @return 字段非法时返回 false
+inline bool parse_tar_number(const uint8_t* field, size_t length, uint64_t& value) noexcept {
+    value = 0;
+    if (length > 0 && (field[0] & 0x80) != 0) {
+        if ((field[0] & 0x40) != 0) {
+            return false;
+        }
+        value = field[0] & 0x3F;
+        for (size_t i = 1; i < length; ++i) {
+            if ((value >> 56) != 0) {
+                return false;
+            }
+            value = (value << 8) | field[i];
+        }
+        return true;
+    }
+
+    size_t i = 0;
+    while (i < length && field[i] == ' ') {
+        ++i;
+    }
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+    }
+    return i == length || field[i] == 0 || field[i] == ' ';
+}
+
+/// 校验 TAR 头的校验和：校验和字段按空格计算的无符号字节和
+inline bool is_valid_tar_header(const uint8_t* header) noexcept {
+    uint64_t expected = 0;
+    if (!parse_tar_number(header + kTarChecksumOffset, kTarChecksumLength, expected)) {
+        return false;
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kTarBlockSize; ++i) {
+        bool in_checksum = i >= kTarChecksumOffset && i < kTarChecksumOffset + kTarChecksumLength;
+        sum += in_checksum ? ' ' : header[i];
+    }
+    return sum == expected;
+}
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_TAR_HPP
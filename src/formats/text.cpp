@@ -0,0 +1,412 @@
+#include "fileformat/detector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "formats/multi_matcher.hpp"
+
+namespace fileformat {
+namespace detail {
+
+namespace {
+
+// BOM 常量
+constexpr uint8_t kUtf8Bom[] = {0xEF, 0xBB, 0xBF};
+constexpr uint8_t kUtf16LeBom[] = {0xFF, 0xFE};
+constexpr uint8_t kUtf16BeBom[] = {0xFE, 0xFF};
+
+constexpr std::string_view kXmlDecl = "<?xml";
+
+// 标记语言前缀中需要查找的子串，单遍完成（XML 元素名区分大小写，HTML 标签不区分）
+constexpr uint32_t kMarkupFictionBook = 1u << 0;
+constexpr uint32_t kMarkupHtml = 1u << 1;
+constexpr MultiMatcher<2, 20> kMarkupMatcher({"FictionBook", "<html"}, kMarkupHtml);
+
+// 结构判断使用的 ASCII 前缀长度（与原 FB2 搜索窗口一致）
+constexpr size_t kPrefixSize = 1024;
+
+// CSV 列数一致性检查的最大行数
+constexpr size_t kCsvMaxLines = 8;
+
+// 非 ASCII 码位在前缀中的占位字符
+constexpr char kNonAsciiPlaceholder = '\x80';
+
+// 常见 HTML 根/首元素名称（不区分大小写）
+constexpr std::string_view kHtmlTags[] = {"html", "head", "body",  "title", "meta",
+                                          "link", "div",  "script", "style", "table"};
+
+/// 比较内存
+inline bool mem_equal(const uint8_t* data, const uint8_t* pattern, size_t len) {
+    return std::memcmp(data, pattern, len) == 0;
+}
+
+/// 字节分类（用于单遍直方图统计）
+enum ByteClass : uint8_t {
+    kClassText = 0,    // 普通可打印字符
+    kClassSpace,       // 空白及允许出现的控制字符（空格、\r、\f 等）
+    kClassNewline,     // \n
+    kClassComma,       // ,
+    kClassSemicolon,   // ;
+    kClassTab,         // \t
+    kClassQuote,       // "
+    kClassColon,       // :
+    kClassBinary,      // 不应出现在文本中的控制字符
+    kClassCount
+};
+
+/// 构建 ASCII 字节分类表
+constexpr std::array<uint8_t, 128> make_class_table() {
+    std::array<uint8_t, 128> table{};
+    for (size_t c = 0; c < 0x20; ++c) {
+        table[c] = kClassBinary;
+    }
+    // BEL BS VT FF CR ESC 允许出现在文本中（ESC 用于带颜色的日志）
+    table[0x07] = kClassSpace;
+    table[0x08] = kClassSpace;
+    table[0x0B] = kClassSpace;
+    table[0x0C] = kClassSpace;
+    table[0x0D] = kClassSpace;
+    table[0x1B] = kClassSpace;
+    table[0x7F] = kClassBinary;
+    table[' '] = kClassSpace;
+    table['\t'] = kClassTab;
+    table['\n'] = kClassNewline;
+    table[','] = kClassComma;
+    table[';'] = kClassSemicolon;
+    table['"'] = kClassQuote;
+    table[':'] = kClassColon;
+    return table;
+}
+
+constexpr std::array<uint8_t, 128> kClassTable = make_class_table();
+
+// CSV 候选分隔符（下标与 line_delims 对应）
+constexpr uint8_t kCsvDelimClasses[] = {kClassComma, kClassSemicolon, kClassTab};
+constexpr size_t kCsvDelimCount = sizeof(kCsvDelimClasses);
+
+/// 单遍扫描状态：编码校验、字节类直方图、ASCII 前缀和 CSV 行统计
+struct TextScan {
+    bool binary = false;       // 遇到非文本控制字符
+    bool invalid_utf8 = false; // 存在非法 UTF-8 序列
+    std::array<uint32_t, kClassCount> histogram{};
+
+    std::array<char, kPrefixSize> prefix{};
+    size_t prefix_len = 0;
+
+    // CSV：每行（引号外）各分隔符的出现次数
+    std::array<std::array<uint16_t, kCsvDelimCount>, kCsvMaxLines> line_delims{};
+    std::array<uint16_t, kCsvDelimCount> current_delims{};
+    size_t current_line_len = 0;
+    size_t complete_lines = 0;
+    bool in_quotes = false;
+
+    /// 处理一个码位（非 ASCII 码位以 0x80 传入）
+    void feed(uint32_t unit) {
+        uint8_t cls = unit < 0x80 ? kClassTable[unit] : static_cast<uint8_t>(kClassText);
+        if (cls == kClassBinary) {
+            binary = true;
+            return;
+        }
+        ++histogram[cls];
+
+        if (prefix_len < prefix.size()) {
+            prefix[prefix_len++] = unit < 0x80 ? static_cast<char>(unit) : kNonAsciiPlaceholder;
+        }
+
+        if (cls == kClassQuote) {
+            in_quotes = !in_quotes;
+        } else if (cls == kClassNewline && !in_quotes) {
+            end_line();
+            return;
+        } else if (!in_quotes) {
+            for (size_t k = 0; k < kCsvDelimCount; ++k) {
+                if (cls == kCsvDelimClasses[k]) {
+                    ++current_delims[k];
+                }
+            }
+        }
+        if (cls != kClassSpace) {
+            ++current_line_len;
+        }
+    }
+
+    void end_line() {
+        // 空行不参与统计
+        if (current_line_len > 0 && complete_lines < kCsvMaxLines) {
+            line_delims[complete_lines++] = current_delims;
+        }
+        current_delims = {};
+        current_line_len = 0;
+    }
+
+    std::string_view prefix_view() const { return {prefix.data(), prefix_len}; }
+};
+
+/// 扫描 UTF-8 数据（允许缓冲区末尾被截断的多字节序列）
+void scan_utf8(const uint8_t* data, size_t size, TextScan& scan) {
+    size_t i = 0;
+    while (i < size && !scan.binary) {
+        uint8_t c = data[i];
+        if (c < 0x80) {
+            scan.feed(c);
+            ++i;
+            continue;
+        }
+
+        // 根据首字节确定序列长度及第二字节的合法范围（排除超长编码和代理项）
+        size_t len = 0;
+        uint8_t lo = 0x80;
+        uint8_t hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            len = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            len = 3;
+            if (c == 0xE0) lo = 0xA0;
+            if (c == 0xED) hi = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            len = 4;
+            if (c == 0xF0) lo = 0x90;
+            if (c == 0xF4) hi = 0x8F;
+        }
+
+        bool valid = len != 0;
+        size_t j = 1;
+        for (; valid && j < len && i + j < size; ++j) {
+            uint8_t cc = data[i + j];
+            if (j == 1 ? (cc < lo || cc > hi) : (cc & 0xC0) != 0x80) {
+                valid = false;
+            }
+        }
+        if (!valid) {
+            scan.invalid_utf8 = true;
+            scan.feed(0x80);
+            ++i;
+            continue;
+        }
+        scan.feed(0x80);
+        i += j;
+    }
+}
+
+/// 扫描 UTF-16 数据
+void scan_utf16(const uint8_t* data, size_t size, bool little_endian, TextScan& scan) {
+    size_t units = size / 2;
+    for (size_t u = 0; u < units && !scan.binary; ++u) {
+        const uint8_t* p = data + u * 2;
+        uint32_t unit = little_endian ? static_cast<uint32_t>(p[0] | (p[1] << 8))
+                                      : static_cast<uint32_t>((p[0] << 8) | p[1]);
+        if (unit >= 0xDC00 && unit <= 0xDFFF) {
+            scan.binary = true;  // 孤立的低位代理项
+        } else if (unit >= 0xD800 && unit <= 0xDBFF) {
+            if (u + 1 < units) {
+                const uint8_t* q = p + 2;
+                uint32_t next = little_endian ? static_cast<uint32_t>(q[0] | (q[1] << 8))
+                                              : static_cast<uint32_t>((q[0] << 8) | q[1]);
+                if (next < 0xDC00 || next > 0xDFFF) {
+                    scan.binary = true;
+                    break;
+                }
+                ++u;
+            }
+            scan.feed(0x80);
+        } else {
+            scan.feed(unit);
+        }
+    }
+}
+
+/// 不区分大小写的前缀比较
+bool starts_with_icase(std::string_view text, std::string_view prefix) {
+    if (text.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+size_t skip_space(std::string_view text, size_t pos) {
+    while (pos < text.size() && is_space(text[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+/// 检查 '<' 之后是否是已知的 HTML 元素名
+bool is_html_tag(std::string_view tag) {
+    for (auto name : kHtmlTags) {
+        if (starts_with_icase(tag, name)) {
+            if (tag.size() == name.size()) {
+                return true;
+            }
+            char next = tag[name.size()];
+            if (next == '>' || next == '/' || is_space(next)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// 对以 '<' 开头的文本进行 XML / HTML / FB2 区分
+Format classify_markup(std::string_view text) {
+    if (text.substr(0, kXmlDecl.size()) == kXmlDecl) {
+        uint32_t markers = kMarkupMatcher.scan(text, kMarkupFictionBook);
+        // FB2: XML 根元素为 FictionBook
+        if (markers & kMarkupFictionBook) {
+            return Format::FB2;
+        }
+        // XHTML
+        if (markers & kMarkupHtml) {
+            return Format::HTML;
+        }
+        return Format::XML;
+    }
+    if (starts_with_icase(text, "<!doctype html")) {
+        return Format::HTML;
+    }
+    if (text.substr(0, 4) == "<!--") {
+        return (kMarkupMatcher.scan(text) & kMarkupHtml) ? Format::HTML : Format::XML;
+    }
+    if (text.substr(0, 2) == "<!") {
+        return Format::XML;
+    }
+    if (text.size() >= 2) {
+        char c = text[1];
+        bool name_start = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        if (name_start) {
+            return is_html_tag(text.substr(1)) ? Format::HTML : Format::XML;
+        }
+    }
+    return Format::Unknown;
+}
+
+/// 检查 JSON 起始结构：对象须以键或 '}' 开始，数组首元素须为合法值
+bool looks_like_json(std::string_view text, const TextScan& scan) {
+    size_t pos = skip_space(text, 1);
+    if (pos >= text.size()) {
+        return true;  // "{" 或 "[" 后数据被截断
+    }
+    char c = text[pos];
+    if (text[0] == '{') {
+        return c == '}' || (c == '"' && scan.histogram[kClassColon] > 0);
+    }
+
+    // 数组
+    if (c == ']' || c == '[' || c == '{' || c == '"') {
+        return true;
+    }
+    bool scalar_start = c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n';
+    if (!scalar_start) {
+        return false;
+    }
+    // 数字或字面量之后须紧跟 ',' 或 ']'
+    size_t end = pos;
+    while (end < text.size() &&
+           ((text[end] >= '0' && text[end] <= '9') || (text[end] >= 'a' && text[end] <= 'z') ||
+            text[end] == '-' || text[end] == '+' || text[end] == '.' || text[end] == 'E')) {
+        ++end;
+    }
+    std::string_view token = text.substr(pos, end - pos);
+    if (token.front() >= 'a' && token.front() <= 'z' && token != "true" && token != "false" &&
+        token != "null") {
+        return false;
+    }
+    end = skip_space(text, end);
+    return end >= text.size() || text[end] == ',' || text[end] == ']';
+}
+
+/// CSV：至少两行完整数据，且某个分隔符在每行中出现次数相同且非零
+bool looks_like_csv(const TextScan& scan) {
+    if (scan.complete_lines < 2) {
+        return false;
+    }
+    for (size_t k = 0; k < kCsvDelimCount; ++k) {
+        uint16_t columns = scan.line_delims[0][k];
+        if (columns == 0) {
+            continue;
+        }
+        bool consistent = true;
+        for (size_t line = 1; line < scan.complete_lines && consistent; ++line) {
+            consistent = scan.line_delims[line][k] == columns;
+        }
+        if (consistent) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+Format detect_text(const uint8_t* data, size_t size) noexcept {
+    if (data == nullptr || size < 2) {
+        return Format::Unknown;
+    }
+
+    TextScan scan;
+
+    // 编码判定：BOM 优先，其次为无 BOM 的 UTF-16 ASCII 模式，默认 UTF-8
+    if (size >= 3 && mem_equal(data, kUtf8Bom, 3)) {
+        scan_utf8(data + 3, size - 3, scan);
+    } else if (mem_equal(data, kUtf16LeBom, 2)) {
+        scan_utf16(data + 2, size - 2, true, scan);
+    } else if (mem_equal(data, kUtf16BeBom, 2)) {
+        scan_utf16(data + 2, size - 2, false, scan);
+    } else if (size >= 4 && data[0] != 0 && data[1] == 0 && data[2] != 0 && data[3] == 0) {
+        scan_utf16(data, size, true, scan);
+    } else if (size >= 4 && data[0] == 0 && data[1] != 0 && data[2] == 0 && data[3] != 0) {
+        scan_utf16(data, size, false, scan);
+    } else {
+        scan_utf8(data, size, scan);
+    }
+
+    if (scan.binary) {
+        return Format::Unknown;
+    }
+
+    std::string_view text = scan.prefix_view();
+    size_t start = skip_space(text, 0);
+    if (start >= text.size()) {
+        return scan.invalid_utf8 ? Format::Unknown : Format::Text;
+    }
+    text = text.substr(start);
+
+    // 非 UTF-8 数据仅在 XML 声明（可指定 windows-1251 等编码）下接受
+    if (scan.invalid_utf8) {
+        return text.substr(0, kXmlDecl.size()) == kXmlDecl ? classify_markup(text)
+                                                           : Format::Unknown;
+    }
+
+    if (text[0] == '<') {
+        if (auto fmt = classify_markup(text); fmt != Format::Unknown) {
+            return fmt;
+        }
+    }
+
+    if ((text[0] == '{' || text[0] == '[') && looks_like_json(text, scan)) {
+        return Format::JSON;
+    }
+
+    if (looks_like_csv(scan)) {
+        return Format::CSV;
+    }
+
+    return Format::Text;
+}
+
+}  // namespace detail
+}  // namespace fileformat
@@ -0,0 +1,152 @@
+#include "formats/transfer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace fileformat {
+namespace detail {
+
+namespace {
+
+// Base64 解码表中的特殊值：字母表字符为 0..63
+constexpr uint8_t kBase64Skip = 0x40;     // 空白与换行
+constexpr uint8_t kBase64Invalid = 0x80;  // 填充符 '=' 与其他字符
+
+constexpr std::array<uint8_t, 256> kBase64Table = [] {
+    std::array<uint8_t, 256> table{};
+    for (auto& value : table) {
+        value = kBase64Invalid;
+    }
+    for (int i = 0; i < 26; ++i) {
+        table['A' + i] = static_cast<uint8_t>(i);
+        table['a' + i] = static_cast<uint8_t>(26 + i);
+    }
+    for (int i = 0; i < 10; ++i) {
+        table['0' + i] = static_cast<uint8_t>(52 + i);
+    }
+    table['+'] = table['-'] = 62;  // 标准 / URL 安全字母表
+    table['/'] = table['_'] = 63;
+    table[' '] = table['\t'] = table['\r'] = table['\n'] = kBase64Skip;
+    return table;
+}();
+
+/// 十六进制数字的值，非法时返回 -1（quoted-printable 要求大写，解码时同时接受小写）
+int hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+}  // namespace
+
+size_t decode_base64_prefix(const uint8_t* in, size_t in_size, uint8_t* out,
+                            size_t out_size) noexcept {
+    if (in == nullptr || out == nullptr) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    size_t produced = 0;
+    uint32_t quantum = 0;
+    int count = 0;
+    while (pos < in_size && produced < out_size) {
+        // 快速路径：连续 4 个字母表字符一次解出 3 字节（跳过表项的高两位均为 0）
+        if (count == 0 && in_size - pos >= 4 && out_size - produced >= 3) {
+            uint8_t a = kBase64Table[in[pos]];
+            uint8_t b = kBase64Table[in[pos + 1]];
+            uint8_t c = kBase64Table[in[pos + 2]];
+            uint8_t d = kBase64Table[in[pos + 3]];
+            if (((a | b | c | d) & (kBase64Skip | kBase64Invalid)) == 0) {
+                uint32_t value = (uint32_t{a} << 18) | (uint32_t{b} << 12) | (uint32_t{c} << 6) | d;
+                out[produced] = static_cast<uint8_t>(value >> 16);
+                out[produced + 1] = static_cast<uint8_t>(value >> 8);
+                out[produced + 2] = static_cast<uint8_t>(value);
+                produced += 3;
+                pos += 4;
+                continue;
+            }
+        }
+
+        uint8_t value = kBase64Table[in[pos++]];
+        if (value == kBase64Skip) {
+            continue;
+        }
+        if (value == kBase64Invalid) {
+            break;
+        }
+        quantum = (quantum << 6) | value;
+        if (++count == 4) {
+            uint8_t bytes[3] = {static_cast<uint8_t>(quantum >> 16),
+                                static_cast<uint8_t>(quantum >> 8), static_cast<uint8_t>(quantum)};
+            size_t n = std::min<size_t>(3, out_size - produced);
+            std::memcpy(out + produced, bytes, n);
+            produced += n;
+            quantum = 0;
+            count = 0;
+        }
+    }
+
+    // 不足 4 个字符的尾部：2 个字符解出 1 字节，3 个字符解出 2 字节
+    if (count >= 2 && produced < out_size) {
+        quantum <<= 6 * (4 - count);
+        out[produced++] = static_cast<uint8_t>(quantum >> 16);
+        if (count == 3 && produced < out_size) {
+            out[produced++] = static_cast<uint8_t>(quantum >> 8);
+        }
+    }
+    return produced;
+}
+
+size_t decode_quoted_printable_prefix(const uint8_t* in, size_t in_size, uint8_t* out,
+                                      size_t out_size) noexcept {
+    if (in == nullptr || out == nullptr) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    size_t produced = 0;
+    while (pos < in_size && produced < out_size) {
+        // 两个 '=' 之间的字面量整段复制
+        size_t run = std::min(in_size - pos, out_size - produced);
+        const auto* escape = static_cast<const uint8_t*>(std::memchr(in + pos, '=', run));
+        size_t literal = escape == nullptr ? run : static_cast<size_t>(escape - (in + pos));
+        std::memcpy(out + produced, in + pos, literal);
+        produced += literal;
+        pos += literal;
+        if (escape == nullptr || produced >= out_size) {
+            continue;
+        }
+
+        // 软换行
+        if (pos + 1 < in_size && in[pos + 1] == '\n') {
+            pos += 2;
+            continue;
+        }
+        if (pos + 2 < in_size && in[pos + 1] == '\r' && in[pos + 2] == '\n') {
+            pos += 3;
+            continue;
+        }
+
+        int high = pos + 2 < in_size ? hex_value(in[pos + 1]) : -1;
+        int low = pos + 2 < in_size ? hex_value(in[pos + 2]) : -1;
+        if (high >= 0 && low >= 0) {
+            out[produced++] = static_cast<uint8_t>((high << 4) | low);
+            pos += 3;
+        } else {
+            out[produced++] = '=';
+            ++pos;
+        }
+    }
+    return produced;
+}
+
+}  // namespace detail
+}  // namespace fileformat
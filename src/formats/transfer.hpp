@@ -0,0 +1,33 @@
+#ifndef FILEFORMAT_FORMATS_TRANSFER_HPP
+#define FILEFORMAT_FORMATS_TRANSFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fileformat {
+namespace detail {
+
+/// 解码 Base64 数据（RFC 4648）的开头部分
+///
+/// 同时接受标准与 URL 安全字母表，跳过空白与换行；输出缓冲区写满、输入耗尽、遇到填充符 '=' 或
+/// 非法字符时停止，不分配内存。
+/// @param in 编码数据
+/// @param in_size 数据大小
+/// @param out 输出缓冲区
+/// @param out_size 输出缓冲区大小
+/// @return 写入 out 的字节数
+size_t decode_base64_prefix(const uint8_t* in, size_t in_size, uint8_t* out,
+                            size_t out_size) noexcept;
+
+/// 解码 quoted-printable 数据（RFC 2045 6.7）的开头部分
+///
+/// "=XX" 还原为字节，软换行 "=\r\n"/"=\n" 删除，其他字符（含硬换行）原样输出；
+/// 不完整或非法的 '=' 序列按原样保留。
+/// @return 写入 out 的字节数
+size_t decode_quoted_printable_prefix(const uint8_t* in, size_t in_size, uint8_t* out,
+                                      size_t out_size) noexcept;
+
+}  // namespace detail
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_FORMATS_TRANSFER_HPP
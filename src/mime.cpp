@@ -0,0 +1,485 @@
+#include "fileformat/detector.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fileformat {
+
+namespace {
+
+// 行读取缓冲区大小，更长的行分段处理（边界行不超过 RFC 2046 规定的 70 字符 + 前后缀）
+constexpr size_t kMimeLineBufferSize = 16 * 1024;
+
+// 每个部分保留的正文字节数：足以解码出 kMaxHeaderSize 字节的 base64（含换行）与多数 quoted-printable
+constexpr size_t kMimePeekSize = 4 * kMaxHeaderSize;
+
+// 折行合并后的单个头字段上限，超出部分丢弃
+constexpr size_t kMimeMaxHeaderField = 4096;
+
+// 边界字符串长度上限（RFC 2046 为 70，放宽以兼容不规范的生成器）与嵌套深度上限
+constexpr size_t kMimeMaxBoundary = 256;
+constexpr size_t kMimeMaxDepth = 8;
+
+// 媒体类型的常用别名（声明与检测结果按 get_info() 的 MIME 类型比较之外的等价写法）
+struct MimeAlias {
+    std::string_view mime_type;
+    Format format;
+};
+
+constexpr MimeAlias kMimeAliases[] = {
+    {"image/jpg", Format::JPEG},
+    {"image/pjpeg", Format::JPEG},
+    {"image/x-png", Format::PNG},
+    {"application/x-pdf", Format::PDF},
+    {"application/x-zip-compressed", Format::ZIP},
+    {"application/x-zip", Format::ZIP},
+    {"application/x-rar-compressed", Format::RAR},
+    {"application/x-gzip", Format::GZip},
+    {"application/x-msdownload", Format::EXE},
+    {"application/x-dosexec", Format::EXE},
+    {"audio/x-wav", Format::WAV},
+    {"audio/wave", Format::WAV},
+    {"audio/mp3", Format::MP3},
+    {"text/xml", Format::XML},
+};
+
+/// 内存数据的只读流缓冲区
+class MemoryStreamBuffer final : public std::streambuf {
+public:
+    MemoryStreamBuffer(const uint8_t* data, size_t size) {
+        auto* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+};
+
+/// 只向前的行读取器：以 memchr 查找换行，超过缓冲区的行分段返回
+class LineReader {
+public:
+    explicit LineReader(std::istream& stream) : stream_(stream), buffer_(kMimeLineBufferSize) {}
+
+    /// 读取下一段
+    /// @param piece 输出，不含 '\n'（保留 '\r'）
+    /// @param line_start 该段是否从行首开始
+    /// @param newline 该段之后是否有 '\n'
+    /// @return 数据读完时返回 false
+    bool next(std::string_view& piece, bool& line_start, bool& newline) {
+        line_start = at_line_start_;
+        while (true) {
+            const char* begin = buffer_.data() + begin_;
+            const auto* found = static_cast<const char*>(std::memchr(begin, '\n', end_ - begin_));
+            if (found != nullptr) {
+                auto length = static_cast<size_t>(found - begin);
+                piece = std::string_view(begin, length);
+                begin_ += length + 1;
+                newline = true;
+                at_line_start_ = true;
+                return true;
+            }
+            if (eof_ || (begin_ == 0 && end_ == buffer_.size())) {
+                if (begin_ == end_) {
+                    return false;
+                }
+                piece = std::string_view(begin, end_ - begin_);
+                begin_ = end_;
+                newline = false;
+                at_line_start_ = false;
+                return true;
+            }
+            fill();
+        }
+    }
+
+    /// 读取过程中是否发生了非 EOF 的错误
+    bool failed() const { return stream_.bad(); }
+
+private:
+    void fill() {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        stream_.read(buffer_.data() + end_, static_cast<std::streamsize>(buffer_.size() - end_));
+        auto count = static_cast<size_t>(stream_.gcount());
+        end_ += count;
+        if (count == 0 || !stream_) {
+            eof_ = true;
+        }
+    }
+
+    std::istream& stream_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    bool eof_ = false;
+    bool at_line_start_ = true;
+};
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && is_space(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && is_space(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+char to_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return to_lower(x) == to_lower(y); });
+}
+
+/// 部分的头字段中与检测相关的部分
+struct PartHeaders {
+    std::string content_type;   // 小写，不含参数
+    std::string boundary;       // multipart 的边界
+    TransferEncoding encoding = TransferEncoding::Base64;
+    bool encoded = false;       // 是否使用 base64/quoted-printable
+
+    void clear() {
+        content_type.clear();
+        boundary.clear();
+        encoded = false;
+    }
+
+    bool is_multipart() const {
+        return content_type.compare(0, 10, "multipart/") == 0 && !boundary.empty();
+    }
+
+    /// 解析一个完整（已合并折行）的头字段
+    void parse_field(std::string_view field) {
+        size_t colon = field.find(':');
+        if (colon == std::string_view::npos) {
+            return;
+        }
+        std::string_view name = trim(field.substr(0, colon));
+        std::string_view value = trim(field.substr(colon + 1));
+
+        if (iequals(name, "Content-Type")) {
+            std::string_view type = trim(value.substr(0, value.find(';')));
+            content_type.resize(type.size());
+            std::transform(type.begin(), type.end(), content_type.begin(), to_lower);
+            parse_boundary(value);
+        } else if (iequals(name, "Content-Transfer-Encoding")) {
+            std::string_view mechanism = trim(value.substr(0, value.find(';')));
+            if (iequals(mechanism, "base64")) {
+                encoding = TransferEncoding::Base64;
+                encoded = true;
+            } else if (iequals(mechanism, "quoted-printable")) {
+                encoding = TransferEncoding::QuotedPrintable;
+                encoded = true;
+            }
+        }
+    }
+
+private:
+    /// 提取 boundary 参数（可带引号）
+    void parse_boundary(std::string_view value) {
+        size_t semicolon = value.find(';');
+        while (semicolon != std::string_view::npos) {
+            std::string_view param = value.substr(semicolon + 1);
+            semicolon = param.find(';') == std::string_view::npos
+                            ? std::string_view::npos
+                            : semicolon + 1 + param.find(';');
+            size_t eq = param.find('=');
+            if (eq == std::string_view::npos || !iequals(trim(param.substr(0, eq)), "boundary")) {
+                continue;
+            }
+            std::string_view rest = trim(param.substr(eq + 1));
+            if (!rest.empty() && rest.front() == '"') {
+                size_t quote = rest.find('"', 1);
+                rest = rest.substr(1, quote == std::string_view::npos ? quote : quote - 1);
+            } else {
+                rest = trim(rest.substr(0, rest.find(';')));
+            }
+            if (!rest.empty() && rest.size() <= kMimeMaxBoundary) {
+                boundary.assign(rest);
+            }
+            return;
+        }
+    }
+};
+
+/// ZIP 容器格式与 OLE 复合文档在头部窗口内可能无法细分，按族比较
+int format_family(Format format) {
+    switch (format) {
+        case Format::ZIP:
+        case Format::DOCX:
+        case Format::XLSX:
+        case Format::PPTX:
+        case Format::EPUB:
+            return 1;
+        case Format::DOC:
+        case Format::XLS:
+        case Format::PPT:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+/// 声明的媒体类型与检测结果是否不符
+bool is_mismatch(std::string_view declared, Format format) {
+    if (format == Format::Unknown || declared.empty() || declared == "application/octet-stream") {
+        return false;
+    }
+    const FormatInfo& info = get_info(format);
+    if (declared == info.mime_type) {
+        return false;
+    }
+    if (info.category == Category::Text && declared.compare(0, 5, "text/") == 0) {
+        return false;
+    }
+    for (const auto& alias : kMimeAliases) {
+        if (alias.mime_type == declared && alias.format == format) {
+            return false;
+        }
+    }
+    // 按族比较：声明为 DOCX 而头部窗口内只确认到 ZIP 等
+    int family = format_family(format);
+    if (family != 0) {
+        for (size_t i = 0; i < static_cast<size_t>(Format::COUNT_); ++i) {
+            auto candidate = static_cast<Format>(i);
+            if (format_family(candidate) == family && get_info(candidate).mime_type == declared) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// MIME 扫描器：逐行读取，维护边界栈，只保留每个叶子部分的正文开头
+class MimeScanner {
+public:
+    MimeScanner(std::istream& stream, const MimePartCallback& callback)
+        : reader_(stream), callback_(callback) {
+        peek_.reserve(kMimePeekSize);
+        field_.reserve(kMimeMaxHeaderField);
+    }
+
+    size_t run(std::error_code& error) {
+        enum class State { Headers, Body, Skip };
+        State state = State::Headers;
+        bool in_part = false;
+
+        std::string_view piece;
+        bool line_start = true;
+        bool newline = false;
+        while (reader_.next(piece, line_start, newline)) {
+            if (state == State::Headers) {
+                if (!read_header_piece(piece, line_start)) {
+                    continue;
+                }
+                // 头部结束
+                if (headers_.is_multipart() && boundaries_.size() < kMimeMaxDepth) {
+                    boundaries_.push_back(headers_.boundary);
+                    state = State::Skip;  // 前言
+                } else {
+                    begin_part();
+                    in_part = true;
+                    state = State::Body;
+                }
+                continue;
+            }
+
+            bool closing = false;
+            size_t level = match_boundary(piece, line_start, closing);
+            if (level != kNoBoundary) {
+                if (in_part) {
+                    in_part = false;
+                    if (!report()) {
+                        return reported_;
+                    }
+                }
+                boundaries_.resize(level + 1);
+                if (closing) {
+                    boundaries_.pop_back();
+                    if (boundaries_.empty()) {
+                        break;  // 结语
+                    }
+                    state = State::Skip;
+                } else {
+                    headers_.clear();
+                    field_.clear();
+                    state = State::Headers;
+                }
+                continue;
+            }
+
+            if (state == State::Body) {
+                append_body(piece);
+                if (newline) {
+                    append_body("\n");
+                }
+            }
+        }
+
+        if (state == State::Headers && boundaries_.empty() && !headers_done_) {
+            // 只有头部的消息
+            begin_part();
+            in_part = true;
+        }
+        if (in_part) {
+            report();
+        }
+        if (reader_.failed()) {
+            error = std::make_error_code(std::errc::io_error);
+        }
+        return reported_;
+    }
+
+private:
+    static constexpr size_t kNoBoundary = static_cast<size_t>(-1);
+
+    /// 处理头部中的一段，遇到空行时返回 true
+    bool read_header_piece(std::string_view piece, bool line_start) {
+        if (!line_start) {
+            append_field(piece);
+            return false;
+        }
+        std::string_view line = piece;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            flush_field();
+            headers_done_ = true;
+            return true;
+        }
+        if (line.front() == ' ' || line.front() == '\t') {
+            append_field(line);  // 折行
+            return false;
+        }
+        flush_field();
+        append_field(line);
+        return false;
+    }
+
+    void append_field(std::string_view text) {
+        size_t room = kMimeMaxHeaderField - field_.size();
+        field_.append(text.substr(0, std::min(room, text.size())));
+    }
+
+    void flush_field() {
+        if (!field_.empty()) {
+            headers_.parse_field(field_);
+            field_.clear();
+        }
+    }
+
+    /// 行是否为某一层的边界（从内到外匹配，外层边界同时结束未闭合的内层）
+    size_t match_boundary(std::string_view piece, bool line_start, bool& closing) const {
+        if (!line_start || boundaries_.empty() || piece.size() < 3 || piece[0] != '-' ||
+            piece[1] != '-') {
+            return kNoBoundary;
+        }
+        std::string_view line = trim(piece.substr(2));
+        for (size_t level = boundaries_.size(); level-- > 0;) {
+            const std::string& boundary = boundaries_[level];
+            if (line.size() < boundary.size() || line.compare(0, boundary.size(), boundary) != 0) {
+                continue;
+            }
+            std::string_view suffix = line.substr(boundary.size());
+            if (suffix.empty() || suffix == "--") {
+                closing = !suffix.empty();
+                return level;
+            }
+        }
+        return kNoBoundary;
+    }
+
+    void begin_part() {
+        peek_.clear();
+        part_type_ = headers_.content_type;
+        part_encoding_ = headers_.encoding;
+        part_encoded_ = headers_.encoded;
+    }
+
+    void append_body(std::string_view text) {
+        size_t room = kMimePeekSize - peek_.size();
+        size_t count = std::min(room, text.size());
+        peek_.insert(peek_.end(), text.begin(), text.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+
+    bool report() {
+        MimePart part;
+        part.index = reported_++;
+        part.content_type = part_type_;
+        part.format = part_encoded_ ? detect_encoded(peek_.data(), peek_.size(), part_encoding_)
+                                    : detect(peek_.data(), peek_.size());
+        part.mismatch = is_mismatch(part.content_type, part.format);
+        return callback_(part);
+    }
+
+    LineReader reader_;
+    const MimePartCallback& callback_;
+    std::vector<std::string> boundaries_;
+    PartHeaders headers_;
+    std::string field_;
+    bool headers_done_ = false;
+
+    std::vector<uint8_t> peek_;
+    std::string part_type_;
+    TransferEncoding part_encoding_ = TransferEncoding::Base64;
+    bool part_encoded_ = false;
+    size_t reported_ = 0;
+};
+
+}  // namespace
+
+//==============================================================================
+// MIME 消息扫描
+//==============================================================================
+
+size_t scan_mime(std::istream& stream, const MimePartCallback& callback, std::error_code& error) {
+    error.clear();
+    if (!callback) {
+        return 0;
+    }
+    if (!stream) {
+        error = std::make_error_code(std::errc::io_error);
+        return 0;
+    }
+    return MimeScanner(stream, callback).run(error);
+}
+
+size_t scan_mime(const std::string& path, const MimePartCallback& callback,
+                 std::error_code& error) {
+    error.clear();
+    if (path.empty()) {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return 0;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = std::make_error_code(std::errc::no_such_file_or_directory);
+        return 0;
+    }
+    return scan_mime(file, callback, error);
+}
+
+size_t scan_mime(const uint8_t* data, size_t size, const MimePartCallback& callback,
+                 std::error_code& error) {
+    error.clear();
+    if (data == nullptr || size == 0 || !callback) {
+        return 0;
+    }
+    MemoryStreamBuffer buffer(data, size);
+    std::istream stream(&buffer);
+    return scan_mime(stream, callback, error);
+}
+
+}  // namespace fileformat
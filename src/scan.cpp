@@ -0,0 +1,290 @@
+#include "fileformat/detector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace fileformat {
+
+namespace {
+
+/// 构造签名（mask 为 0x00 的位置为通配）
+constexpr MagicSignature make_signature(std::initializer_list<uint8_t> bytes,
+                                        std::initializer_list<uint8_t> mask, size_t offset,
+                                        Format format) {
+    MagicSignature sig{};
+    size_t i = 0;
+    for (auto b : bytes) {
+        sig.bytes[i] = b;
+        sig.mask[i] = 0xFF;
+        ++i;
+    }
+    sig.length = i;
+    i = 0;
+    for (auto m : mask) {
+        sig.mask[i++] = m;
+    }
+    sig.offset = offset;
+    sig.format = format;
+    return sig;
+}
+
+constexpr MagicSignature make_signature(std::initializer_list<uint8_t> bytes, size_t offset,
+                                        Format format) {
+    return make_signature(bytes, {}, offset, format);
+}
+
+// 嵌入扫描使用的候选签名表
+// 命中后以该偏移处的数据重新执行 detect() 确认，因此这里只需足以筛选候选的前缀；
+// MP3 帧同步在任意数据中出现过于频繁，只保留 ID3 标签
+constexpr std::array<MagicSignature, 34> kEmbeddedSignatures = {{
+    // 图像
+    make_signature({0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A}, 0, Format::PNG),
+    make_signature({0xFF, 0xD8, 0xFF}, 0, Format::JPEG),
+    make_signature({0x42, 0x4D}, 0, Format::BMP),
+    make_signature({0x47, 0x49, 0x46, 0x38, 0x00, 0x61}, {0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF}, 0,
+                   Format::GIF),
+    make_signature({0x52, 0x49, 0x46, 0x46}, 0, Format::WebP),  // RIFF: WebP/WAV/AVI
+    make_signature({0x49, 0x49, 0x2A, 0x00}, 0, Format::TIFF),
+    make_signature({0x4D, 0x4D, 0x00, 0x2A}, 0, Format::TIFF),
+
+    // 文档
+    make_signature({0x25, 0x50, 0x44, 0x46, 0x2D}, 0, Format::PDF),  // "%PDF-"
+    make_signature({0xD0, 0xCF, 0x11, 0xE0, 0xA1, 0xB1, 0x1A, 0xE1}, 0, Format::DOC),
+
+    // 电子书
+    make_signature({0x42, 0x4F, 0x4F, 0x4B, 0x4D, 0x4F, 0x42, 0x49}, 60, Format::MOBI),
+    make_signature({0x41, 0x54, 0x26, 0x54, 0x46, 0x4F, 0x52, 0x4D}, 0, Format::DJVU),
+
+    // 压缩
+    make_signature({0x50, 0x4B, 0x03, 0x04}, 0, Format::ZIP),
+    make_signature({0x52, 0x61, 0x72, 0x21, 0x1A, 0x07}, 0, Format::RAR),
+    make_signature({0x37, 0x7A, 0xBC, 0xAF, 0x27, 0x1C}, 0, Format::SevenZip),
+    make_signature({0x1F, 0x8B, 0x08}, 0, Format::GZip),
+    make_signature({0x75, 0x73, 0x74, 0x61, 0x72}, 257, Format::Tar),
+    make_signature({0x28, 0xB5, 0x2F, 0xFD}, 0, Format::Zstd),
+    make_signature({0xFD, 0x37, 0x7A, 0x58, 0x5A, 0x00}, 0, Format::XZ),
+    make_signature({0x42, 0x5A, 0x68}, 0, Format::BZip2),      // "BZh"
+    make_signature({0x04, 0x22, 0x4D, 0x18}, 0, Format::LZ4),  // 仅帧格式，旧版格式无可校验字段
+    make_signature({0xCE, 0xB2, 0xCF, 0x81}, 0, Format::Brotli),
+    make_signature({0x1F, 0x9D}, 0, Format::UnixCompress),
+
+    // 媒体
+    make_signature({0x49, 0x44, 0x33}, 0, Format::MP3),
+    make_signature({0x66, 0x74, 0x79, 0x70}, 4, Format::MP4),
+    make_signature({0x1A, 0x45, 0xDF, 0xA3}, 0, Format::MKV),
+
+    // 可执行文件
+    make_signature({0x4D, 0x5A}, 0, Format::EXE),
+    make_signature({0x7F, 0x45, 0x4C, 0x46}, 0, Format::ELF),
+    make_signature({0xFE, 0xED, 0xFA, 0xCE}, {0xFF, 0xFF, 0xFF, 0xFE}, 0, Format::MachO),
+    make_signature({0xCE, 0xFA, 0xED, 0xFE}, {0xFE, 0xFF, 0xFF, 0xFF}, 0, Format::MachO),
+    make_signature({0xCA, 0xFE, 0xBA, 0xBE}, {0xFF, 0xFF, 0xFF, 0xFE}, 0, Format::MachO),
+
+    // 数据："SQLite format 3\0"、"Obj\x01"、"ARROW1"、"PAR1"
+    // （嵌入数据的终点未知，Parquet/Arrow 只能按头部魔数确认）
+    make_signature({0x53, 0x51, 0x4C, 0x69, 0x74, 0x65, 0x20, 0x66, 0x6F, 0x72, 0x6D, 0x61, 0x74,
+                    0x20, 0x33, 0x00},
+                   0, Format::SQLite),
+    make_signature({0x4F, 0x62, 0x6A, 0x01}, 0, Format::Avro),
+    make_signature({0x41, 0x52, 0x52, 0x4F, 0x57, 0x31}, 0, Format::Arrow),
+    make_signature({0x50, 0x41, 0x52, 0x31}, 0, Format::Parquet),
+}};
+
+// 签名锚点偏移的种类数（0、4、60、257）
+constexpr size_t kMaxAnchors = 4;
+
+// 流式扫描的分块大小
+constexpr size_t kScanChunkSize = 1 << 20;
+
+/// 多模式预过滤器：按锚点偏移分组，每组用签名前两个字节各建立 256 项候选位图，
+/// 两表按位与后即为该位置可能命中的签名集合（无分支，随机数据中候选率约 0.1%）
+struct SignatureMatcher {
+    struct Anchor {
+        size_t offset = 0;
+        std::array<uint64_t, 256> first{};   // 签名首字节 -> 签名位集合
+        std::array<uint64_t, 256> second{};  // 签名第二字节 -> 签名位集合
+    };
+
+    std::array<Anchor, kMaxAnchors> anchors{};
+    size_t anchor_count = 0;
+    size_t max_offset = 0;
+
+    constexpr SignatureMatcher() {
+        for (size_t i = 0; i < kEmbeddedSignatures.size(); ++i) {
+            const auto& sig = kEmbeddedSignatures[i];
+            size_t a = 0;
+            while (a < anchor_count && anchors[a].offset != sig.offset) {
+                ++a;
+            }
+            if (a == anchor_count) {
+                anchors[anchor_count++].offset = sig.offset;
+            }
+            // 字节带掩码时，登记所有满足掩码的字节值
+            for (size_t b = 0; b < 256; ++b) {
+                if ((b & sig.mask[0]) == (sig.bytes[0] & sig.mask[0])) {
+                    anchors[a].first[b] |= uint64_t{1} << i;
+                }
+                if ((b & sig.mask[1]) == (sig.bytes[1] & sig.mask[1])) {
+                    anchors[a].second[b] |= uint64_t{1} << i;
+                }
+            }
+            if (sig.offset > max_offset) {
+                max_offset = sig.offset;
+            }
+        }
+    }
+
+    /// 计算起始位置 start 处的候选签名集合（调用方保证各锚点的两个字节在缓冲区内）
+    uint64_t candidates(const uint8_t* buf, size_t start) const {
+        uint64_t result = 0;
+        for (size_t a = 0; a < kMaxAnchors; ++a) {
+            const uint8_t* p = buf + start + anchors[a].offset;
+            result |= anchors[a].first[p[0]] & anchors[a].second[p[1]];
+        }
+        return result;
+    }
+
+    /// 同上，但对越界的锚点做检查（用于缓冲区尾部）
+    uint64_t candidates_bounded(const uint8_t* buf, size_t buf_size, size_t start) const {
+        uint64_t result = 0;
+        for (size_t a = 0; a < anchor_count; ++a) {
+            size_t pos = start + anchors[a].offset;
+            if (pos + 1 < buf_size) {
+                result |= anchors[a].first[buf[pos]] & anchors[a].second[buf[pos + 1]];
+            }
+        }
+        return result;
+    }
+};
+
+constexpr SignatureMatcher kMatcher{};
+
+static_assert(kEmbeddedSignatures.size() <= 64, "signature bitset is 64 bits wide");
+static_assert(kMatcher.anchor_count == kMaxAnchors, "kMaxAnchors must match the signature table");
+
+/// 按掩码比较签名
+bool match_signature(const MagicSignature& sig, const uint8_t* data) {
+    for (size_t i = 0; i < sig.length; ++i) {
+        if ((data[i] & sig.mask[i]) != (sig.bytes[i] & sig.mask[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// 扫描 buf 中起始位置位于 [0, start_end) 的嵌入格式
+/// @param buf 数据（须包含起始位置之后至多 kMaxHeaderSize 字节的确认窗口）
+/// @param base buf[0] 在整个输入中的偏移
+/// @param hits 已报告的命中数（累加）
+/// @return 回调要求停止时返回 false
+bool scan_starts(const uint8_t* buf, size_t buf_size, size_t start_end, uint64_t base,
+                 const EmbeddedCallback& callback, size_t& hits) {
+    // 所有锚点都在缓冲区内的起始位置走无边界检查的快速路径
+    size_t fast_end = buf_size > kMatcher.max_offset + 1 ? buf_size - kMatcher.max_offset - 1 : 0;
+
+    for (size_t start = 0; start < start_end; ++start) {
+        uint64_t candidates = start < fast_end
+                                  ? kMatcher.candidates(buf, start)
+                                  : kMatcher.candidates_bounded(buf, buf_size, start);
+        if (candidates == 0) {
+            continue;
+        }
+
+        bool matched = false;
+        for (size_t i = 0; i < kEmbeddedSignatures.size() && !matched; ++i) {
+            if ((candidates & (uint64_t{1} << i)) == 0) {
+                continue;
+            }
+            const auto& sig = kEmbeddedSignatures[i];
+            if (start + sig.offset + sig.length <= buf_size &&
+                match_signature(sig, buf + start + sig.offset)) {
+                matched = true;
+            }
+        }
+        if (!matched) {
+            continue;
+        }
+
+        // 以命中位置为起点重新检测，复用各检测器的结构校验
+        size_t window = std::min(buf_size - start, kMaxHeaderSize);
+        Format fmt = detect(buf + start, window);
+        if (fmt == Format::Unknown || get_info(fmt).category == Category::Text) {
+            continue;
+        }
+
+        ++hits;
+        if (!callback(base + start, fmt)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+//==============================================================================
+// 嵌入格式扫描
+//==============================================================================
+
+size_t scan_embedded(const uint8_t* data, size_t size, const EmbeddedCallback& callback) {
+    size_t hits = 0;
+    if (data == nullptr || size < kMinHeaderSize || !callback) {
+        return hits;
+    }
+    scan_starts(data, size, size, 0, callback, hits);
+    return hits;
+}
+
+size_t scan_embedded(const std::string& path, const EmbeddedCallback& callback,
+                     std::error_code& error) {
+    size_t hits = 0;
+    error.clear();
+
+    if (path.empty()) {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return hits;
+    }
+    if (!callback) {
+        return hits;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = std::make_error_code(std::errc::no_such_file_or_directory);
+        return hits;
+    }
+
+    // 缓冲区 = 分块 + 确认窗口；每轮只处理其后仍有完整窗口的起始位置，余下部分移到缓冲区头部
+    std::vector<uint8_t> buffer(kScanChunkSize + kMaxHeaderSize);
+    size_t filled = 0;
+    uint64_t base = 0;
+    bool eof = false;
+
+    while (!eof) {
+        file.read(reinterpret_cast<char*>(buffer.data() + filled),
+                  static_cast<std::streamsize>(buffer.size() - filled));
+        filled += static_cast<size_t>(file.gcount());
+        if (!file) {
+            if (!file.eof()) {
+                error = std::make_error_code(std::errc::io_error);
+                return hits;
+            }
+            eof = true;
+        }
+
+        size_t start_end = eof ? filled : filled - std::min(filled, kMaxHeaderSize);
+        if (!scan_starts(buffer.data(), filled, start_end, base, callback, hits)) {
+            return hits;
+        }
+
+        std::memmove(buffer.data(), buffer.data() + start_end, filled - start_end);
+        filled -= start_end;
+        base += start_end;
+    }
+
+    return hits;
+}
+
+}  // namespace fileformat
@@ -0,0 +1,54 @@
+#include "fileformat/source.hpp"
+
+#include <fstream>
+#include <memory>
+#include <new>
+
+namespace fileformat {
+
+//==============================================================================
+// 本地文件数据源
+//==============================================================================
+
+struct FileSource::File {
+    std::ifstream stream;
+};
+
+FileSource::FileSource(const std::string& path) noexcept {
+    if (path.empty()) {
+        return;
+    }
+    std::unique_ptr<File> file;
+    try {
+        file = std::make_unique<File>();
+    } catch (const std::bad_alloc&) {
+        return;  // 分配失败：file_ 保持为空，is_open() 返回 false
+    }
+    file->stream.open(path, std::ios::binary);
+    file->stream.seekg(0, std::ios::end);
+    auto end = file->stream.tellg();
+    if (!file->stream || end == std::ifstream::pos_type(-1)) {
+        return;
+    }
+    size_ = static_cast<uint64_t>(end);
+    file_ = std::move(file);
+}
+
+FileSource::~FileSource() = default;
+
+FileSource::FileSource(FileSource&& other) noexcept = default;
+
+FileSource& FileSource::operator=(FileSource&& other) noexcept = default;
+
+size_t FileSource::read_at(uint64_t offset, uint8_t* out, size_t length) noexcept {
+    if (!file_ || offset >= size_) {
+        return 0;
+    }
+    std::ifstream& stream = file_->stream;
+    stream.clear();
+    stream.seekg(static_cast<std::streamoff>(offset));
+    stream.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(length));
+    return static_cast<size_t>(stream.gcount());
+}
+
+}  // namespace fileformat
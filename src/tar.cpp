@@ -0,0 +1,382 @@
+#include "fileformat/detector.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+#include "formats/tar.hpp"
+
+namespace fileformat {
+
+namespace {
+
+using detail::kTarBlockSize;
+
+// 普通文件数据的窥视大小（与 detect() 的头部窗口一致）
+constexpr size_t kTarPeekSize = kMaxHeaderSize;
+
+// GNU 长文件名与 PAX 扩展头保留的数据上限，超出部分跳过
+constexpr uint64_t kTarMaxMetadataSize = 64 * 1024;
+
+// 类型标志
+constexpr char kTarTypeRegular = '0';
+constexpr char kTarTypeRegularOld = '\0';
+constexpr char kTarTypeContiguous = '7';
+constexpr char kTarTypeGnuLongName = 'L';
+constexpr char kTarTypeGnuLongLink = 'K';
+constexpr char kTarTypePax = 'x';
+constexpr char kTarTypePaxGlobal = 'g';
+
+// POSIX ustar magic（GNU 格式为 "ustar  \0"，该位置没有 prefix 字段）
+constexpr char kTarPosixMagic[] = "ustar";  // 含结尾的 NUL，共 6 字节
+
+/// 顺序输入源：TAR 遍历只需读取与向前跳过
+class TarInput {
+public:
+    virtual ~TarInput() = default;
+
+    /// 读取至多 length 字节
+    /// @return 实际读取的字节数，到达末尾或出错时小于 length
+    virtual size_t read(uint8_t* out, size_t length) = 0;
+
+    /// 向前跳过 length 字节
+    /// @return 剩余数据不足或出错时返回 false
+    virtual bool skip(uint64_t length) = 0;
+};
+
+/// 流输入源：可定位时以 seekg 跳过成员数据，管道等不可定位的流则读取丢弃
+class StreamInput final : public TarInput {
+public:
+    explicit StreamInput(std::istream& stream) : stream_(stream) {
+        auto start = stream_.tellg();
+        if (start == std::istream::pos_type(-1)) {
+            return;
+        }
+        stream_.seekg(0, std::ios::end);
+        auto end = stream_.tellg();
+        stream_.seekg(start);
+        if (end != std::istream::pos_type(-1) && stream_) {
+            seekable_ = true;
+            remaining_ = static_cast<uint64_t>(end - start);
+        } else {
+            stream_.clear();
+        }
+    }
+
+    size_t read(uint8_t* out, size_t length) override {
+        stream_.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(length));
+        auto count = static_cast<size_t>(stream_.gcount());
+        remaining_ -= std::min<uint64_t>(remaining_, count);
+        return count;
+    }
+
+    bool skip(uint64_t length) override {
+        if (length == 0) {
+            return true;
+        }
+        if (seekable_) {
+            if (length > remaining_) {
+                return false;
+            }
+            stream_.seekg(static_cast<std::streamoff>(length), std::ios::cur);
+            remaining_ -= length;
+            return static_cast<bool>(stream_);
+        }
+        while (length > 0) {
+            auto chunk = static_cast<std::streamsize>(
+                std::min<uint64_t>(length, std::numeric_limits<std::streamsize>::max()));
+            stream_.ignore(chunk);
+            if (stream_.gcount() != chunk) {
+                return false;
+            }
+            length -= static_cast<uint64_t>(chunk);
+        }
+        return true;
+    }
+
+private:
+    std::istream& stream_;
+    bool seekable_ = false;
+    uint64_t remaining_ = 0;  // 仅在可定位时有效
+};
+
+/// 内存输入源
+class MemoryInput final : public TarInput {
+public:
+    MemoryInput(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    size_t read(uint8_t* out, size_t length) override {
+        size_t count = std::min(length, size_ - pos_);
+        std::memcpy(out, data_ + pos_, count);
+        pos_ += count;
+        return count;
+    }
+
+    bool skip(uint64_t length) override {
+        if (length > size_ - pos_) {
+            pos_ = size_;
+            return false;
+        }
+        pos_ += static_cast<size_t>(length);
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+/// 定长字段中以 NUL 结束的字符串
+std::string_view field_string(const uint8_t* field, size_t length) {
+    const auto* text = reinterpret_cast<const char*>(field);
+    return {text, static_cast<size_t>(std::find(text, text + length, '\0') - text)};
+}
+
+/// 解析十进制数字，全部为数字时返回 true
+bool parse_decimal(std::string_view text, uint64_t& value) {
+    value = 0;
+    if (text.empty()) {
+        return false;
+    }
+    for (char c : text) {
+        if (c < '0' || c > '9' || value > (std::numeric_limits<uint64_t>::max() - 9) / 10) {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return true;
+}
+
+uint64_t round_to_block(uint64_t size) {
+    return (size + kTarBlockSize - 1) / kTarBlockSize * kTarBlockSize;
+}
+
+bool is_zero_block(const uint8_t* block) {
+    return std::all_of(block, block + kTarBlockSize, [](uint8_t b) { return b == 0; });
+}
+
+bool is_regular(char type) {
+    return type == kTarTypeRegular || type == kTarTypeRegularOld || type == kTarTypeContiguous;
+}
+
+/// 作用于下一个成员的扩展信息（GNU 长文件名、PAX 扩展头）
+struct PendingAttributes {
+    std::string long_name;
+    std::string pax_path;
+    uint64_t pax_size = 0;
+    bool has_pax_size = false;
+
+    void clear() {
+        long_name.clear();
+        pax_path.clear();
+        has_pax_size = false;
+    }
+
+    /// 应用 PAX 记录："<长度> <键>=<值>\n"，长度包含整条记录
+    void apply_pax(std::string_view records) {
+        size_t pos = 0;
+        while (pos < records.size()) {
+            size_t space = records.find(' ', pos);
+            uint64_t length = 0;
+            if (space == std::string_view::npos ||
+                !parse_decimal(records.substr(pos, space - pos), length) ||
+                length <= space - pos || length > records.size() - pos) {
+                return;
+            }
+            std::string_view record = records.substr(space + 1, pos + length - space - 1);
+            if (!record.empty() && record.back() == '\n') {
+                record.remove_suffix(1);
+            }
+            size_t eq = record.find('=');
+            if (eq != std::string_view::npos) {
+                std::string_view key = record.substr(0, eq);
+                std::string_view value = record.substr(eq + 1);
+                if (key == "path") {
+                    pax_path.assign(value);
+                } else if (key == "size") {
+                    has_pax_size = parse_decimal(value, pax_size);
+                }
+            }
+            pos += static_cast<size_t>(length);
+        }
+    }
+};
+
+/// TAR 成员遍历器：每个成员只读取头部块与数据开头，其余数据交给输入源跳过
+class TarWalker {
+public:
+    TarWalker(TarInput& input, const TarMemberCallback& callback)
+        : input_(input), callback_(callback), peek_(kTarPeekSize) {}
+
+    size_t run(std::error_code& error) {
+        size_t reported = 0;
+        uint8_t header[kTarBlockSize];
+        while (true) {
+            size_t count = input_.read(header, kTarBlockSize);
+            if (count == 0) {
+                break;  // 缺少结束块的归档
+            }
+            if (count < kTarBlockSize) {
+                error = std::make_error_code(std::errc::io_error);
+                break;
+            }
+            offset_ += kTarBlockSize;
+            if (is_zero_block(header)) {
+                break;  // 结束标记
+            }
+
+            uint64_t size = 0;
+            if (!detail::is_valid_tar_header(header) ||
+                !detail::parse_tar_number(header + detail::kTarSizeOffset, detail::kTarSizeLength,
+                                          size)) {
+                error = std::make_error_code(std::errc::illegal_byte_sequence);
+                break;
+            }
+
+            char type = static_cast<char>(header[detail::kTarTypeOffset]);
+            if (type == kTarTypeGnuLongName || type == kTarTypeGnuLongLink ||
+                type == kTarTypePax || type == kTarTypePaxGlobal) {
+                if (!read_metadata(type, size)) {
+                    error = std::make_error_code(std::errc::io_error);
+                    break;
+                }
+                continue;
+            }
+
+            if (pending_.has_pax_size) {
+                size = pending_.pax_size;
+            }
+            TarMember member;
+            member.path = member_path(header);
+            member.size = size;
+            member.offset = offset_;
+            member.type = type;
+
+            // 只窥视普通文件的开头
+            size_t consumed = 0;
+            bool complete = true;
+            if (is_regular(type) && size > 0) {
+                auto want = static_cast<size_t>(std::min<uint64_t>(size, peek_.size()));
+                consumed = input_.read(peek_.data(), want);
+                member.format = detect(peek_.data(), consumed);
+                complete = consumed == want;
+            }
+
+            ++reported;
+            bool keep_going = callback_(member);
+            pending_.clear();
+            if (!keep_going) {
+                break;
+            }
+
+            uint64_t padded = round_to_block(size);
+            if (!complete || !input_.skip(padded - consumed)) {
+                error = std::make_error_code(std::errc::io_error);
+                break;
+            }
+            offset_ += padded;
+        }
+        return reported;
+    }
+
+private:
+    /// 读取 GNU 长文件名/PAX 扩展头的数据（保留至多 kTarMaxMetadataSize 字节），跳过其余部分与填充
+    bool read_metadata(char type, uint64_t size) {
+        auto keep = static_cast<size_t>(std::min(size, kTarMaxMetadataSize));
+        metadata_.resize(keep);
+        if (input_.read(reinterpret_cast<uint8_t*>(metadata_.data()), keep) != keep) {
+            return false;
+        }
+        uint64_t padded = round_to_block(size);
+        if (!input_.skip(padded - keep)) {
+            return false;
+        }
+        offset_ += padded;
+
+        if (type == kTarTypeGnuLongName) {
+            pending_.long_name.assign(metadata_.c_str());
+        } else if (type == kTarTypePax) {
+            pending_.apply_pax(metadata_);
+        }
+        return true;
+    }
+
+    /// 成员路径：PAX path > GNU 长文件名 > ustar prefix + "/" + name
+    std::string_view member_path(const uint8_t* header) {
+        if (!pending_.pax_path.empty()) {
+            return pending_.pax_path;
+        }
+        if (!pending_.long_name.empty()) {
+            return pending_.long_name;
+        }
+        path_.clear();
+        if (std::memcmp(header + detail::kTarMagicOffset, kTarPosixMagic, sizeof(kTarPosixMagic)) ==
+            0) {
+            auto prefix = field_string(header + detail::kTarPrefixOffset, detail::kTarPrefixLength);
+            if (!prefix.empty()) {
+                path_.assign(prefix);
+                path_ += '/';
+            }
+        }
+        path_ += field_string(header + detail::kTarNameOffset, detail::kTarNameLength);
+        return path_;
+    }
+
+    TarInput& input_;
+    const TarMemberCallback& callback_;
+    std::vector<uint8_t> peek_;
+    std::string metadata_;
+    std::string path_;
+    PendingAttributes pending_;
+    uint64_t offset_ = 0;
+};
+
+}  // namespace
+
+//==============================================================================
+// TAR 成员遍历
+//==============================================================================
+
+size_t walk_tar(std::istream& stream, const TarMemberCallback& callback, std::error_code& error) {
+    error.clear();
+    if (!callback) {
+        return 0;
+    }
+    if (!stream) {
+        error = std::make_error_code(std::errc::io_error);
+        return 0;
+    }
+    StreamInput input(stream);
+    return TarWalker(input, callback).run(error);
+}
+
+size_t walk_tar(const std::string& path, const TarMemberCallback& callback,
+                std::error_code& error) {
+    error.clear();
+    if (path.empty()) {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return 0;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = std::make_error_code(std::errc::no_such_file_or_directory);
+        return 0;
+    }
+    return walk_tar(file, callback, error);
+}
+
+size_t walk_tar(const uint8_t* data, size_t size, const TarMemberCallback& callback,
+                std::error_code& error) {
+    error.clear();
+    if (data == nullptr || size == 0 || !callback) {
+        return 0;
+    }
+    MemoryInput input(data, size);
+    return TarWalker(input, callback).run(error);
+}
+
+}  // namespace fileformat
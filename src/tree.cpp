@@ -0,0 +1,240 @@
+#include "fileformat/detector.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "formats/byte_utils.hpp"
+#include "formats/inflate.hpp"
+#include "formats/tar.hpp"
+
+namespace fileformat {
+
+namespace {
+
+// 每层解压载荷的窥视大小（与 detect() 的头部窗口一致）
+constexpr size_t kTreePeekSize = kMaxHeaderSize;
+
+// 嵌套深度上限（暂存区最多 32 x 4 KB）与节点表预留数：调用方传入的预算再大也不预先分配
+constexpr uint32_t kMaxTreeDepth = 32;
+constexpr size_t kTreeNodeReserve = 64;
+
+// ZIP 本地文件头（APPNOTE 4.3.7）
+constexpr uint32_t kZipLocalHeaderSignature = 0x04034B50;
+constexpr size_t kZipLocalHeaderSize = 30;
+constexpr uint16_t kZipFlagEncrypted = 0x0001;
+constexpr uint16_t kZipFlagDataDescriptor = 0x0008;
+constexpr uint16_t kZipMethodStored = 0;
+constexpr uint16_t kZipMethodDeflate = 8;
+
+bool is_zip_family(Format format) {
+    return format == Format::ZIP || format == Format::DOCX || format == Format::XLSX ||
+           format == Format::PPTX || format == Format::EPUB;
+}
+
+/// 容器树遍历器
+/// 暂存区按深度切分为固定大小的槽位，子层解压输出写入下一层的槽位，返回后自然释放
+class TreeWalker {
+public:
+    TreeWalker(const TreeOptions& options, std::vector<FormatNode>& nodes)
+        : options_(options),
+          nodes_(nodes),
+          max_depth_(std::min(options.max_depth, kMaxTreeDepth)),
+          byte_budget_(options.max_bytes) {
+        arena_.resize(static_cast<size_t>(max_depth_) * kTreePeekSize);
+        nodes_.reserve(std::min(options.max_nodes, kTreeNodeReserve));
+    }
+
+    /// 检测一段内容并在可能时递归进入
+    /// @param allow_text 是否报告文本格式（容器条目中的 XML/文本清单过多，只在压缩流载荷中报告）
+    /// @return 该节点已确认覆盖的字节数（用于跳过落在已遍历容器内的嵌入命中）
+    size_t visit(const uint8_t* data, size_t size, uint64_t offset, int parent, uint32_t depth,
+                 bool allow_text) {
+        if (nodes_.size() >= options_.max_nodes) {
+            return 0;
+        }
+
+        Format format = detect(data, size);
+        if (parent >= 0 && (format == Format::Unknown ||
+                            (!allow_text && get_info(format).category == Category::Text))) {
+            return 0;
+        }
+
+        int index = static_cast<int>(nodes_.size());
+        nodes_.push_back({offset, format, depth, parent});
+        if (depth >= max_depth_) {
+            return 0;
+        }
+
+        if (format == Format::GZip) {
+            descend_gzip(data, size, index, depth);
+            return 0;
+        }
+        if (is_zip_family(format)) {
+            return walk_zip(data, size, index, depth);
+        }
+        if (format == Format::Tar) {
+            return walk_tar(data, size, index, depth);
+        }
+        if (get_info(format).category == Category::Executable) {
+            scan_appended(data, size, index, depth);
+        }
+        return 0;
+    }
+
+private:
+    /// 在暂存区中为 depth 层分配解压输出槽位，受剩余字节预算限制
+    uint8_t* slot(uint32_t depth, size_t& capacity) {
+        capacity = std::min(kTreePeekSize, byte_budget_);
+        return arena_.data() + static_cast<size_t>(depth) * kTreePeekSize;
+    }
+
+    void descend_gzip(const uint8_t* data, size_t size, int index, uint32_t depth) {
+        size_t capacity = 0;
+        uint8_t* out = slot(depth, capacity);
+        size_t produced = detail::gunzip_prefix(data, size, out, capacity);
+        byte_budget_ -= produced;
+        visit(out, produced, 0, index, depth + 1, true);
+    }
+
+    /// 顺序遍历 ZIP 本地文件头，探测每个条目的数据
+    size_t walk_zip(const uint8_t* data, size_t size, int index, uint32_t depth) {
+        size_t pos = 0;
+        while (pos + kZipLocalHeaderSize <= size && nodes_.size() < options_.max_nodes &&
+               detail::read_le32(data + pos) == kZipLocalHeaderSignature) {
+            const uint8_t* header = data + pos;
+            uint16_t flags = detail::read_le16(header + 6);
+            uint16_t method = detail::read_le16(header + 8);
+            uint64_t compressed_size = detail::read_le32(header + 18);
+            size_t name_len = detail::read_le16(header + 26);
+            size_t extra_len = detail::read_le16(header + 28);
+
+            size_t data_offset = pos + kZipLocalHeaderSize + name_len + extra_len;
+            if (data_offset > size) {
+                break;
+            }
+            size_t available = size - data_offset;
+            bool size_known = (flags & kZipFlagDataDescriptor) == 0 || compressed_size != 0;
+            size_t entry_size = size_known ? static_cast<size_t>(std::min<uint64_t>(
+                                                 compressed_size, available))
+                                           : available;
+
+            if ((flags & kZipFlagEncrypted) == 0 && entry_size > 0) {
+                if (method == kZipMethodStored) {
+                    visit(data + data_offset, entry_size, data_offset, index, depth + 1, false);
+                } else if (method == kZipMethodDeflate && byte_budget_ > 0) {
+                    size_t capacity = 0;
+                    uint8_t* out = slot(depth, capacity);
+                    size_t produced =
+                        detail::inflate_prefix(data + data_offset, entry_size, out, capacity);
+                    byte_budget_ -= produced;
+                    visit(out, produced, data_offset, index, depth + 1, false);
+                }
+            }
+
+            // 大小记录在数据描述符中时无法定位下一个条目
+            if (!size_known || compressed_size > available) {
+                return size;
+            }
+            pos = data_offset + static_cast<size_t>(compressed_size);
+        }
+        return pos;
+    }
+
+    /// 顺序遍历 TAR 成员头，探测每个普通文件的数据
+    size_t walk_tar(const uint8_t* data, size_t size, int index, uint32_t depth) {
+        size_t pos = 0;
+        using detail::kTarBlockSize;
+        while (pos + kTarBlockSize <= size && nodes_.size() < options_.max_nodes) {
+            const uint8_t* header = data + pos;
+            if (std::memcmp(header + detail::kTarMagicOffset, "ustar", 5) != 0) {
+                break;
+            }
+            uint64_t member_size = 0;
+            if (!detail::parse_tar_number(header + detail::kTarSizeOffset, detail::kTarSizeLength,
+                                          member_size)) {
+                break;
+            }
+
+            size_t data_offset = pos + kTarBlockSize;
+            size_t available = size - data_offset;
+            uint8_t type = header[detail::kTarTypeOffset];
+            if ((type == '0' || type == 0) && member_size > 0) {
+                size_t entry_size = static_cast<size_t>(std::min<uint64_t>(member_size, available));
+                visit(data + data_offset, entry_size, data_offset, index, depth + 1, false);
+            }
+
+            uint64_t padded = (member_size + kTarBlockSize - 1) / kTarBlockSize * kTarBlockSize;
+            if (padded > available) {
+                return size;
+            }
+            pos = data_offset + static_cast<size_t>(padded);
+        }
+        return pos;
+    }
+
+    /// 可执行文件后附加或内嵌的数据（自解压包、安装程序等）
+    void scan_appended(const uint8_t* data, size_t size, int index, uint32_t depth) {
+        size_t covered_end = 0;
+        scan_embedded(data, size, [&](uint64_t offset, Format) {
+            if (offset == 0 || offset < covered_end) {
+                return true;
+            }
+            auto start = static_cast<size_t>(offset);
+            size_t extent = visit(data + start, size - start, offset, index, depth + 1, false);
+            covered_end = start + extent;
+            return nodes_.size() < options_.max_nodes;
+        });
+    }
+
+    const TreeOptions& options_;
+    std::vector<FormatNode>& nodes_;
+    uint32_t max_depth_;  // 截断到 kMaxTreeDepth 的 options_.max_depth
+    std::vector<uint8_t> arena_;
+    size_t byte_budget_;
+};
+
+}  // namespace
+
+//==============================================================================
+// 容器树检测
+//==============================================================================
+
+std::vector<FormatNode> detect_tree(const uint8_t* data, size_t size, const TreeOptions& options) {
+    std::vector<FormatNode> nodes;
+    if (data == nullptr || size == 0 || options.max_nodes == 0) {
+        return nodes;
+    }
+    TreeWalker(options, nodes).visit(data, size, 0, -1, 0, true);
+    return nodes;
+}
+
+std::vector<FormatNode> detect_tree(const std::string& path, const TreeOptions& options,
+                                    std::error_code& error) {
+    error.clear();
+    if (path.empty()) {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return {};
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = std::make_error_code(std::errc::no_such_file_or_directory);
+        return {};
+    }
+
+    file.seekg(0, std::ios::end);
+    auto file_size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(std::min<uint64_t>(file_size, options.max_bytes)));
+    file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if (!file) {
+        error = std::make_error_code(std::errc::io_error);
+        return {};
+    }
+
+    return detect_tree(buffer.data(), buffer.size(), options);
+}
+
+}  // namespace fileformat
@@ -0,0 +1,70 @@
+#ifndef FILEFORMAT_TESTS_TEMP_FILE_HPP
+#define FILEFORMAT_TESTS_TEMP_FILE_HPP
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fileformat {
+namespace test {
+
+/// 测试用临时文件：构造时写入内容，析构时删除（断言失败提前返回时同样删除）
+/// 文件名由进程号、当前测试名与序号组成，ctest 并行运行时互不冲突
+class TempFile {
+public:
+    explicit TempFile(const std::vector<uint8_t>& data) {
+        write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    explicit TempFile(const std::string& data) { write(data.data(), data.size()); }
+
+    ~TempFile() { std::remove(path_.c_str()); }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    /// 完整路径
+    const std::string& path() const { return path_; }
+
+    /// 相对 ::testing::TempDir() 的文件名
+    const std::string& name() const { return name_; }
+
+private:
+    void write(const char* data, size_t size) {
+        static std::atomic<unsigned> counter{0};
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+#if defined(_WIN32)
+        long pid = _getpid();
+#else
+        long pid = static_cast<long>(::getpid());
+#endif
+        name_ = "fileformat_" + std::to_string(pid) + "_" +
+                (test != nullptr ? std::string(test->test_suite_name()) + "_" + test->name()
+                                 : std::string("global")) +
+                "_" + std::to_string(counter++) + ".bin";
+        path_ = ::testing::TempDir() + name_;
+
+        std::ofstream out(path_, std::ios::binary);
+        out.write(data, static_cast<std::streamsize>(size));
+        EXPECT_TRUE(out.good()) << "failed to write " << path_;
+    }
+
+    std::string name_;
+    std::string path_;
+};
+
+}  // namespace test
+}  // namespace fileformat
+
+#endif  // FILEFORMAT_TESTS_TEMP_FILE_HPP
@@ -1,15 +1,48 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace fileformat {
 namespace {
 
-class ApiTest : public ::testing::Test {};
+class ApiTest : public ::testing::Test {
+protected:
+    // 所有路径 API 对同一文件给出相同的格式
+    static void expect_path_agreement(const std::vector<uint8_t>& data, Format expected) {
+        test::TempFile file(data);
+        const auto& path = file.path();
+
+        EXPECT_EQ(detect(path), expected);
+        EXPECT_EQ(detect_safe(path).format, expected);
+        EXPECT_EQ(detect_or_throw(path), expected);
+        EXPECT_EQ(detect_layered(path).outer, expected);
+        EXPECT_EQ(check_complete(path).format, expected);
+
+        ContentProfile profile;
+        EXPECT_EQ(detect_safe(path, profile).format, expected);
+        ExecutableInfo executable;
+        EXPECT_EQ(detect_safe(path, executable).format, expected);
+        MediaInfo media;
+        EXPECT_EQ(detect_safe(path, media).format, expected);
+        LayoutInfo layout;
+        EXPECT_EQ(detect_safe(path, layout).format, expected);
+        ImageInfo image;
+        EXPECT_EQ(detect_safe(path, image).format, expected);
+    }
+};
 
 // Format 枚举测试
 TEST_F(ApiTest, FormatEnumValues) {
@@ -52,6 +85,9 @@ TEST_F(ApiTest, CategoryNames) {
     EXPECT_EQ(get_category_name(Category::Archive), "archive");
     EXPECT_EQ(get_category_name(Category::Media), "media");
     EXPECT_EQ(get_category_name(Category::Executable), "executable");
+    EXPECT_EQ(get_category_name(Category::Text), "text");
+    EXPECT_EQ(get_category_name(Category::Data), "data");
+    EXPECT_EQ(get_category_name(Category::DiskImage), "disk_image");
 }
 
 // 图像格式类别测试
@@ -107,6 +143,15 @@ TEST_F(ApiTest, ExecutableFormatsHaveExecutableCategory) {
     EXPECT_EQ(get_info(Format::MachO).category, Category::Executable);
 }
 
+// 文本格式类别测试
+TEST_F(ApiTest, TextFormatsHaveTextCategory) {
+    EXPECT_EQ(get_info(Format::Text).category, Category::Text);
+    EXPECT_EQ(get_info(Format::XML).category, Category::Text);
+    EXPECT_EQ(get_info(Format::JSON).category, Category::Text);
+    EXPECT_EQ(get_info(Format::HTML).category, Category::Text);
+    EXPECT_EQ(get_info(Format::CSV).category, Category::Text);
+}
+
 // MIME 类型测试
 TEST_F(ApiTest, CommonMimeTypes) {
     EXPECT_EQ(get_info(Format::PNG).mime_type, "image/png");
@@ -153,6 +198,149 @@ TEST_F(ApiTest, StreamAndBufferConsistency) {
     EXPECT_EQ(buffer_format, Format::JPEG);
 }
 
+// 分段检测：签名跨越段边界
+TEST_F(ApiTest, SegmentsStraddlingSignature) {
+    std::vector<uint8_t> head = {0x89, 0x50, 0x4E};
+    std::vector<uint8_t> middle = {0x47, 0x0D};
+    std::vector<uint8_t> tail = {0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D};
+    ByteSegment segments[] = {{head.data(), head.size()},
+                              {nullptr, 0},
+                              {middle.data(), middle.size()},
+                              {tail.data(), tail.size()}};
+    EXPECT_EQ(detect_segments(segments, 4), Format::PNG);
+    EXPECT_EQ(detect_segments(segments, 2), Format::Unknown);
+    EXPECT_EQ(detect_segments(nullptr, 0), Format::Unknown);
+}
+
+// 分段检测：结构校验（偏移 257 的 ustar magic 与头部校验和）跨越段边界
+TEST_F(ApiTest, SegmentsStructuralCheckAcrossFragments) {
+    std::vector<uint8_t> tar(1024, 0);
+    std::copy_n("notes.txt", 9, tar.begin());
+    std::copy_n("00000000012", 11, tar.begin() + 124);
+    tar[156] = '0';
+    std::copy_n("ustar", 6, tar.begin() + 257);
+    std::copy_n("00", 2, tar.begin() + 263);
+    std::fill(tar.begin() + 148, tar.begin() + 156, ' ');
+    unsigned sum = 0;
+    for (size_t i = 0; i < 512; ++i) {
+        sum += tar[i];
+    }
+    char checksum[8];
+    std::snprintf(checksum, sizeof(checksum), "%06o", sum);
+    std::copy(checksum, checksum + 7, tar.begin() + 148);
+    ASSERT_EQ(detect(tar.data(), tar.size()), Format::Tar);
+
+    // 不相邻的分段（各自独立的缓冲区）
+    std::vector<uint8_t> first(tar.begin(), tar.begin() + 260);
+    std::vector<uint8_t> second(tar.begin() + 260, tar.end());
+    ByteSegment fragments[] = {{first.data(), first.size()}, {second.data(), second.size()}};
+    EXPECT_EQ(detect_segments(fragments, 2), Format::Tar);
+
+    // 同一缓冲区内相邻的分段
+    ByteSegment adjacent[] = {{tar.data(), 200}, {tar.data() + 200, 600}, {tar.data() + 800, 224}};
+    EXPECT_EQ(detect_segments(adjacent, 3), Format::Tar);
+}
+
+#if !defined(_WIN32)
+// 分段检测：签名足以判定时不收集检测窗口。首段之后的段位于不可访问的内存页，
+// 一旦收集窗口就会触发段错误
+TEST_F(ApiTest, SegmentsSignatureWithoutGather) {
+    auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* mapping = mmap(nullptr, page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+    auto* guard = static_cast<uint8_t*>(mapping) + page;
+    ASSERT_EQ(mprotect(guard, page, PROT_NONE), 0);
+    ASSERT_GE(page, 2596u);
+
+    // 以 1500 字节（以太网 MTU）切分的 4 KB 窗口，签名另在首段内跨越两个缓冲区
+    auto detect_split = [guard](std::vector<uint8_t> header) {
+        header.resize(1500, ' ');
+        std::vector<uint8_t> lead(header.begin(), header.begin() + 3);
+        std::vector<uint8_t> rest(header.begin() + 3, header.end());
+        ByteSegment segments[] = {{lead.data(), lead.size()},
+                                  {rest.data(), rest.size()},
+                                  {guard, 1500},
+                                  {guard + 1500, 1096}};
+        return detect_segments(segments, 4);
+    };
+
+    EXPECT_EQ(detect_split({0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D,
+                            'I', 'H', 'D', 'R'}),
+              Format::PNG);
+
+    std::vector<uint8_t> zip = {'P', 'K', 0x03, 0x04, 0x0A, 0x00};
+    zip.resize(26, 0);
+    zip.insert(zip.end(), {5, 0, 0, 0, 'a', '.', 't', 'x', 't'});
+    EXPECT_EQ(detect_split(zip), Format::ZIP);
+
+    std::string pdf = "%PDF-1.7\n1 0 obj\n<< /Type /Catalog >>\nendobj\n";
+    EXPECT_EQ(detect_split(std::vector<uint8_t>(pdf.begin(), pdf.end())), Format::PDF);
+
+    munmap(mapping, page * 2);
+}
+#endif
+
+// 分段检测：签名之后需要更深的检查时仍与整体检测一致
+TEST_F(ApiTest, SegmentsSignatureDefersToDeeperChecks) {
+    // 以 %PDF 开头的 TAR 成员名：归档层的 ustar 检查先于文档层
+    std::vector<uint8_t> tar(1024, 0);
+    std::copy_n("%PDF-notes", 10, tar.begin());
+    std::copy_n("ustar", 6, tar.begin() + 257);
+    std::vector<uint8_t> first(tar.begin(), tar.begin() + 100);
+    std::vector<uint8_t> second(tar.begin() + 100, tar.end());
+    ByteSegment fragments[] = {{first.data(), first.size()}, {second.data(), second.size()}};
+    EXPECT_EQ(detect_segments(fragments, 2), detect(tar.data(), tar.size()));
+}
+
+// 分段检测与流检测使用相同的检测窗口
+TEST_F(ApiTest, SegmentsMatchStreamWindow) {
+    std::string json = "{\"items\": [" + std::string(6000, ' ') + "1]}";
+    std::vector<uint8_t> data(json.begin(), json.end());
+    std::istringstream stream(json);
+    Format stream_format = detect(stream);
+
+    std::vector<ByteSegment> segments;
+    for (size_t offset = 0; offset < data.size(); offset += 1500) {
+        segments.push_back({data.data() + offset, std::min<size_t>(1500, data.size() - offset)});
+    }
+    EXPECT_EQ(detect_segments(segments.data(), segments.size()), stream_format);
+
+    std::vector<std::vector<uint8_t>> copies;
+    std::vector<ByteSegment> scattered;
+    for (const auto& segment : segments) {
+        copies.emplace_back(segment.data, segment.data + segment.size);
+    }
+    for (const auto& copy : copies) {
+        scattered.push_back({copy.data(), copy.size()});
+    }
+    EXPECT_EQ(detect_segments(scattered.data(), scattered.size()), stream_format);
+}
+
+TEST_F(ApiTest, PathOverloadsAgree) {
+    // ISO 9660：卷描述符位于 32 KB 处，只能通过远偏移探测识别
+    std::vector<uint8_t> iso(19 * 2048, 0);
+    for (size_t sector : {16, 17}) {
+        std::string id = "CD001";
+        std::copy(id.begin(), id.end(), iso.begin() + sector * 2048 + 1);
+    }
+    expect_path_agreement(iso, Format::ISO9660);
+
+    // 缺少页脚的 Parquet：尾部确认失败，所有 API 均报告 Unknown
+    std::vector<uint8_t> parquet = {'P', 'A', 'R', '1'};
+    parquet.resize(kMaxHeaderSize * 2, 0x11);
+    expect_path_agreement(parquet, Format::Unknown);
+
+    test::TempFile file(parquet);
+    EXPECT_TRUE(check_complete(file.path()).is_truncated());
+
+    // 页脚完整时判定为完整
+    std::vector<uint8_t> footer = {0x10, 0x00, 0x00, 0x00, 'P', 'A', 'R', '1'};
+    parquet.insert(parquet.end(), footer.begin(), footer.end());
+    expect_path_agreement(parquet, Format::Parquet);
+    test::TempFile complete(parquet);
+    EXPECT_EQ(check_complete(complete.path()).completeness, Completeness::Complete);
+}
+
 }  // namespace
 }  // namespace fileformat
 
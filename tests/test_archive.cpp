@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include "fileformat/fileformat.hpp"
@@ -20,11 +22,50 @@ protected:
     const std::vector<uint8_t> sevenzip_magic = {0x37, 0x7A, 0xBC, 0xAF, 0x27, 0x1C};
 
     // GZIP
-    const std::vector<uint8_t> gzip_magic = {0x1F, 0x8B, 0x08};
+    const std::vector<uint8_t> gzip_magic = {0x1F, 0x8B, 0x08, 0x00};
 
     // TAR (ustar at offset 257) - simplified test data
     std::vector<uint8_t> tar_magic;
 
+    // 构造第一个条目名为 filename 的 ZIP 本地文件头，后接 payload
+    static std::vector<uint8_t> make_zip(const std::string& filename, const std::string& payload) {
+        std::vector<uint8_t> data = {0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00};
+        data.resize(26, 0);
+        data.push_back(static_cast<uint8_t>(filename.size()));
+        data.push_back(0);
+        data.push_back(0);
+        data.push_back(0);
+        data.insert(data.end(), filename.begin(), filename.end());
+        data.insert(data.end(), payload.begin(), payload.end());
+        return data;
+    }
+
+    // 构造 GZIP 成员：头部可带原始文件名，载荷以单个未压缩 deflate 块存放
+    static std::vector<uint8_t> make_gzip_stored(const std::vector<uint8_t>& payload,
+                                                 const std::string& name = "") {
+        std::vector<uint8_t> data = {0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0x03};
+        if (!name.empty()) {
+            data[3] = 0x08;  // FNAME
+            data.insert(data.end(), name.begin(), name.end());
+            data.push_back(0);
+        }
+        auto len = static_cast<uint16_t>(payload.size());
+        data.push_back(0x01);  // BFINAL=1, BTYPE=00
+        data.push_back(static_cast<uint8_t>(len));
+        data.push_back(static_cast<uint8_t>(len >> 8));
+        data.push_back(static_cast<uint8_t>(~len));
+        data.push_back(static_cast<uint8_t>(~len >> 8));
+        data.insert(data.end(), payload.begin(), payload.end());
+        return data;
+    }
+
+    // 为 deflate 数据加上最小 GZIP 头
+    static std::vector<uint8_t> make_gzip(const std::vector<uint8_t>& deflate) {
+        std::vector<uint8_t> data = {0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x02, 0x03};
+        data.insert(data.end(), deflate.begin(), deflate.end());
+        return data;
+    }
+
     void SetUp() override {
         // 构造一个最小的 TAR 头
         tar_magic.resize(262, 0);
@@ -42,6 +83,21 @@ TEST_F(ArchiveFormatTest, DetectZip) {
     EXPECT_EQ(format, Format::ZIP);
 }
 
+TEST_F(ArchiveFormatTest, DetectOoxmlByDirectoryNames) {
+    auto docx = make_zip("[Content_Types].xml", "....PK....word/document.xml");
+    EXPECT_EQ(detect(docx.data(), docx.size()), Format::DOCX);
+
+    auto xlsx = make_zip("[Content_Types].xml", "....PK....xl/workbook.xml");
+    EXPECT_EQ(detect(xlsx.data(), xlsx.size()), Format::XLSX);
+
+    auto pptx = make_zip("[Content_Types].xml", "....PK....ppt/presentation.xml");
+    EXPECT_EQ(detect(pptx.data(), pptx.size()), Format::PPTX);
+
+    // word/ 优先于 xl/，与出现顺序无关
+    auto both = make_zip("[Content_Types].xml", "xl/styles.xml....word/document.xml");
+    EXPECT_EQ(detect(both.data(), both.size()), Format::DOCX);
+}
+
 TEST_F(ArchiveFormatTest, DetectRar) {
     auto format = detect(rar_magic.data(), rar_magic.size());
     EXPECT_EQ(format, Format::RAR);
@@ -57,6 +113,202 @@ TEST_F(ArchiveFormatTest, DetectGzip) {
     EXPECT_EQ(format, Format::GZip);
 }
 
+TEST_F(ArchiveFormatTest, RejectGzipWithInvalidHeader) {
+    // 压缩方法不是 deflate
+    std::vector<uint8_t> bad_method = {0x1F, 0x8B, 0x07, 0x00};
+    EXPECT_EQ(detect(bad_method.data(), bad_method.size()), Format::Unknown);
+
+    // 保留标志位被置位
+    std::vector<uint8_t> bad_flags = {0x1F, 0x8B, 0x08, 0x20};
+    EXPECT_EQ(detect(bad_flags.data(), bad_flags.size()), Format::Unknown);
+}
+
+TEST_F(ArchiveFormatTest, DetectLayeredTarGz) {
+    std::vector<uint8_t> tar_block = tar_magic;
+    tar_block.resize(512, 0);
+    auto tgz = make_gzip_stored(tar_block, "backup.tar");
+
+    auto result = detect_layered(tgz.data(), tgz.size());
+    EXPECT_EQ(result.outer, Format::GZip);
+    EXPECT_EQ(result.inner, Format::Tar);
+    EXPECT_TRUE(result.has_inner());
+}
+
+TEST_F(ArchiveFormatTest, DetectLayeredFixedHuffman) {
+    // zlib 压缩的 {"name": "fileformat", "tags": ["a", "b"]}（固定 Huffman 块）
+    auto json_gz = make_gzip({0xAB, 0x56, 0xCA, 0x4B, 0xCC, 0x4D, 0x55, 0xB2, 0x52, 0x50,
+                              0x4A, 0xCB, 0xCC, 0x49, 0x4D, 0xCB, 0x2F, 0xCA, 0x4D, 0x2C,
+                              0x51, 0xD2, 0x51, 0x50, 0x2A, 0x49, 0x4C, 0x2F, 0x06, 0x8A,
+                              0x46, 0x2B, 0x25, 0x82, 0x78, 0x49, 0x4A, 0xB1, 0xB5, 0x00});
+
+    auto result = detect_layered(json_gz.data(), json_gz.size());
+    EXPECT_EQ(result.outer, Format::GZip);
+    EXPECT_EQ(result.inner, Format::JSON);
+}
+
+TEST_F(ArchiveFormatTest, DetectLayeredDynamicHuffman) {
+    // zlib 压缩的 416 字节 XML 文档（动态 Huffman 块）
+    auto xml_gz = make_gzip(
+        {0x75, 0xD1, 0x4B, 0x0A, 0x80, 0x20, 0x14, 0x85, 0xE1, 0xB9, 0xAB, 0x88, 0xBB, 0x80, 0xF2,
+         0xF6, 0x0E, 0x4C, 0xD7, 0x12, 0xE4, 0x40, 0xC8, 0x04, 0x33, 0x69, 0xF9, 0x51, 0xA3, 0x08,
+         0xCE, 0xF4, 0x7C, 0xA3, 0x9F, 0xA3, 0xCC, 0xE5, 0xB7, 0x22, 0xDB, 0x78, 0xB8, 0xB0, 0xCF,
+         0xC4, 0xA5, 0x24, 0xA3, 0x85, 0x8A, 0x21, 0x24, 0xAD, 0x5C, 0xB2, 0xBE, 0x70, 0xEB, 0x4C,
+         0x92, 0x74, 0x5E, 0xB6, 0xD3, 0xAA, 0xEA, 0x99, 0x3E, 0xC0, 0x08, 0x6A, 0x04, 0x0D, 0x82,
+         0x16, 0x41, 0x87, 0xA0, 0x47, 0x30, 0x20, 0x18, 0x11, 0x4C, 0x30, 0x10, 0xA7, 0xC3, 0x76,
+         0x86, 0xF1, 0x0C, 0xEB, 0xF9, 0x9F, 0x5F, 0xBD, 0x17, 0x88, 0x1B});
+
+    auto result = detect_layered(xml_gz.data(), xml_gz.size());
+    EXPECT_EQ(result.outer, Format::GZip);
+    EXPECT_EQ(result.inner, Format::XML);
+
+    // 截断的压缩流：已解出的前缀仍可识别，且不越界
+    for (size_t cut = 0; cut < xml_gz.size(); ++cut) {
+        auto partial = detect_layered(xml_gz.data(), cut);
+        EXPECT_TRUE(partial.inner == Format::Unknown || get_info(partial.inner).category ==
+                                                           Category::Text);
+    }
+}
+
+TEST_F(ArchiveFormatTest, DetectLayeredWithoutInnerFormat) {
+    // 非压缩流不做内层检测
+    auto result = detect_layered(zip_magic.data(), zip_magic.size());
+    EXPECT_EQ(result.outer, Format::ZIP);
+    EXPECT_FALSE(result.has_inner());
+
+    // 只有头部、没有载荷的 GZIP
+    result = detect_layered(gzip_magic.data(), gzip_magic.size());
+    EXPECT_EQ(result.outer, Format::GZip);
+    EXPECT_FALSE(result.has_inner());
+
+    // 损坏的 deflate 块类型（BTYPE=11）
+    auto corrupt = make_gzip({0x07, 0x00, 0x00, 0x00});
+    result = detect_layered(corrupt.data(), corrupt.size());
+    EXPECT_EQ(result.outer, Format::GZip);
+    EXPECT_FALSE(result.has_inner());
+}
+
+TEST_F(ArchiveFormatTest, DetectCompressionStreams) {
+    // zstd：单段帧；非单段帧窗口描述符 0x58（windowLog 21）
+    std::vector<uint8_t> zstd = {0x28, 0xB5, 0x2F, 0xFD, 0x24, 0x00, 0x01, 0x00};
+    EXPECT_EQ(detect(zstd.data(), zstd.size()), Format::Zstd);
+    std::vector<uint8_t> zstd_window = {0x28, 0xB5, 0x2F, 0xFD, 0x04, 0x58, 0x00, 0x00};
+    EXPECT_EQ(detect(zstd_window.data(), zstd_window.size()), Format::Zstd);
+
+    // xz 空流的流头（CRC64 校验类型）
+    std::vector<uint8_t> xz = {0xFD, 0x37, 0x7A, 0x58, 0x5A, 0x00,
+                               0x00, 0x04, 0xE6, 0xD6, 0xB4, 0x46};
+    EXPECT_EQ(detect(xz.data(), xz.size()), Format::XZ);
+
+    std::vector<uint8_t> bzip2 = {0x42, 0x5A, 0x68, 0x39, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59};
+    EXPECT_EQ(detect(bzip2.data(), bzip2.size()), Format::BZip2);
+
+    std::vector<uint8_t> lz4 = {0x04, 0x22, 0x4D, 0x18, 0x64, 0x40, 0xA7};
+    EXPECT_EQ(detect(lz4.data(), lz4.size()), Format::LZ4);
+
+    std::vector<uint8_t> brotli = {0xCE, 0xB2, 0xCF, 0x81, 0x00, 0x00};
+    EXPECT_EQ(detect(brotli.data(), brotli.size()), Format::Brotli);
+
+    std::vector<uint8_t> compress = {0x1F, 0x9D, 0x90, 0x68, 0x00};
+    EXPECT_EQ(detect(compress.data(), compress.size()), Format::UnixCompress);
+
+    EXPECT_EQ(get_info(Format::Zstd).extension, ".zst");
+    EXPECT_EQ(get_info(Format::XZ).category, Category::Archive);
+}
+
+TEST_F(ArchiveFormatTest, RejectCompressionStreamsWithInvalidHeader) {
+    // zstd 帧头保留位被置位
+    std::vector<uint8_t> zstd = {0x28, 0xB5, 0x2F, 0xFD, 0x2C, 0x00, 0x01, 0x00};
+    EXPECT_NE(detect(zstd.data(), zstd.size()), Format::Zstd);
+    // zstd 窗口超出上限（windowLog 41）
+    zstd = {0x28, 0xB5, 0x2F, 0xFD, 0x04, 0xF8, 0x00, 0x00};
+    EXPECT_NE(detect(zstd.data(), zstd.size()), Format::Zstd);
+
+    // xz Stream Flags 的 CRC32 不匹配
+    std::vector<uint8_t> xz = {0xFD, 0x37, 0x7A, 0x58, 0x5A, 0x00,
+                               0x00, 0x04, 0xE6, 0xD6, 0xB4, 0x47};
+    EXPECT_NE(detect(xz.data(), xz.size()), Format::XZ);
+
+    // bzip2 块大小不是 '1'-'9'，或其后不是块头
+    std::vector<uint8_t> bzip2 = {0x42, 0x5A, 0x68, 0x30};
+    EXPECT_NE(detect(bzip2.data(), bzip2.size()), Format::BZip2);
+    bzip2 = {0x42, 0x5A, 0x68, 0x39, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    EXPECT_NE(detect(bzip2.data(), bzip2.size()), Format::BZip2);
+
+    // LZ4 版本号不是 01
+    std::vector<uint8_t> lz4 = {0x04, 0x22, 0x4D, 0x18, 0xA4, 0x40, 0x00};
+    EXPECT_NE(detect(lz4.data(), lz4.size()), Format::LZ4);
+
+    // compress 最大码长超过 16
+    std::vector<uint8_t> compress = {0x1F, 0x9D, 0x91};
+    EXPECT_NE(detect(compress.data(), compress.size()), Format::UnixCompress);
+}
+
+TEST_F(ArchiveFormatTest, DetectEncryptedZip) {
+    auto plain = make_zip("secret.txt", "payload");
+    EXPECT_FALSE(is_encrypted(plain.data(), plain.size()));
+
+    // 传统 PKWARE 加密：通用标志位 bit 0
+    auto zipcrypto = plain;
+    zipcrypto[6] = 0x01;
+    EXPECT_TRUE(is_encrypted(zipcrypto.data(), zipcrypto.size()));
+
+    // WinZip AES：压缩方法 99
+    auto aes = plain;
+    aes[8] = 99;
+    EXPECT_TRUE(is_encrypted(aes.data(), aes.size()));
+
+    // 第二个条目才加密：按压缩后大小跳过第一个条目
+    auto first = make_zip("a.txt", "abc");
+    first[18] = 3;
+    auto both = first;
+    both.insert(both.end(), zipcrypto.begin(), zipcrypto.end());
+    EXPECT_TRUE(is_encrypted(both.data(), both.size()));
+}
+
+TEST_F(ArchiveFormatTest, DetectEncryptedRar) {
+    // RAR 4.x：标记块 + 主头（13 字节）+ 文件头
+    std::vector<uint8_t> rar4 = {0x52, 0x61, 0x72, 0x21, 0x1A, 0x07, 0x00,
+                                 0x00, 0x00, 0x73, 0x00, 0x00, 0x0D, 0x00,
+                                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                 0x00, 0x00, 0x74, 0x00, 0x80, 0x20, 0x00};
+    EXPECT_FALSE(is_encrypted(rar4.data(), rar4.size()));
+    rar4[23] = 0x04;  // 文件数据加密
+    EXPECT_TRUE(is_encrypted(rar4.data(), rar4.size()));
+    rar4[23] = 0x00;
+    rar4[10] = 0x80;  // 块头加密
+    EXPECT_TRUE(is_encrypted(rar4.data(), rar4.size()));
+
+    // RAR 5.0：签名之后直接是头部加密头（类型 4）
+    std::vector<uint8_t> rar5 = {0x52, 0x61, 0x72, 0x21, 0x1A, 0x07, 0x01, 0x00,
+                                 0x00, 0x00, 0x00, 0x00, 0x03, 0x04, 0x00, 0x00};
+    EXPECT_TRUE(is_encrypted(rar5.data(), rar5.size()));
+
+    // RAR 5.0：主头 + 带加密记录（类型 1）的文件头
+    std::vector<uint8_t> rar5_file = {0x52, 0x61, 0x72, 0x21, 0x1A, 0x07, 0x01, 0x00,
+                                      0x00, 0x00, 0x00, 0x00, 0x03, 0x01, 0x00, 0x00,
+                                      0x00, 0x00, 0x00, 0x00, 0x08, 0x02, 0x01, 0x03,
+                                      0x00, 0x00, 0x02, 0x01, 0x00};
+    EXPECT_TRUE(is_encrypted(rar5_file.data(), rar5_file.size()));
+    rar5_file[27] = 0x05;  // 其他扩展记录
+    EXPECT_FALSE(is_encrypted(rar5_file.data(), rar5_file.size()));
+}
+
+TEST_F(ArchiveFormatTest, DetectEncryptedSevenZip) {
+    // 签名头：NextHeaderOffset = 0，NextHeaderSize = 16
+    std::vector<uint8_t> data = sevenzip_magic;
+    data.resize(32, 0);
+    data[20] = 16;
+    std::vector<uint8_t> header = {0x17, 0x06, 0x00, 0x01, 0x09, 0x10, 0x00, 0x07,
+                                   0x0B, 0x01, 0x00, 0x01, 0x21, 0x21, 0x01, 0x00};
+    data.insert(data.end(), header.begin(), header.end());
+    EXPECT_FALSE(is_encrypted(data.data(), data.size()));
+
+    // 编码头的编码器链中出现 7zAES（06 F1 07 01）
+    const std::vector<uint8_t> aes = {0x06, 0xF1, 0x07, 0x01};
+    std::copy(aes.begin(), aes.end(), data.begin() + 32 + 12);
+    EXPECT_TRUE(is_encrypted(data.data(), data.size()));
+}
+
 TEST_F(ArchiveFormatTest, DetectTar) {
     auto format = detect(tar_magic.data(), tar_magic.size());
     EXPECT_EQ(format, Format::Tar);
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
+
+namespace fileformat {
+namespace {
+
+class CompletenessTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    const Bytes png_magic = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    const Bytes png_iend = {0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82};
+    const Bytes jpeg_magic = {0xFF, 0xD8, 0xFF, 0xE0};
+
+    static void append(Bytes& data, const Bytes& bytes) {
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    static void append_le16(Bytes& data, size_t value) {
+        data.push_back(static_cast<uint8_t>(value));
+        data.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    static void append_le32(Bytes& data, size_t value) {
+        append_le16(data, value & 0xFFFF);
+        append_le16(data, value >> 16);
+    }
+
+    // 魔数 + size 字节填充 + 尾部
+    static Bytes make_file(const Bytes& head, size_t size, const Bytes& tail) {
+        Bytes data = head;
+        data.resize(head.size() + size, 0x11);
+        append(data, tail);
+        return data;
+    }
+
+    // 单个未压缩条目的完整 ZIP：本地文件头 + 数据 + 中央目录 + EOCD
+    static Bytes make_zip(const std::string& name, const std::string& content) {
+        Bytes data = {0x50, 0x4B, 0x03, 0x04, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00};
+        data.resize(14, 0);
+        append_le32(data, 0);
+        append_le32(data, content.size());
+        append_le32(data, content.size());
+        append_le16(data, name.size());
+        append_le16(data, 0);
+        data.insert(data.end(), name.begin(), name.end());
+        data.insert(data.end(), content.begin(), content.end());
+
+        size_t cd_offset = data.size();
+        Bytes central = {0x50, 0x4B, 0x01, 0x02};
+        central.resize(28, 0);
+        append_le16(central, name.size());
+        central.resize(46, 0);
+        central.insert(central.end(), name.begin(), name.end());
+        append(data, central);
+
+        append(data, {0x50, 0x4B, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00});
+        append_le32(data, central.size());
+        append_le32(data, cd_offset);
+        append_le16(data, 0);
+        return data;
+    }
+
+    // GZIP 成员：载荷以单个未压缩 deflate 块存放，尾部为 CRC32（此处不校验）+ ISIZE
+    static Bytes make_gzip(const std::string& payload) {
+        Bytes data = {0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0x03, 0x01};
+        append_le16(data, payload.size());
+        append_le16(data, ~payload.size() & 0xFFFF);
+        data.insert(data.end(), payload.begin(), payload.end());
+        append_le32(data, 0);
+        append_le32(data, payload.size());
+        return data;
+    }
+
+    // WAV：RIFF 大小覆盖 data_size 字节的 data 块
+    static Bytes make_wav(size_t data_size) {
+        Bytes data = {'R', 'I', 'F', 'F'};
+        append_le32(data, 4 + 8 + data_size);
+        append(data, {'W', 'A', 'V', 'E', 'd', 'a', 't', 'a'});
+        append_le32(data, data_size);
+        data.resize(data.size() + data_size, 0);
+        return data;
+    }
+
+    static Completeness check(const Bytes& data) {
+        return check_complete(data.data(), data.size()).completeness;
+    }
+
+    static Completeness check(const std::string& text) {
+        return check_complete(reinterpret_cast<const uint8_t*>(text.data()), text.size())
+            .completeness;
+    }
+
+    static CompletenessResult check_file(const Bytes& data) {
+        test::TempFile file(data);
+        auto result = check_complete(file.path());
+        EXPECT_TRUE(result.is_valid());
+        return result;
+    }
+};
+
+TEST_F(CompletenessTest, EmptyInput) {
+    auto result = check_complete(nullptr, 0);
+    EXPECT_EQ(result.format, Format::Unknown);
+    EXPECT_EQ(result.completeness, Completeness::Unchecked);
+}
+
+TEST_F(CompletenessTest, PngIendChunk) {
+    EXPECT_EQ(check(make_file(png_magic, 64, png_iend)), Completeness::Complete);
+
+    // IEND 之后的附加数据不影响判断
+    Bytes appended = make_file(png_magic, 64, png_iend);
+    appended.resize(appended.size() + 16, 0x22);
+    EXPECT_EQ(check(appended), Completeness::Complete);
+
+    EXPECT_EQ(check(make_file(png_magic, 64, {})), Completeness::Truncated);
+
+    // CRC 错误
+    Bytes bad_crc = png_iend;
+    bad_crc.back() ^= 0xFF;
+    EXPECT_EQ(check(make_file(png_magic, 64, bad_crc)), Completeness::Truncated);
+}
+
+TEST_F(CompletenessTest, JpegEndOfImage) {
+    EXPECT_EQ(check(make_file(jpeg_magic, 64, {0xFF, 0xD9})), Completeness::Complete);
+    EXPECT_EQ(check(make_file(jpeg_magic, 64, {0xFF, 0xD9, 0x00, 0x00})), Completeness::Complete);
+    EXPECT_EQ(check(make_file(jpeg_magic, 64, {})), Completeness::Truncated);
+}
+
+TEST_F(CompletenessTest, ZipEndOfCentralDirectory) {
+    Bytes zip = make_zip("a.txt", "abc");
+    EXPECT_EQ(check(zip), Completeness::Complete);
+
+    // 截断在中央目录中
+    Bytes cut(zip.begin(), zip.end() - 30);
+    EXPECT_EQ(check(cut), Completeness::Truncated);
+
+    // 中央目录范围越过 EOCD
+    Bytes bad_bounds = zip;
+    bad_bounds[bad_bounds.size() - 6] = 0x7F;
+    EXPECT_EQ(check(bad_bounds), Completeness::Truncated);
+
+    // 注释长度越过文件尾
+    Bytes bad_comment = zip;
+    bad_comment[bad_comment.size() - 2] = 0x10;
+    EXPECT_EQ(check(bad_comment), Completeness::Truncated);
+}
+
+TEST_F(CompletenessTest, PdfEofMarker) {
+    std::string pdf = "%PDF-1.7\n1 0 obj\n<< >>\nendobj\ntrailer\n<< /Root 1 0 R >>\n";
+    EXPECT_EQ(check(pdf + "startxref\n0\n%%EOF\n"), Completeness::Complete);
+    EXPECT_EQ(check(pdf), Completeness::Truncated);
+
+    // %%EOF 必须位于最后 1 KB 内
+    std::string early = pdf + "%%EOF\n" + std::string(2048, ' ');
+    EXPECT_EQ(check(early), Completeness::Truncated);
+}
+
+TEST_F(CompletenessTest, GzipTrailer) {
+    Bytes gzip = make_gzip("hello, world");
+    EXPECT_EQ(check(gzip), Completeness::Complete);
+
+    // 缺少尾部时最后 4 字节是载荷，ISIZE 远超压缩数据可能展开的大小
+    Bytes cut(gzip.begin(), gzip.end() - 8);
+    EXPECT_EQ(check(cut), Completeness::Truncated);
+}
+
+TEST_F(CompletenessTest, RiffSize) {
+    Bytes wav = make_wav(256);
+    EXPECT_EQ(check(wav), Completeness::Complete);
+
+    Bytes cut(wav.begin(), wav.end() - 100);
+    EXPECT_EQ(check(cut), Completeness::Truncated);
+
+    // 流式写入时大小字段未回填
+    Bytes streaming = cut;
+    streaming[4] = streaming[5] = streaming[6] = streaming[7] = 0xFF;
+    EXPECT_EQ(check(streaming), Completeness::Unchecked);
+}
+
+TEST_F(CompletenessTest, FormatsWithoutEndMarker) {
+    Bytes elf = {0x7F, 0x45, 0x4C, 0x46, 0x02, 0x01, 0x01, 0x00};
+    elf.resize(64, 0);
+    auto result = check_complete(elf.data(), elf.size());
+    EXPECT_EQ(result.format, Format::ELF);
+    EXPECT_EQ(result.completeness, Completeness::Unchecked);
+}
+
+TEST_F(CompletenessTest, PathReadsTailBeyondHeader) {
+    Bytes png = make_file(png_magic, kMaxHeaderSize * 4, png_iend);
+    auto result = check_file(png);
+    EXPECT_EQ(result.format, Format::PNG);
+    EXPECT_EQ(result.completeness, Completeness::Complete);
+
+    png.resize(png.size() - 4);
+    EXPECT_TRUE(check_file(png).is_truncated());
+
+    // RIFF 大小与文件大小比较，而不是与头部窗口比较
+    EXPECT_EQ(check_file(make_wav(kMaxHeaderSize * 2)).completeness, Completeness::Complete);
+
+    Bytes zip = make_zip("a.txt", std::string(kMaxHeaderSize * 2, 'x'));
+    EXPECT_EQ(check_file(zip).completeness, Completeness::Complete);
+}
+
+TEST_F(CompletenessTest, PathNotFound) {
+    auto result = check_complete("/nonexistent/path/file.png");
+    EXPECT_FALSE(result.is_valid());
+    EXPECT_EQ(result.error, std::errc::no_such_file_or_directory);
+    EXPECT_EQ(result.completeness, Completeness::Unchecked);
+}
+
+}  // namespace
+}  // namespace fileformat
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+
+namespace fileformat {
+namespace {
+
+class ContentProfileTest : public ::testing::Test {
+protected:
+    // 确定性的 xorshift 伪随机数据（近似加密数据）
+    static std::vector<uint8_t> random_bytes(size_t size) {
+        std::vector<uint8_t> data(size);
+        uint32_t state = 0x12345678;
+        for (auto& byte : data) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            byte = static_cast<uint8_t>(state >> 24);
+        }
+        return data;
+    }
+};
+
+TEST_F(ContentProfileTest, EmptyInput) {
+    auto profile = analyze_content(nullptr, 0);
+    EXPECT_EQ(profile.content_class, ContentClass::Unknown);
+    EXPECT_EQ(profile.sample_size, 0u);
+}
+
+TEST_F(ContentProfileTest, AllZeroBytes) {
+    std::vector<uint8_t> data(1024, 0);
+    auto profile = analyze_content(data.data(), data.size());
+    EXPECT_DOUBLE_EQ(profile.entropy, 0.0);
+    EXPECT_DOUBLE_EQ(profile.zero_ratio, 1.0);
+    EXPECT_DOUBLE_EQ(profile.printable_ratio, 0.0);
+    EXPECT_EQ(profile.content_class, ContentClass::Binary);
+}
+
+TEST_F(ContentProfileTest, TextContent) {
+    std::string text = "The quick brown fox jumps over the lazy dog.\n";
+    auto profile = analyze_content(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    EXPECT_DOUBLE_EQ(profile.printable_ratio, 1.0);
+    EXPECT_DOUBLE_EQ(profile.zero_ratio, 0.0);
+    EXPECT_EQ(profile.content_class, ContentClass::Text);
+}
+
+TEST_F(ContentProfileTest, RandomDataIsEncrypted) {
+    auto data = random_bytes(4096);
+    auto profile = analyze_content(data.data(), data.size());
+    EXPECT_GT(profile.entropy, 7.9);
+    EXPECT_EQ(profile.content_class, ContentClass::Encrypted);
+}
+
+TEST_F(ContentProfileTest, SkewedHighEntropyIsCompressed) {
+    // 高熵但零字节明显偏多，不符合均匀分布
+    auto data = random_bytes(4096);
+    for (size_t i = 0; i < data.size(); i += 8) {
+        data[i] = 0;
+    }
+    auto profile = analyze_content(data.data(), data.size());
+    EXPECT_GT(profile.entropy, 7.2);
+    EXPECT_GT(profile.zero_ratio, 0.12);
+    EXPECT_EQ(profile.content_class, ContentClass::Compressed);
+}
+
+TEST_F(ContentProfileTest, DetectWithProfile) {
+    std::vector<uint8_t> png = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    ContentProfile profile;
+    auto format = detect(png.data(), png.size(), profile);
+    EXPECT_EQ(format, Format::PNG);
+    EXPECT_EQ(profile.sample_size, png.size());
+    EXPECT_GT(profile.entropy, 0.0);
+}
+
+TEST_F(ContentProfileTest, DetectSafeWithProfileNonExistentFile) {
+    ContentProfile profile;
+    auto result = detect_safe("/nonexistent/file.bin", profile);
+    EXPECT_FALSE(result.is_valid());
+    EXPECT_EQ(profile.sample_size, 0u);
+}
+
+}  // namespace
+}  // namespace fileformat
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
+
+namespace fileformat {
+namespace {
+
+class DataFormatTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    // Parquet: "PAR1"
+    const Bytes parquet_magic = {0x50, 0x41, 0x52, 0x31};
+
+    // Avro: "Obj\x01"
+    const Bytes avro_magic = {0x4F, 0x62, 0x6A, 0x01, 0x04, 0x14};
+
+    // Arrow IPC 文件: "ARROW1" + 填充
+    const Bytes arrow_magic = {0x41, 0x52, 0x52, 0x4F, 0x57, 0x31, 0x00, 0x00};
+
+    // 头部 + size 字节填充 + 尾部
+    static Bytes make_file(const Bytes& head, size_t size, const Bytes& tail) {
+        Bytes data = head;
+        data.resize(head.size() + size, 0);
+        data.insert(data.end(), tail.begin(), tail.end());
+        return data;
+    }
+
+    static Bytes make_sqlite(uint16_t page_size) {
+        std::string magic = "SQLite format 3";
+        Bytes data(magic.begin(), magic.end());
+        data.resize(100, 0);
+        data[16] = static_cast<uint8_t>(page_size >> 8);
+        data[17] = static_cast<uint8_t>(page_size);
+        return data;
+    }
+
+    static Format detect_file(const Bytes& data) {
+        test::TempFile file(data);
+        return detect(file.path());
+    }
+};
+
+TEST_F(DataFormatTest, DetectByHeader) {
+    EXPECT_EQ(detect(parquet_magic.data(), parquet_magic.size()), Format::Parquet);
+    EXPECT_EQ(detect(avro_magic.data(), avro_magic.size()), Format::Avro);
+    EXPECT_EQ(detect(arrow_magic.data(), arrow_magic.size()), Format::Arrow);
+
+    Bytes orc = {0x4F, 0x52, 0x43, 0x11, 0x00, 0x00};
+    EXPECT_EQ(detect(orc.data(), orc.size()), Format::ORC);
+
+    auto sqlite = make_sqlite(4096);
+    EXPECT_EQ(detect(sqlite.data(), sqlite.size()), Format::SQLite);
+    sqlite = make_sqlite(1);  // 65536
+    EXPECT_EQ(detect(sqlite.data(), sqlite.size()), Format::SQLite);
+}
+
+TEST_F(DataFormatTest, RejectLookalikes) {
+    // 以 "ORC" 开头的普通文本
+    std::string text = "ORCHESTRA schedule\n";
+    EXPECT_NE(detect(reinterpret_cast<const uint8_t*>(text.data()), text.size()), Format::ORC);
+
+    // SQLite 页大小不是 2 的幂
+    auto sqlite = make_sqlite(1000);
+    EXPECT_NE(detect(sqlite.data(), sqlite.size()), Format::SQLite);
+}
+
+TEST_F(DataFormatTest, ConfirmFooterFromSmallFile) {
+    // 整个文件位于头部缓冲区内，直接复用已读取的数据
+    Bytes footer_length = {0x10, 0x00, 0x00, 0x00};
+    Bytes tail = footer_length;
+    tail.insert(tail.end(), parquet_magic.begin(), parquet_magic.end());
+    EXPECT_EQ(detect_file(make_file(parquet_magic, 64, tail)), Format::Parquet);
+
+    // 写入中断：缺少页脚
+    EXPECT_EQ(detect_file(make_file(parquet_magic, 64, {})), Format::Unknown);
+}
+
+TEST_F(DataFormatTest, ConfirmFooterWithTailRead) {
+    // 文件大于头部缓冲区，需要一次尾部读取
+    size_t body = kMaxHeaderSize * 2;
+
+    Bytes orc_head = {0x4F, 0x52, 0x43};
+    Bytes orc_tail = {0x82, 0xF4, 0x03, 0x03, 0x4F, 0x52, 0x43, 0x17};  // postscript 的 magic 字段
+    EXPECT_EQ(detect_file(make_file(orc_head, body, orc_tail)), Format::ORC);
+
+    Bytes arrow_tail = {0x00, 0x00, 0x00, 0x00, 0x41, 0x52, 0x52, 0x4F, 0x57, 0x31};
+    EXPECT_EQ(detect_file(make_file(arrow_magic, body, arrow_tail)), Format::Arrow);
+    EXPECT_EQ(detect_file(make_file(arrow_magic, body, {})), Format::Unknown);
+
+    // 不依赖文件尾的格式不做额外读取判定
+    EXPECT_EQ(detect_file(make_file(avro_magic, body, {})), Format::Avro);
+
+    auto result = detect_safe(::testing::TempDir() + "fileformat_missing.parquet");
+    EXPECT_FALSE(result.is_valid());
+}
+
+TEST_F(DataFormatTest, ParquetFormatInfo) {
+    auto& info = get_info(Format::Parquet);
+    EXPECT_EQ(info.name, "Parquet");
+    EXPECT_EQ(info.extension, ".parquet");
+    EXPECT_EQ(info.category, Category::Data);
+    EXPECT_EQ(get_info(Format::SQLite).mime_type, "application/vnd.sqlite3");
+}
+
+}  // namespace
+}  // namespace fileformat
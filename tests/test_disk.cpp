@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
+
+namespace fileformat {
+namespace {
+
+class DiskImageFormatTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    static constexpr size_t kSector = 2048;
+
+    // 卷识别序列：从第 16 扇区起依次写入描述符标识
+    static Bytes make_volume(const std::vector<std::string>& identifiers) {
+        Bytes data((16 + identifiers.size() + 1) * kSector, 0);
+        for (size_t i = 0; i < identifiers.size(); ++i) {
+            size_t offset = (16 + i) * kSector + 1;
+            std::copy(identifiers[i].begin(), identifiers[i].end(), data.begin() + offset);
+        }
+        return data;
+    }
+
+    // 固定大小 VHD：数据区 + 512 字节 footer
+    static Bytes make_fixed_vhd(size_t data_size) {
+        Bytes data(data_size + 512, 0);
+        std::string cookie = "conectix";
+        std::copy(cookie.begin(), cookie.end(), data.begin() + data_size);
+        return data;
+    }
+
+    static Format detect_file(const Bytes& data) {
+        test::TempFile file(data);
+        auto result = detect_safe(file.path());
+        EXPECT_TRUE(result.is_valid());
+        return result.format;
+    }
+};
+
+TEST_F(DiskImageFormatTest, DetectByHeader) {
+    Bytes qcow2 = {0x51, 0x46, 0x49, 0xFB, 0x00, 0x00, 0x00, 0x03};
+    EXPECT_EQ(detect(qcow2.data(), qcow2.size()), Format::QCOW2);
+
+    Bytes vhdx = {'v', 'h', 'd', 'x', 'f', 'i', 'l', 'e', 0x00, 0x00};
+    EXPECT_EQ(detect(vhdx.data(), vhdx.size()), Format::VHDX);
+
+    Bytes vmdk = {'K', 'D', 'M', 'V', 0x01, 0x00, 0x00, 0x00};
+    EXPECT_EQ(detect(vmdk.data(), vmdk.size()), Format::VMDK);
+
+    std::string descriptor = "# Disk DescriptorFile\nversion=1\nCID=fffffffe\n";
+    EXPECT_EQ(detect(reinterpret_cast<const uint8_t*>(descriptor.data()), descriptor.size()),
+              Format::VMDK);
+
+    // 动态 VHD 在开头保存 footer 副本
+    Bytes dynamic_vhd = make_fixed_vhd(0);
+    EXPECT_EQ(detect(dynamic_vhd.data(), dynamic_vhd.size()), Format::VHD);
+
+    // 不支持的 qcow 版本
+    qcow2[7] = 0x01;
+    EXPECT_NE(detect(qcow2.data(), qcow2.size()), Format::QCOW2);
+}
+
+TEST_F(DiskImageFormatTest, DetectIso9660AtFarOffset) {
+    auto iso = make_volume({"CD001", "CD001"});
+    // 头部缓冲区只包含系统区（全零），内存检测无法识别
+    EXPECT_EQ(detect(iso.data(), kMaxHeaderSize), Format::Unknown);
+    EXPECT_EQ(detect_file(iso), Format::ISO9660);
+
+    // ISO/UDF 桥接格式按 ISO 9660 报告
+    auto bridge = make_volume({"CD001", "CD001", "BEA01", "NSR02", "TEA01"});
+    EXPECT_EQ(detect_file(bridge), Format::ISO9660);
+}
+
+TEST_F(DiskImageFormatTest, DetectUdfVolumeRecognitionSequence) {
+    auto udf = make_volume({"BEA01", "NSR03", "TEA01"});
+    EXPECT_EQ(detect_file(udf), Format::UDF);
+
+    // 只有扩展区开始标记，没有 NSR 描述符
+    auto incomplete = make_volume({"BEA01", "TEA01"});
+    EXPECT_EQ(detect_file(incomplete), Format::Unknown);
+}
+
+TEST_F(DiskImageFormatTest, DetectFixedVhdByFooter) {
+    // 文件大于头部缓冲区：尾部定位读取
+    EXPECT_EQ(detect_file(make_fixed_vhd(64 * 1024)), Format::VHD);
+
+    // 文件完整位于头部缓冲区：复用已读数据
+    EXPECT_EQ(detect_file(make_fixed_vhd(1024)), Format::VHD);
+
+    // 早期 Virtual PC 的 511 字节 footer
+    auto legacy = make_fixed_vhd(64 * 1024);
+    legacy.pop_back();
+    EXPECT_EQ(detect_file(legacy), Format::VHD);
+
+    Bytes plain(64 * 1024, 0);
+    EXPECT_EQ(detect_file(plain), Format::Unknown);
+}
+
+TEST_F(DiskImageFormatTest, DiskImageFormatInfo) {
+    auto& info = get_info(Format::ISO9660);
+    EXPECT_EQ(info.name, "ISO");
+    EXPECT_EQ(info.extension, ".iso");
+    EXPECT_EQ(info.category, Category::DiskImage);
+    EXPECT_EQ(get_info(Format::QCOW2).extension, ".qcow2");
+}
+
+}  // namespace
+}  // namespace fileformat
@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
 
 namespace fileformat {
 namespace {
@@ -15,6 +17,45 @@ protected:
 
     // OLE Compound Document (DOC, XLS, PPT)
     const std::vector<uint8_t> ole_magic = {0xD0, 0xCF, 0x11, 0xE0, 0xA1, 0xB1, 0x1A, 0xE1};
+
+    // 写入临时文件后以 detect_safe(path) 检测
+    static DetectResult detect_file(const std::string& data) {
+        test::TempFile file(data);
+        auto result = detect_safe(file.path());
+        EXPECT_TRUE(result.is_valid());
+        return result;
+    }
+
+    // OLE 复合文档：512 字节扇区，目录位于扇区 0（文件偏移 512），第一个条目名为 name
+    std::string make_ole(const std::u16string& name) const {
+        std::string data(ole_magic.begin(), ole_magic.end());
+        data.resize(1024, '\0');
+        data[0x1E] = 9;     // 扇区大小 2^9
+        data[0x30] = 0;     // 第一个目录扇区
+        size_t entry = 512 + 128;  // 第二个目录条目（第一个为 Root Entry）
+        for (size_t i = 0; i < name.size(); ++i) {
+            data[entry + i * 2] = static_cast<char>(name[i]);
+        }
+        data[entry + 0x40] = static_cast<char>((name.size() + 1) * 2);
+        return data;
+    }
+
+    // 目录跨两个扇区：扇区 0 -> 扇区 1，FAT 位于扇区 2，name 为扇区 1 的第一个条目
+    std::string make_chained_ole(const std::u16string& name) const {
+        std::string data(ole_magic.begin(), ole_magic.end());
+        data.resize(512 * 4, '\0');
+        data[0x1E] = 9;
+        data[0x30] = 0;
+        data[0x4C] = 2;  // DIFAT[0]：FAT 扇区号
+        std::string fat = {1, 0, 0, 0, '\xFE', '\xFF', '\xFF', '\xFF'};  // 0 -> 1 -> ENDOFCHAIN
+        data.replace(512 * 3, fat.size(), fat);
+        size_t entry = 512 * 2;
+        for (size_t i = 0; i < name.size(); ++i) {
+            data[entry + i * 2] = static_cast<char>(name[i]);
+        }
+        data[entry + 0x40] = static_cast<char>((name.size() + 1) * 2);
+        return data;
+    }
 };
 
 TEST_F(DocumentFormatTest, DetectPdf) {
@@ -28,6 +69,89 @@ TEST_F(DocumentFormatTest, DetectOleDocument) {
     EXPECT_EQ(format, Format::DOC);
 }
 
+TEST_F(DocumentFormatTest, ProbeLinearizedPdf) {
+    std::string head = "%PDF-1.7\n%\xE2\xE3\xCF\xD3\n"
+                       "1 0 obj\n<< /Linearized 1 /L ";
+    std::string tail = " /H [ 720 180 ] /O 4 /E 4096 /N 1 /T 2048 >>\nendobj\n";
+
+    // /L 与文件长度一致
+    std::string pdf = head + "0000" + tail;
+    pdf.resize(4000, ' ');
+    std::string length = std::to_string(pdf.size());
+    pdf.replace(head.size(), 4, length);
+    auto layout = probe_layout(reinterpret_cast<const uint8_t*>(pdf.data()), pdf.size());
+    EXPECT_EQ(layout.format, Format::PDF);
+    EXPECT_TRUE(layout.known);
+    EXPECT_TRUE(layout.linearized);
+
+    // 增量更新后文件变长，线性化失效
+    pdf.append("\n% appended update\n");
+    layout = probe_layout(reinterpret_cast<const uint8_t*>(pdf.data()), pdf.size());
+    EXPECT_TRUE(layout.known);
+    EXPECT_FALSE(layout.linearized);
+
+    // 普通 PDF
+    layout = probe_layout(pdf_magic.data(), pdf_magic.size());
+    EXPECT_TRUE(layout.known);
+    EXPECT_FALSE(layout.linearized);
+}
+
+TEST_F(DocumentFormatTest, DetectEncryptedPdf) {
+    std::string body = "%PDF-1.7\n1 0 obj\n<< /Type /Catalog >>\nendobj\n";
+    body.resize(8192, ' ');
+    std::string plain = body + "trailer\n<< /Size 3 /Root 1 0 R >>\nstartxref\n0\n%%EOF\n";
+    std::string encrypted =
+        body + "trailer\n<< /Size 3 /Root 1 0 R /Encrypt 2 0 R >>\nstartxref\n0\n%%EOF\n";
+
+    auto data = reinterpret_cast<const uint8_t*>(encrypted.data());
+    EXPECT_TRUE(is_encrypted(data, encrypted.size()));
+    EXPECT_FALSE(is_encrypted(reinterpret_cast<const uint8_t*>(plain.data()), plain.size()));
+
+    // 通过路径检测时 trailer 位于头部窗口之外，以定位读取获得
+    auto result = detect_file(encrypted);
+    EXPECT_EQ(result.format, Format::PDF);
+    EXPECT_TRUE(result.encrypted);
+    EXPECT_FALSE(detect_file(plain).encrypted);
+
+    // 交叉引用流的字典不在文件尾时按 startxref 读取
+    std::string xref_stream = body;
+    size_t xref_offset = xref_stream.size();
+    xref_stream += "5 0 obj\n<< /Type /XRef /Encrypt 2 0 R >>\nstream\nendstream\nendobj\n";
+    xref_stream.resize(xref_stream.size() + 2048, ' ');
+    xref_stream += "startxref\n" + std::to_string(xref_offset) + "\n%%EOF\n";
+    EXPECT_TRUE(detect_file(xref_stream).encrypted);
+}
+
+TEST_F(DocumentFormatTest, DetectEncryptedOoxmlInOle) {
+    std::string encrypted = make_ole(u"EncryptedPackage");
+    auto data = reinterpret_cast<const uint8_t*>(encrypted.data());
+    EXPECT_TRUE(is_encrypted(data, encrypted.size()));
+
+    // 容器格式仍报告为 OLE 文档
+    auto result = detect_file(encrypted);
+    EXPECT_EQ(result.format, Format::DOC);
+    EXPECT_TRUE(result.encrypted);
+
+    std::string plain = make_ole(u"WordDocument");
+    EXPECT_FALSE(is_encrypted(reinterpret_cast<const uint8_t*>(plain.data()), plain.size()));
+    EXPECT_FALSE(detect_file(plain).encrypted);
+}
+
+TEST_F(DocumentFormatTest, DetectEncryptedPackageBeyondFirstDirSector) {
+    std::string encrypted = make_chained_ole(u"EncryptedPackage");
+    EXPECT_TRUE(is_encrypted(reinterpret_cast<const uint8_t*>(encrypted.data()), encrypted.size()));
+    EXPECT_TRUE(detect_file(encrypted).encrypted);
+
+    std::string plain = make_chained_ole(u"WordDocument");
+    EXPECT_FALSE(is_encrypted(reinterpret_cast<const uint8_t*>(plain.data()), plain.size()));
+
+    // FAT 形成环（扇区 1 指回扇区 0）时在有限步内结束
+    std::string cyclic = plain;
+    cyclic[512 * 3 + 4] = 0;
+    cyclic[512 * 3 + 5] = cyclic[512 * 3 + 6] = cyclic[512 * 3 + 7] = 0;
+    EXPECT_FALSE(is_encrypted(reinterpret_cast<const uint8_t*>(cyclic.data()), cyclic.size()));
+}
+
 TEST_F(DocumentFormatTest, PdfFormatInfo) {
     auto& info = get_info(Format::PDF);
     EXPECT_EQ(info.format, Format::PDF);
@@ -49,6 +49,15 @@ TEST_F(EbookFormatTest, DetectMobi) {
     EXPECT_EQ(format, Format::MOBI);
 }
 
+TEST_F(EbookFormatTest, DetectAzw3) {
+    std::vector<uint8_t> data = mobi_magic;
+    data.resize(256, 0);
+    data[200] = 'K';
+    data[201] = 'F';
+    data[202] = '8';
+    EXPECT_EQ(detect(data.data(), data.size()), Format::AZW3);
+}
+
 TEST_F(EbookFormatTest, DetectFb2) {
     auto format = detect(fb2_magic.data(), fb2_magic.size());
     EXPECT_EQ(format, Format::FB2);
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+
+namespace fileformat {
+namespace {
+
+class EncodedInputTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    const Bytes png_magic = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A,
+                             0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52};
+    const Bytes zip_magic = {0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00};
+
+    // 标准 Base64，每 line_length 个字符插入 CRLF（0 表示不换行）
+    static std::string base64(const Bytes& data, size_t line_length = 0) {
+        static const char kAlphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string encoded;
+        for (size_t i = 0; i < data.size(); i += 3) {
+            uint32_t value = static_cast<uint32_t>(data[i]) << 16;
+            if (i + 1 < data.size()) {
+                value |= static_cast<uint32_t>(data[i + 1]) << 8;
+            }
+            if (i + 2 < data.size()) {
+                value |= data[i + 2];
+            }
+            encoded += kAlphabet[(value >> 18) & 0x3F];
+            encoded += kAlphabet[(value >> 12) & 0x3F];
+            encoded += i + 1 < data.size() ? kAlphabet[(value >> 6) & 0x3F] : '=';
+            encoded += i + 2 < data.size() ? kAlphabet[value & 0x3F] : '=';
+        }
+        if (line_length == 0) {
+            return encoded;
+        }
+        std::string wrapped;
+        for (size_t i = 0; i < encoded.size(); i += line_length) {
+            wrapped += encoded.substr(i, line_length) + "\r\n";
+        }
+        return wrapped;
+    }
+
+    static Format detect_text(const std::string& text, TransferEncoding encoding) {
+        return detect_encoded(reinterpret_cast<const uint8_t*>(text.data()), text.size(), encoding);
+    }
+};
+
+TEST_F(EncodedInputTest, EmptyInput) {
+    EXPECT_EQ(detect_encoded(nullptr, 0, TransferEncoding::Base64), Format::Unknown);
+    EXPECT_EQ(detect_text("", TransferEncoding::QuotedPrintable), Format::Unknown);
+}
+
+TEST_F(EncodedInputTest, Base64WithLineBreaks) {
+    EXPECT_EQ(detect_text(base64(png_magic), TransferEncoding::Base64), Format::PNG);
+    EXPECT_EQ(detect_text(base64(png_magic, 76), TransferEncoding::Base64), Format::PNG);
+
+    // 行长不是 4 的倍数时换行落在一组字符中间
+    EXPECT_EQ(detect_text(base64(png_magic, 5), TransferEncoding::Base64), Format::PNG);
+
+    // 邮件正文中的缩进
+    EXPECT_EQ(detect_text("  \t" + base64(zip_magic), TransferEncoding::Base64), Format::ZIP);
+}
+
+TEST_F(EncodedInputTest, Base64UrlSafeAlphabet) {
+    // 0xFB 0xFF 在标准字母表中编码为 "+/"，URL 安全字母表为 "-_"
+    Bytes data = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0xFB, 0xFF};
+    std::string encoded = base64(data);
+    for (char& c : encoded) {
+        c = c == '+' ? '-' : c == '/' ? '_' : c;
+    }
+    EXPECT_EQ(detect_text(encoded, TransferEncoding::Base64), Format::PNG);
+}
+
+TEST_F(EncodedInputTest, Base64DataUri) {
+    std::string uri = "data:image/png;base64," + base64(png_magic);
+    EXPECT_EQ(detect_text(uri, TransferEncoding::Base64), Format::PNG);
+}
+
+TEST_F(EncodedInputTest, LargeBase64PayloadDecodesOnlyPrefix) {
+    // 数 MB 的附件：只解码头部窗口
+    Bytes pdf = {'%', 'P', 'D', 'F', '-', '1', '.', '7', '\n'};
+    pdf.resize(3 * 1024 * 1024, 'A');
+    std::string encoded = base64(pdf, 76);
+    EXPECT_EQ(detect_text(encoded, TransferEncoding::Base64), Format::PDF);
+}
+
+TEST_F(EncodedInputTest, Base64StopsAtInvalidCharacter) {
+    EXPECT_EQ(detect_text("!!" + base64(png_magic), TransferEncoding::Base64), Format::Unknown);
+}
+
+TEST_F(EncodedInputTest, QuotedPrintable) {
+    // PDF 头：非 ASCII 的注释行以 =XX 转义，长行以软换行折断
+    std::string qp = "%PDF-1.7\r\n%=E2=E3=CF=D3\r\n1 0 obj\r\n<< /Type /Cat=\r\nalog >>\r\n";
+    EXPECT_EQ(detect_text(qp, TransferEncoding::QuotedPrintable), Format::PDF);
+
+    // PNG 签名完全由转义字节构成
+    std::string png = "=89PNG=0D=0A=1A=0A=00=00=00=0DIHDR";
+    EXPECT_EQ(detect_text(png, TransferEncoding::QuotedPrintable), Format::PNG);
+
+    // 小写十六进制与软换行分隔的转义
+    std::string split = "=89P=\nNG=0d=0a=1a=0a";
+    EXPECT_EQ(detect_text(split, TransferEncoding::QuotedPrintable), Format::PNG);
+}
+
+}  // namespace
+}  // namespace fileformat
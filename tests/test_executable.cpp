@@ -1,17 +1,20 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
 
 namespace fileformat {
 namespace {
 
 class ExecutableFormatTest : public ::testing::Test {
 protected:
-    // Windows PE: MZ
-    const std::vector<uint8_t> exe_magic = {0x4D, 0x5A};
+    // Windows PE: MZ + e_lfanew (0x40) 指向 "PE\0\0"
+    std::vector<uint8_t> exe_magic;
 
     // ELF: \x7FELF
     const std::vector<uint8_t> elf_magic = {0x7F, 0x45, 0x4C, 0x46};
@@ -21,6 +24,56 @@ protected:
 
     // Mach-O Fat binary
     const std::vector<uint8_t> macho_fat_magic = {0xCA, 0xFE, 0xBA, 0xBE};
+
+    void SetUp() override {
+        exe_magic.resize(0x48, 0);
+        exe_magic[0] = 'M';
+        exe_magic[1] = 'Z';
+        exe_magic[0x3C] = 0x40;  // e_lfanew
+        exe_magic[0x40] = 'P';
+        exe_magic[0x41] = 'E';
+    }
+
+    static void put16(std::vector<uint8_t>& data, size_t offset, uint16_t value, bool big_endian) {
+        data[offset + (big_endian ? 1 : 0)] = static_cast<uint8_t>(value);
+        data[offset + (big_endian ? 0 : 1)] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static void put32(std::vector<uint8_t>& data, size_t offset, uint32_t value, bool big_endian) {
+        put16(data, offset + (big_endian ? 2 : 0), static_cast<uint16_t>(value), big_endian);
+        put16(data, offset + (big_endian ? 0 : 2), static_cast<uint16_t>(value >> 16), big_endian);
+    }
+
+    // ELF64 小端头，程序头表紧随其后（第二项类型为 interp_type）
+    static std::vector<uint8_t> make_elf64(uint16_t type, uint16_t machine, uint32_t interp_type) {
+        std::vector<uint8_t> data(64 + 2 * 56, 0);
+        data[0] = 0x7F;
+        data[1] = 'E';
+        data[2] = 'L';
+        data[3] = 'F';
+        data[4] = 2;  // ELFCLASS64
+        data[5] = 1;  // ELFDATA2LSB
+        data[6] = 1;
+        put16(data, 16, type, false);
+        put16(data, 18, machine, false);
+        data[32] = 64;              // e_phoff
+        put16(data, 54, 56, false);  // e_phentsize
+        put16(data, 56, 2, false);   // e_phnum
+        put32(data, 64, 6, false);   // PT_PHDR
+        put32(data, 64 + 56, interp_type, false);
+        return data;
+    }
+
+    // PE：COFF Machine/Characteristics 与可选头 magic
+    std::vector<uint8_t> make_pe(uint16_t machine, uint16_t characteristics, uint16_t magic) const {
+        std::vector<uint8_t> data = exe_magic;
+        data.resize(0x44 + 20 + 240, 0);
+        put16(data, 0x44, machine, false);
+        put16(data, 0x44 + 16, 240, false);
+        put16(data, 0x44 + 18, characteristics, false);
+        put16(data, 0x44 + 20, magic, false);
+        return data;
+    }
 };
 
 TEST_F(ExecutableFormatTest, DetectExe) {
@@ -28,6 +81,136 @@ TEST_F(ExecutableFormatTest, DetectExe) {
     EXPECT_EQ(format, Format::EXE);
 }
 
+TEST_F(ExecutableFormatTest, RejectMzWithoutPeSignature) {
+    // e_lfanew 指向的位置不是 PE 签名
+    std::vector<uint8_t> data = exe_magic;
+    data[0x40] = 'X';
+    EXPECT_EQ(detect(data.data(), data.size()), Format::Unknown);
+
+    // e_lfanew 超出缓冲区
+    data = exe_magic;
+    data[0x3D] = 0x10;
+    EXPECT_EQ(detect(data.data(), data.size()), Format::Unknown);
+
+    // 仅有 "MZ" 两字节（可能被识别为文本，但不应是 EXE）
+    std::vector<uint8_t> short_data = {0x4D, 0x5A};
+    EXPECT_NE(detect(short_data.data(), short_data.size()), Format::EXE);
+}
+
+TEST_F(ExecutableFormatTest, ProbeElf) {
+    // PIE：ET_DYN 且有 PT_INTERP
+    auto pie = make_elf64(3, 62, 3);
+    auto info = probe_executable(pie.data(), pie.size());
+    EXPECT_EQ(info.format, Format::ELF);
+    EXPECT_EQ(info.architecture, Architecture::X86_64);
+    EXPECT_EQ(info.machine, 62u);
+    EXPECT_EQ(info.bits, 64);
+    EXPECT_FALSE(info.big_endian);
+    EXPECT_EQ(info.kind, BinaryKind::Executable);
+
+    auto shared = make_elf64(3, 183, 1);
+    info = probe_executable(shared.data(), shared.size());
+    EXPECT_EQ(info.architecture, Architecture::ARM64);
+    EXPECT_EQ(info.kind, BinaryKind::SharedLibrary);
+
+    auto object = make_elf64(1, 243, 0);
+    info = probe_executable(object.data(), object.size());
+    EXPECT_EQ(info.architecture, Architecture::RISCV);
+    EXPECT_EQ(info.kind, BinaryKind::Object);
+
+    // ELF32 大端 PowerPC 可执行文件
+    std::vector<uint8_t> ppc(52, 0);
+    std::copy(elf_magic.begin(), elf_magic.end(), ppc.begin());
+    ppc[4] = 1;
+    ppc[5] = 2;
+    put16(ppc, 16, 2, true);
+    put16(ppc, 18, 20, true);
+    info = probe_executable(ppc.data(), ppc.size());
+    EXPECT_EQ(info.architecture, Architecture::PowerPC);
+    EXPECT_EQ(info.bits, 32);
+    EXPECT_TRUE(info.big_endian);
+    EXPECT_EQ(info.kind, BinaryKind::Executable);
+
+    // 只有 magic 时只报告格式
+    info = probe_executable(elf_magic.data(), elf_magic.size());
+    EXPECT_EQ(info.format, Format::ELF);
+    EXPECT_FALSE(info.has_architecture());
+}
+
+TEST_F(ExecutableFormatTest, ProbePe) {
+    auto dll = make_pe(0x8664, 0x2022, 0x20B);
+    auto info = probe_executable(dll.data(), dll.size());
+    EXPECT_EQ(info.format, Format::EXE);
+    EXPECT_EQ(info.architecture, Architecture::X86_64);
+    EXPECT_EQ(info.bits, 64);
+    EXPECT_EQ(info.kind, BinaryKind::SharedLibrary);
+
+    auto exe = make_pe(0x014C, 0x0102, 0x10B);
+    info = probe_executable(exe.data(), exe.size());
+    EXPECT_EQ(info.architecture, Architecture::X86);
+    EXPECT_EQ(info.bits, 32);
+    EXPECT_EQ(info.kind, BinaryKind::Executable);
+
+    // 既不是 DLL 也没有 EXECUTABLE_IMAGE 位：类型未知，而不是目标文件
+    auto unlinked = make_pe(0x014C, 0x0100, 0x10B);
+    info = probe_executable(unlinked.data(), unlinked.size());
+    EXPECT_EQ(info.architecture, Architecture::X86);
+    EXPECT_EQ(info.kind, BinaryKind::Unknown);
+
+    test::TempFile file(dll);
+    ExecutableInfo from_file;
+    auto result = detect_safe(file.path(), from_file);
+    EXPECT_EQ(result.format, Format::EXE);
+    EXPECT_EQ(from_file.architecture, Architecture::X86_64);
+    EXPECT_EQ(from_file.kind, BinaryKind::SharedLibrary);
+}
+
+TEST_F(ExecutableFormatTest, ProbeMachO) {
+    // 小端 arm64 可执行文件（MH_MAGIC_64 按小端存储为 CF FA ED FE）
+    std::vector<uint8_t> thin(32, 0);
+    put32(thin, 0, 0xFEEDFACF, false);
+    put32(thin, 4, 0x0100000C, false);
+    put32(thin, 12, 2, false);
+    auto info = probe_executable(thin.data(), thin.size());
+    EXPECT_EQ(info.format, Format::MachO);
+    EXPECT_EQ(info.architecture, Architecture::ARM64);
+    EXPECT_EQ(info.bits, 64);
+    EXPECT_FALSE(info.big_endian);
+    EXPECT_EQ(info.kind, BinaryKind::Executable);
+
+    // 通用二进制：x86_64 + arm64 两个切片
+    std::vector<uint8_t> fat(8 + 2 * 20, 0);
+    put32(fat, 0, 0xCAFEBABE, true);
+    put32(fat, 4, 2, true);
+    put32(fat, 8, 0x01000007, true);
+    put32(fat, 28, 0x0100000C, true);
+    info = probe_executable(fat.data(), fat.size());
+    EXPECT_TRUE(info.fat);
+    EXPECT_EQ(info.slice_count, 2);
+    EXPECT_EQ(info.slices[0], Architecture::X86_64);
+    EXPECT_EQ(info.slices[1], Architecture::ARM64);
+    EXPECT_TRUE(info.has_architecture());
+
+    // 64 位通用二进制（FAT_MAGIC_64）：fat_arch_64 条目为 32 字节
+    std::vector<uint8_t> fat64(8 + 2 * 32, 0);
+    put32(fat64, 0, 0xCAFEBABF, true);
+    put32(fat64, 4, 2, true);
+    put32(fat64, 8, 0x01000007, true);
+    put32(fat64, 40, 0x0100000C, true);
+    EXPECT_EQ(detect(fat64.data(), fat64.size()), Format::MachO);
+    info = probe_executable(fat64.data(), fat64.size());
+    EXPECT_TRUE(info.fat);
+    EXPECT_EQ(info.slice_count, 2);
+    EXPECT_EQ(info.slices[0], Architecture::X86_64);
+    EXPECT_EQ(info.slices[1], Architecture::ARM64);
+
+    // Java class 文件：主版本号落在 nfat_arch 位置，不视为通用二进制
+    std::vector<uint8_t> java = {0xCA, 0xFE, 0xBA, 0xBE, 0x00, 0x00, 0x00, 0x34};
+    info = probe_executable(java.data(), java.size());
+    EXPECT_FALSE(info.fat);
+    EXPECT_EQ(info.slice_count, 0);
+}
+
 TEST_F(ExecutableFormatTest, DetectElf) {
     auto format = detect(elf_magic.data(), elf_magic.size());
     EXPECT_EQ(format, Format::ELF);
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#if !defined(_WIN32)
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
+
+namespace fileformat {
+namespace {
+
+class DescriptorTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    const Bytes png_magic = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A,
+                             0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52};
+
+    void SetUp() override {
+        dirfd_ = ::open(::testing::TempDir().c_str(), O_RDONLY | O_DIRECTORY);
+        ASSERT_GE(dirfd_, 0);
+    }
+
+    void TearDown() override {
+        if (dirfd_ >= 0) {
+            ::close(dirfd_);
+        }
+    }
+
+    int dirfd_ = -1;
+};
+
+TEST_F(DescriptorTest, DetectFdKeepsFilePosition) {
+    test::TempFile file(png_magic);
+    int fd = ::open(file.path().c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(::lseek(fd, 5, SEEK_SET), 5);
+
+    auto result = detect_fd(fd);
+    EXPECT_TRUE(result.is_valid());
+    EXPECT_EQ(result.format, Format::PNG);
+    EXPECT_EQ(::lseek(fd, 0, SEEK_CUR), 5);
+    ::close(fd);
+}
+
+TEST_F(DescriptorTest, MatchesPathDetectionBeyondHeader) {
+    // 依赖文件尾的格式与 PDF trailer 中的加密字典
+    Bytes parquet(64 * 1024, 0);
+    std::copy_n("PAR1", 4, parquet.begin());
+    std::copy_n("PAR1", 4, parquet.end() - 4);
+    test::TempFile parquet_file(parquet);
+
+    std::string pdf = "%PDF-1.7\n" + std::string(8192, ' ') +
+                      "trailer\n<< /Size 3 /Root 1 0 R /Encrypt 2 0 R >>\nstartxref\n0\n%%EOF\n";
+    test::TempFile pdf_file(pdf);
+
+    for (const test::TempFile* file : {&parquet_file, &pdf_file}) {
+        int fd = ::open(file->path().c_str(), O_RDONLY);
+        ASSERT_GE(fd, 0);
+        auto by_fd = detect_fd(fd);
+        auto by_path = detect_safe(file->path());
+        EXPECT_EQ(by_fd.format, by_path.format);
+        EXPECT_EQ(by_fd.encrypted, by_path.encrypted);
+        EXPECT_EQ(by_fd.error, by_path.error);
+        ::close(fd);
+    }
+    EXPECT_EQ(detect_at(dirfd_, parquet_file.name().c_str()).format, Format::Parquet);
+    EXPECT_TRUE(detect_at(dirfd_, pdf_file.name().c_str()).encrypted);
+}
+
+TEST_F(DescriptorTest, DetectAtRelativeToDirectory) {
+    test::TempFile png(png_magic);
+    auto result = detect_at(dirfd_, png.name().c_str());
+    EXPECT_TRUE(result.is_valid());
+    EXPECT_EQ(result.format, Format::PNG);
+
+    test::TempFile empty(Bytes{});
+    auto empty_result = detect_at(dirfd_, empty.name().c_str());
+    EXPECT_TRUE(empty_result.is_valid());
+    EXPECT_EQ(empty_result.format, Format::Unknown);
+}
+
+TEST_F(DescriptorTest, Errors) {
+    EXPECT_EQ(detect_fd(-1).error, std::errc::bad_file_descriptor);
+    EXPECT_EQ(detect_at(dirfd_, "fileformat_missing.bin").error,
+              std::errc::no_such_file_or_directory);
+    EXPECT_EQ(detect_at(dirfd_, "").error, std::errc::invalid_argument);
+    EXPECT_EQ(detect_at(dirfd_, nullptr).error, std::errc::invalid_argument);
+    EXPECT_EQ(detect_at(dirfd_, ".").error, std::errc::is_a_directory);
+}
+
+}  // namespace
+}  // namespace fileformat
+
+#endif  // !defined(_WIN32)
@@ -2,9 +2,11 @@
 
 #include <array>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
 
 namespace fileformat {
 namespace {
@@ -17,8 +19,10 @@ protected:
     // JPEG: FF D8 FF
     const std::vector<uint8_t> jpeg_magic = {0xFF, 0xD8, 0xFF, 0xE0};
 
-    // BMP: BM
-    const std::vector<uint8_t> bmp_magic = {0x42, 0x4D, 0x00, 0x00};
+    // BMP: BM + BITMAPFILEHEADER + DIB 头大小 40 (BITMAPINFOHEADER)
+    const std::vector<uint8_t> bmp_magic = {0x42, 0x4D, 0x46, 0x00, 0x00, 0x00,
+                                             0x00, 0x00, 0x00, 0x00, 0x36, 0x00,
+                                             0x00, 0x00, 0x28, 0x00, 0x00, 0x00};
 
     // GIF89a
     const std::vector<uint8_t> gif_magic = {0x47, 0x49, 0x46, 0x38, 0x39, 0x61};
@@ -35,6 +39,73 @@ protected:
 
     // TIFF (big-endian): MM\0*
     const std::vector<uint8_t> tiff_be_magic = {0x4D, 0x4D, 0x00, 0x2A};
+
+    // JPEG：SOI + 指定长度的 APP1 段 + SOF0（640x480，8 位，3 分量）
+    static std::vector<uint8_t> make_jpeg(size_t app1_payload) {
+        std::vector<uint8_t> data = {0xFF, 0xD8, 0xFF, 0xE1};
+        size_t length = app1_payload + 2;
+        data.push_back(static_cast<uint8_t>(length >> 8));
+        data.push_back(static_cast<uint8_t>(length));
+        data.resize(data.size() + app1_payload, 0);
+        const uint8_t sof0[] = {0xFF, 0xC0, 0x00, 0x11, 0x08, 0x01, 0xE0, 0x02, 0x80, 0x03};
+        data.insert(data.end(), sof0, sof0 + sizeof(sof0));
+        data.resize(data.size() + 64, 0);
+        return data;
+    }
+
+    // IFD0 中除 Make 之外的标签
+    enum class RawTag { None, DngVersion, CfaSubIfd, Sr2Private };
+
+    // 小端 TIFF：IFD0 含 Make（ASCII，值位于文件末尾）及可选的 RAW 标签：
+    // DNGVersion（4 个 BYTE，内联）、SubIFDs（指向 Photometric 为 CFA 的子 IFD）或 SR2Private
+    static std::vector<uint8_t> make_tiff_ifd0(const std::string& make, RawTag raw) {
+        uint16_t count = raw == RawTag::None ? 1 : 2;
+        size_t subifd_offset = 8 + 2 + count * 12 + 4;
+        size_t value_offset = subifd_offset + (raw == RawTag::CfaSubIfd ? 2 + 12 + 4 : 0);
+        auto le16 = [](uint16_t v) {
+            return std::array<uint8_t, 2>{static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8)};
+        };
+        auto le32 = [](size_t v) {
+            return std::array<uint8_t, 4>{static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8),
+                                          static_cast<uint8_t>(v >> 16),
+                                          static_cast<uint8_t>(v >> 24)};
+        };
+        std::vector<uint8_t> data = {0x49, 0x49, 0x2A, 0x00, 0x08, 0x00, 0x00, 0x00};
+        auto append = [&data](const auto& bytes) { data.insert(data.end(), bytes.begin(), bytes.end()); };
+        append(le16(count));
+        append(le16(271));
+        append(le16(2));
+        append(le32(make.size() + 1));
+        append(le32(value_offset));
+        if (raw == RawTag::CfaSubIfd) {
+            append(le16(330));
+            append(le16(4));
+            append(le32(1));
+            append(le32(subifd_offset));
+        } else if (raw == RawTag::DngVersion) {
+            append(le16(50706));
+            append(le16(1));
+            append(le32(4));
+            append(std::array<uint8_t, 4>{1, 4, 0, 0});
+        } else if (raw == RawTag::Sr2Private) {
+            append(le16(50740));
+            append(le16(4));
+            append(le32(1));
+            append(le32(0));
+        }
+        append(le32(0));  // 下一个 IFD
+        if (raw == RawTag::CfaSubIfd) {
+            append(le16(1));
+            append(le16(262));  // PhotometricInterpretation = CFA
+            append(le16(3));
+            append(le32(1));
+            append(le32(32803));
+            append(le32(0));
+        }
+        data.insert(data.end(), make.begin(), make.end());
+        data.push_back(0);
+        return data;
+    }
 };
 
 TEST_F(ImageFormatTest, DetectPng) {
@@ -52,6 +123,17 @@ TEST_F(ImageFormatTest, DetectBmp) {
     EXPECT_EQ(format, Format::BMP);
 }
 
+TEST_F(ImageFormatTest, RejectBmpWithInvalidDibHeaderSize) {
+    // 以 "BM" 开头的文本，DIB 头大小字段不合法
+    std::vector<uint8_t> data = bmp_magic;
+    data[14] = 0x33;
+    EXPECT_EQ(detect(data.data(), data.size()), Format::Unknown);
+
+    // 仅有 "BM" 两字节不足以确认
+    std::vector<uint8_t> short_data = {0x42, 0x4D, 0x00, 0x00};
+    EXPECT_EQ(detect(short_data.data(), short_data.size()), Format::Unknown);
+}
+
 TEST_F(ImageFormatTest, DetectGif89a) {
     auto format = detect(gif_magic.data(), gif_magic.size());
     EXPECT_EQ(format, Format::GIF);
@@ -77,6 +159,198 @@ TEST_F(ImageFormatTest, DetectTiffBigEndian) {
     EXPECT_EQ(format, Format::TIFF);
 }
 
+TEST_F(ImageFormatTest, DetectCameraRaw) {
+    // CR2：头部偏移 8 处的 "CR" 标记
+    std::vector<uint8_t> cr2 = {0x49, 0x49, 0x2A, 0x00, 0x10, 0x00, 0x00, 0x00,
+                                0x43, 0x52, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00};
+    EXPECT_EQ(detect(cr2.data(), cr2.size()), Format::CR2);
+
+    auto nef = make_tiff_ifd0("NIKON CORPORATION", RawTag::CfaSubIfd);
+    EXPECT_EQ(detect(nef.data(), nef.size()), Format::NEF);
+
+    auto arw = make_tiff_ifd0("SONY", RawTag::Sr2Private);
+    EXPECT_EQ(detect(arw.data(), arw.size()), Format::ARW);
+    auto arw_cfa = make_tiff_ifd0("SONY", RawTag::CfaSubIfd);
+    EXPECT_EQ(detect(arw_cfa.data(), arw_cfa.size()), Format::ARW);
+
+    // DNGVersion 优先于 Make
+    auto dng = make_tiff_ifd0("NIKON CORPORATION", RawTag::DngVersion);
+    EXPECT_EQ(detect(dng.data(), dng.size()), Format::DNG);
+
+    // 其他厂商或 Make 值超出缓冲区时仍为 TIFF
+    auto scanner = make_tiff_ifd0("EPSON", RawTag::CfaSubIfd);
+    EXPECT_EQ(detect(scanner.data(), scanner.size()), Format::TIFF);
+    nef.resize(nef.size() - 10);
+    EXPECT_EQ(detect(nef.data(), nef.size()), Format::TIFF);
+
+    // 只有厂商名、没有原始数据标志（相机导出的普通 TIFF）
+    auto nikon_tiff = make_tiff_ifd0("NIKON CORPORATION", RawTag::None);
+    EXPECT_EQ(detect(nikon_tiff.data(), nikon_tiff.size()), Format::TIFF);
+    auto sony_tiff = make_tiff_ifd0("SONY", RawTag::None);
+    EXPECT_EQ(detect(sony_tiff.data(), sony_tiff.size()), Format::TIFF);
+    // SR2Private 是 Sony 的私有标签，不能作为 Nikon RAW 的依据
+    auto nikon_sr2 = make_tiff_ifd0("NIKON CORPORATION", RawTag::Sr2Private);
+    EXPECT_EQ(detect(nikon_sr2.data(), nikon_sr2.size()), Format::TIFF);
+
+    EXPECT_EQ(get_info(Format::DNG).mime_type, "image/x-adobe-dng");
+    EXPECT_EQ(get_info(Format::ARW).category, Category::Image);
+}
+
+TEST_F(ImageFormatTest, ProbePngIhdr) {
+    // 1920x1080，8 位 RGBA
+    std::vector<uint8_t> data = png_magic;
+    const uint8_t ihdr[] = {0x00, 0x00, 0x00, 0x0D, 'I',  'H',  'D',  'R',  0x00,
+                            0x00, 0x07, 0x80, 0x00, 0x00, 0x04, 0x38, 0x08, 0x06};
+    data.insert(data.end(), ihdr, ihdr + sizeof(ihdr));
+
+    auto info = probe_image(data.data(), data.size());
+    EXPECT_EQ(info.format, Format::PNG);
+    EXPECT_EQ(info.width, 1920u);
+    EXPECT_EQ(info.height, 1080u);
+    EXPECT_EQ(info.bit_depth, 8);
+    EXPECT_EQ(info.channels, 4);
+
+    // 只有签名时没有尺寸
+    EXPECT_FALSE(probe_image(png_magic.data(), png_magic.size()).has_dimensions());
+}
+
+TEST_F(ImageFormatTest, ProbeJpegSof) {
+    auto data = make_jpeg(16);
+    auto info = probe_image(data.data(), data.size());
+    EXPECT_EQ(info.format, Format::JPEG);
+    EXPECT_EQ(info.width, 640u);
+    EXPECT_EQ(info.height, 480u);
+    EXPECT_EQ(info.bit_depth, 8);
+    EXPECT_EQ(info.channels, 3);
+    EXPECT_EQ(info.resume_offset, 0u);
+}
+
+TEST_F(ImageFormatTest, ProbeJpegResumesPastLargeSegment) {
+    // SOF0 位于 20000 字节的 APP1（如 EXIF 缩略图）之后
+    auto data = make_jpeg(20000);
+    auto info = probe_image(data.data(), 4096);
+    EXPECT_FALSE(info.has_dimensions());
+    EXPECT_EQ(info.resume_offset, 20006u);
+
+    auto offset = static_cast<size_t>(info.resume_offset);
+    info = resume_probe_image(info, data.data() + offset, data.size() - offset);
+    EXPECT_EQ(info.width, 640u);
+    EXPECT_EQ(info.height, 480u);
+    EXPECT_EQ(info.resume_offset, 0u);
+
+    // 路径版本自动按 resume_offset 追加读取
+    test::TempFile file(data);
+    ImageInfo from_file;
+    auto result = detect_safe(file.path(), from_file);
+
+    EXPECT_EQ(result.format, Format::JPEG);
+    EXPECT_EQ(from_file.width, 640u);
+    EXPECT_EQ(from_file.height, 480u);
+}
+
+TEST_F(ImageFormatTest, ProbeJpegStopsWhenResumeOffsetStalls) {
+    // 文件在 SOF0 标记之后两字节处结束：继续扫描得到相同的 resume_offset
+    auto data = make_jpeg(20000);
+    data.resize(20006 + 2);
+    ImageInfo partial = probe_image(data.data(), 4096);
+    auto stalled = resume_probe_image(partial, data.data() + 20006, 2);
+    EXPECT_EQ(stalled.resume_offset, partial.resume_offset);
+
+    test::TempFile file(data);
+    ImageInfo info;
+    auto result = detect_safe(file.path(), info);
+    EXPECT_EQ(result.format, Format::JPEG);
+    EXPECT_FALSE(info.has_dimensions());
+    EXPECT_EQ(info.resume_offset, 0u);
+}
+
+TEST_F(ImageFormatTest, ProbeGifAndBmp) {
+    // GIF：320x200，全局调色板 256 色
+    std::vector<uint8_t> gif = gif_magic;
+    const uint8_t lsd[] = {0x40, 0x01, 0xC8, 0x00, 0xF7, 0x00, 0x00};
+    gif.insert(gif.end(), lsd, lsd + sizeof(lsd));
+    auto info = probe_image(gif.data(), gif.size());
+    EXPECT_EQ(info.width, 320u);
+    EXPECT_EQ(info.height, 200u);
+    EXPECT_EQ(info.bit_depth, 8);
+    EXPECT_EQ(info.channels, 1);
+
+    // BMP：BITMAPINFOHEADER，100x(-50) 自上而下，24 位
+    std::vector<uint8_t> bmp = bmp_magic;
+    const uint8_t dib[] = {0x64, 0x00, 0x00, 0x00, 0xCE, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x18, 0x00};
+    bmp.insert(bmp.end(), dib, dib + sizeof(dib));
+    info = probe_image(bmp.data(), bmp.size());
+    EXPECT_EQ(info.width, 100u);
+    EXPECT_EQ(info.height, 50u);
+    EXPECT_EQ(info.bit_depth, 8);
+    EXPECT_EQ(info.channels, 3);
+}
+
+TEST_F(ImageFormatTest, ProbeWebpChunks) {
+    auto make_webp = [this](const std::vector<uint8_t>& chunk) {
+        std::vector<uint8_t> data = webp_magic;
+        data.insert(data.end(), chunk.begin(), chunk.end());
+        data.resize(40, 0);
+        return data;
+    };
+
+    // VP8：关键帧起始码后 14 位宽高
+    auto lossy = make_webp({'V', 'P', '8', ' ', 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                            0x9D, 0x01, 0x2A, 0x20, 0x03, 0x58, 0x02});
+    auto info = probe_image(lossy.data(), lossy.size());
+    EXPECT_EQ(info.width, 800u);
+    EXPECT_EQ(info.height, 600u);
+    EXPECT_EQ(info.channels, 3);
+
+    // VP8L：宽 16、高 8，带 alpha
+    uint32_t bits = 15 | (7u << 14) | (1u << 28);
+    auto lossless = make_webp({'V', 'P', '8', 'L', 0x00, 0x00, 0x00, 0x00, 0x2F,
+                               static_cast<uint8_t>(bits), static_cast<uint8_t>(bits >> 8),
+                               static_cast<uint8_t>(bits >> 16), static_cast<uint8_t>(bits >> 24)});
+    info = probe_image(lossless.data(), lossless.size());
+    EXPECT_EQ(info.width, 16u);
+    EXPECT_EQ(info.height, 8u);
+    EXPECT_EQ(info.channels, 4);
+
+    // VP8X：画布 4000x3000
+    auto extended = make_webp({'V', 'P', '8', 'X', 0x0A, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00,
+                               0x9F, 0x0F, 0x00, 0xB7, 0x0B, 0x00});
+    info = probe_image(extended.data(), extended.size());
+    EXPECT_EQ(info.width, 4000u);
+    EXPECT_EQ(info.height, 3000u);
+    EXPECT_EQ(info.channels, 4);
+}
+
+TEST_F(ImageFormatTest, ProbeTiffIfd0) {
+    // 大端 TIFF：IFD0 含 ImageWidth(LONG)、ImageLength(SHORT)、BitsPerSample(3 个 SHORT，按偏移)、
+    // SamplesPerPixel(SHORT)
+    std::vector<uint8_t> data = {0x4D, 0x4D, 0x00, 0x2A, 0x00, 0x00, 0x00, 0x08, 0x00, 0x04,
+                                 0x01, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+                                 0x0B, 0xB8, 0x01, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01,
+                                 0x07, 0xD0, 0x00, 0x00, 0x01, 0x02, 0x00, 0x03, 0x00, 0x00,
+                                 0x00, 0x03, 0x00, 0x00, 0x00, 0x3E, 0x01, 0x15, 0x00, 0x03,
+                                 0x00, 0x00, 0x00, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+                                 0x00, 0x00, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10};
+
+    auto info = probe_image(data.data(), data.size());
+    EXPECT_EQ(info.format, Format::TIFF);
+    EXPECT_EQ(info.width, 3000u);
+    EXPECT_EQ(info.height, 2000u);
+    EXPECT_EQ(info.bit_depth, 16);
+    EXPECT_EQ(info.channels, 3);
+
+    // IFD0 偏移超出缓冲区
+    EXPECT_FALSE(probe_image(tiff_le_magic.data(), tiff_le_magic.size()).has_dimensions());
+}
+
+TEST_F(ImageFormatTest, ProbeNonImage) {
+    std::vector<uint8_t> pdf = {0x25, 0x50, 0x44, 0x46, 0x2D, 0x31, 0x2E, 0x37};
+    auto info = probe_image(pdf.data(), pdf.size());
+    EXPECT_EQ(info.format, Format::Unknown);
+    EXPECT_FALSE(info.has_dimensions());
+    EXPECT_FALSE(probe_image(nullptr, 0).has_dimensions());
+}
+
 TEST_F(ImageFormatTest, PngFormatInfo) {
     auto& info = get_info(Format::PNG);
     EXPECT_EQ(info.format, Format::PNG);
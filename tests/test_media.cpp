@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 #include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
 
 namespace fileformat {
 namespace {
@@ -13,8 +16,8 @@ protected:
     // MP3 with ID3 tag
     const std::vector<uint8_t> mp3_id3_magic = {0x49, 0x44, 0x33};  // ID3
 
-    // MP3 frame sync
-    const std::vector<uint8_t> mp3_sync_magic = {0xFF, 0xFB};
+    // MP3 frame sync: 两个连续的 MPEG1 Layer III 帧（128 kbps, 44.1 kHz, 417 字节/帧）
+    std::vector<uint8_t> mp3_sync_magic;
 
     // WAV: RIFF....WAVE
     const std::vector<uint8_t> wav_magic = {0x52, 0x49, 0x46, 0x46, 0x00, 0x00,
@@ -29,6 +32,58 @@ protected:
 
     // MKV: EBML header
     const std::vector<uint8_t> mkv_magic = {0x1A, 0x45, 0xDF, 0xA3};
+
+    // ftyp box：major brand + minor version + compatible brands
+    static std::vector<uint8_t> make_ftyp(const std::string& major,
+                                          const std::vector<std::string>& compatible) {
+        auto size = static_cast<uint8_t>(16 + 4 * compatible.size());
+        std::vector<uint8_t> data = {0x00, 0x00, 0x00, size, 'f', 't', 'y', 'p'};
+        data.insert(data.end(), major.begin(), major.end());
+        data.insert(data.end(), {0x00, 0x00, 0x00, 0x00});
+        for (const auto& brand : compatible) {
+            data.insert(data.end(), brand.begin(), brand.end());
+        }
+        return data;
+    }
+
+    static void put_le32(std::vector<uint8_t>& data, size_t pos, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            data[pos + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    static void put_be32(std::vector<uint8_t>& data, size_t pos, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            data[pos + i] = static_cast<uint8_t>(value >> (24 - 8 * i));
+        }
+    }
+
+    // ftyp + mdat(mdat_size) + moov{mvhd v0}：moov 位于媒体数据之后
+    static std::vector<uint8_t> make_mp4_moov_at_end(size_t mdat_size, uint32_t timescale,
+                                                     uint32_t duration) {
+        std::vector<uint8_t> data = make_ftyp("isom", {"isom", "mp41"});
+        size_t mdat = data.size();
+        data.resize(mdat + mdat_size, 0);
+        put_be32(data, mdat, static_cast<uint32_t>(mdat_size));
+        std::copy_n("mdat", 4, data.begin() + static_cast<std::ptrdiff_t>(mdat + 4));
+
+        size_t moov = data.size();
+        data.resize(moov + 8 + 8 + 100, 0);
+        put_be32(data, moov, 8 + 8 + 100);
+        std::copy_n("moov", 4, data.begin() + static_cast<std::ptrdiff_t>(moov + 4));
+        put_be32(data, moov + 8, 8 + 100);
+        std::copy_n("mvhd", 4, data.begin() + static_cast<std::ptrdiff_t>(moov + 12));
+        put_be32(data, moov + 16 + 12, timescale);
+        put_be32(data, moov + 16 + 16, duration);
+        return data;
+    }
+
+    void SetUp() override {
+        const uint8_t frame_header[] = {0xFF, 0xFB, 0x90, 0x00};
+        mp3_sync_magic.resize(417 + 4, 0);
+        std::copy(frame_header, frame_header + 4, mp3_sync_magic.begin());
+        std::copy(frame_header, frame_header + 4, mp3_sync_magic.begin() + 417);
+    }
 };
 
 TEST_F(MediaFormatTest, DetectMp3WithId3) {
@@ -41,6 +96,22 @@ TEST_F(MediaFormatTest, DetectMp3FrameSync) {
     EXPECT_EQ(format, Format::MP3);
 }
 
+TEST_F(MediaFormatTest, RejectMp3WithInconsistentSecondFrame) {
+    // 第二帧位置没有帧同步
+    std::vector<uint8_t> data = mp3_sync_magic;
+    data[417] = 0x00;
+    EXPECT_EQ(detect(data.data(), data.size()), Format::Unknown);
+
+    // 第二帧采样率与首帧不一致
+    data = mp3_sync_magic;
+    data[417 + 2] = 0x94;
+    EXPECT_EQ(detect(data.data(), data.size()), Format::Unknown);
+
+    // 首帧比特率索引无效
+    std::vector<uint8_t> bad_bitrate = {0xFF, 0xFB, 0xF0, 0x00};
+    EXPECT_EQ(detect(bad_bitrate.data(), bad_bitrate.size()), Format::Unknown);
+}
+
 TEST_F(MediaFormatTest, DetectWav) {
     auto format = detect(wav_magic.data(), wav_magic.size());
     EXPECT_EQ(format, Format::WAV);
@@ -56,11 +127,214 @@ TEST_F(MediaFormatTest, DetectMp4) {
     EXPECT_EQ(format, Format::MP4);
 }
 
+TEST_F(MediaFormatTest, DetectIsoBmffBrands) {
+    auto mp4 = make_ftyp("isom", {"isom", "iso2", "avc1", "mp41"});
+    EXPECT_EQ(detect(mp4.data(), mp4.size()), Format::MP4);
+
+    auto m4a = make_ftyp("M4A ", {"M4A ", "mp42", "isom"});
+    EXPECT_EQ(detect(m4a.data(), m4a.size()), Format::M4A);
+
+    auto mov = make_ftyp("qt  ", {"qt  "});
+    EXPECT_EQ(detect(mov.data(), mov.size()), Format::MOV);
+
+    auto threegp = make_ftyp("3gp5", {"3gp5", "isom"});
+    EXPECT_EQ(detect(threegp.data(), threegp.size()), Format::ThreeGP);
+
+    // 通用 MP4 major brand 不因 compatible brands 降级为 3GP/MOV
+    auto isom_3gp = make_ftyp("isom", {"isom", "3gp4"});
+    EXPECT_EQ(detect(isom_3gp.data(), isom_3gp.size()), Format::MP4);
+    auto mp42_qt = make_ftyp("mp42", {"mp42", "qt  "});
+    EXPECT_EQ(detect(mp42_qt.data(), mp42_qt.size()), Format::MP4);
+
+    // iTunes / Flash 视频把 M4A 列为兼容品牌，仍为视频
+    auto m4v = make_ftyp("M4V ", {"M4V ", "M4A ", "mp42", "isom"});
+    EXPECT_EQ(detect(m4v.data(), m4v.size()), Format::MP4);
+    auto f4v = make_ftyp("f4v ", {"isom", "mp42", "M4A "});
+    EXPECT_EQ(detect(f4v.data(), f4v.size()), Format::MP4);
+
+    // 未知 major brand 时依据 compatible brands 细分
+    auto unknown_3gp = make_ftyp("abcd", {"3gp4"});
+    EXPECT_EQ(detect(unknown_3gp.data(), unknown_3gp.size()), Format::ThreeGP);
+
+    auto heic = make_ftyp("heic", {"mif1", "heic"});
+    EXPECT_EQ(detect(heic.data(), heic.size()), Format::HEIC);
+
+    // 通用 HEIF major brand 时依据 compatible brands 细分
+    auto avif = make_ftyp("mif1", {"mif1", "avif", "miaf", "MA1B"});
+    EXPECT_EQ(detect(avif.data(), avif.size()), Format::AVIF);
+
+    auto heif = make_ftyp("mif1", {"mif1", "miaf"});
+    EXPECT_EQ(detect(heif.data(), heif.size()), Format::HEIC);
+    EXPECT_EQ(get_info(Format::HEIC).category, Category::Image);
+}
+
+TEST_F(MediaFormatTest, DetectQuickTimeWithoutLeadingFtyp) {
+    // wide + mdat，没有 ftyp 的旧 QuickTime
+    std::vector<uint8_t> legacy = {0x00, 0x00, 0x00, 0x08, 'w', 'i', 'd', 'e',
+                                   0x00, 0x10, 0x00, 0x00, 'm', 'd', 'a', 't'};
+    EXPECT_EQ(detect(legacy.data(), legacy.size()), Format::MOV);
+
+    // free box 之后的 ftyp
+    std::vector<uint8_t> late = {0x00, 0x00, 0x00, 0x0C, 'f', 'r', 'e', 'e', 0x00, 0x00, 0x00, 0x00};
+    auto ftyp = make_ftyp("M4A ", {"isom"});
+    late.insert(late.end(), ftyp.begin(), ftyp.end());
+    EXPECT_EQ(detect(late.data(), late.size()), Format::M4A);
+
+    // 文本中的 "free" 不会被当作 box
+    std::string text = "Get free shipping on all orders";
+    EXPECT_NE(detect(reinterpret_cast<const uint8_t*>(text.data()), text.size()), Format::MOV);
+}
+
 TEST_F(MediaFormatTest, DetectMkv) {
     auto format = detect(mkv_magic.data(), mkv_magic.size());
     EXPECT_EQ(format, Format::MKV);
 }
 
+TEST_F(MediaFormatTest, DetectWebmByDocType) {
+    // EBML 头：EBMLVersion=1, EBMLReadVersion=1, DocType="webm", DocTypeVersion=4
+    std::vector<uint8_t> webm = {0x1A, 0x45, 0xDF, 0xA3, 0x93, 0x42, 0x86, 0x81, 0x01, 0x42,
+                                 0xF7, 0x81, 0x01, 0x42, 0x82, 0x84, 'w',  'e',  'b',  'm',
+                                 0x42, 0x87, 0x81, 0x04};
+    EXPECT_EQ(detect(webm.data(), webm.size()), Format::WebM);
+    EXPECT_EQ(get_info(Format::WebM).mime_type, "video/webm");
+
+    // 8 字节长度编码的头部大小，DocType="matroska"
+    std::vector<uint8_t> mkv = {0x1A, 0x45, 0xDF, 0xA3, 0x01, 0x00, 0x00, 0x00, 0x00,
+                                0x00, 0x00, 0x0B, 0x42, 0x82, 0x88, 'm',  'a',  't',
+                                'r',  'o',  's',  'k',  'a'};
+    EXPECT_EQ(detect(mkv.data(), mkv.size()), Format::MKV);
+
+    // 以 0 填充的 DocType
+    std::vector<uint8_t> padded = {0x1A, 0x45, 0xDF, 0xA3, 0x87, 0x42, 0x82,
+                                   0x84, 'w',  'e',  'b',  'm',  0x00};
+    padded[4] = 0x88;
+    padded[7] = 0x85;
+    EXPECT_EQ(detect(padded.data(), padded.size()), Format::WebM);
+}
+
+TEST_F(MediaFormatTest, ProbeWav) {
+    // 16 位立体声 44.1 kHz，1 秒 PCM 数据
+    std::vector<uint8_t> data(44 + 176400, 0);
+    std::copy_n("RIFF", 4, data.begin());
+    std::copy_n("WAVEfmt ", 8, data.begin() + 8);
+    put_le32(data, 16, 16);
+    data[20] = 1;   // PCM
+    data[22] = 2;   // 声道
+    put_le32(data, 24, 44100);
+    put_le32(data, 28, 176400);
+    data[32] = 4;
+    data[34] = 16;
+    std::copy_n("data", 4, data.begin() + 36);
+    put_le32(data, 40, 176400);
+
+    auto info = probe_media(data.data(), data.size());
+    EXPECT_EQ(info.format, Format::WAV);
+    EXPECT_EQ(info.sample_rate, 44100u);
+    EXPECT_EQ(info.channels, 2);
+    EXPECT_EQ(info.bitrate, 1411200u);
+    EXPECT_EQ(info.duration_ms, 1000u);
+}
+
+TEST_F(MediaFormatTest, ProbeAviMainHeader) {
+    // 25 fps（40000 微秒/帧），250 帧，640x360
+    std::vector<uint8_t> data(12 + 60, 0);
+    std::copy_n("RIFF", 4, data.begin());
+    std::copy_n("AVI LIST", 8, data.begin() + 8);
+    std::copy_n("hdrlavih", 8, data.begin() + 20);
+    put_le32(data, 28, 56);
+    put_le32(data, 32, 40000);
+    put_le32(data, 32 + 16, 250);
+    put_le32(data, 32 + 32, 640);
+    put_le32(data, 32 + 36, 360);
+
+    auto info = probe_media(data.data(), data.size());
+    EXPECT_EQ(info.format, Format::AVI);
+    EXPECT_EQ(info.duration_ms, 10000u);
+    EXPECT_EQ(info.width, 640);
+    EXPECT_EQ(info.height, 360);
+}
+
+TEST_F(MediaFormatTest, ProbeMp3CbrAndXing) {
+    // CBR：128 kbps，按数据大小估算时长
+    std::vector<uint8_t> cbr = mp3_sync_magic;
+    cbr.resize(16000, 0);
+    auto info = probe_media(cbr.data(), cbr.size());
+    EXPECT_EQ(info.format, Format::MP3);
+    EXPECT_EQ(info.sample_rate, 44100u);
+    EXPECT_EQ(info.channels, 2);
+    EXPECT_EQ(info.bitrate, 128000u);
+    EXPECT_EQ(info.duration_ms, 1000u);
+
+    // ID3v2 标签后跟带 Xing 头的 VBR 首帧：1000 帧 x 1152 样本 / 44100 Hz
+    std::vector<uint8_t> vbr = {'I', 'D', '3', 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20};
+    vbr.resize(10 + 32, 0);
+    vbr.insert(vbr.end(), mp3_sync_magic.begin(), mp3_sync_magic.end());
+    size_t xing = 10 + 32 + 4 + 32;
+    std::copy_n("Xing", 4, vbr.begin() + static_cast<std::ptrdiff_t>(xing));
+    put_be32(vbr, xing + 4, 0x03);
+    put_be32(vbr, xing + 8, 1000);
+    put_be32(vbr, xing + 12, 400000);
+
+    info = probe_media(vbr.data(), vbr.size());
+    EXPECT_EQ(info.format, Format::MP3);
+    EXPECT_EQ(info.duration_ms, 26122u);
+    EXPECT_EQ(info.bitrate, 122502u);
+}
+
+TEST_F(MediaFormatTest, ProbeMp4MovieHeaderAfterMdat) {
+    // moov 位于 64 KB 的 mdat 之后，文件头缓冲区之外
+    auto data = make_mp4_moov_at_end(65536, 1000, 12345);
+    auto info = probe_media(data.data(), data.size());
+    EXPECT_EQ(info.format, Format::MP4);
+    EXPECT_EQ(info.duration_ms, 12345u);
+
+    test::TempFile file(data);
+    MediaInfo from_file;
+    auto result = detect_safe(file.path(), from_file);
+
+    EXPECT_EQ(result.format, Format::MP4);
+    EXPECT_EQ(from_file.duration_ms, 12345u);
+    EXPECT_GT(from_file.bitrate, 0u);
+}
+
+TEST_F(MediaFormatTest, ProbeLayoutFastStart) {
+    // 默认封装：moov 位于 mdat 之后
+    auto tail = make_mp4_moov_at_end(65536, 1000, 12345);
+    auto layout = probe_layout(tail.data(), tail.size());
+    EXPECT_EQ(layout.format, Format::MP4);
+    EXPECT_TRUE(layout.known);
+    EXPECT_FALSE(layout.fast_start);
+
+    // faststart：把 moov 移到 ftyp 之后
+    size_t ftyp_size = make_ftyp("isom", {"isom", "mp41"}).size();
+    size_t moov_size = 8 + 8 + 100;
+    std::vector<uint8_t> fast(tail.begin(), tail.begin() + static_cast<std::ptrdiff_t>(ftyp_size));
+    fast.insert(fast.end(), tail.end() - static_cast<std::ptrdiff_t>(moov_size), tail.end());
+    fast.insert(fast.end(), tail.begin() + static_cast<std::ptrdiff_t>(ftyp_size),
+                tail.end() - static_cast<std::ptrdiff_t>(moov_size));
+    layout = probe_layout(fast.data(), fast.size());
+    EXPECT_TRUE(layout.known);
+    EXPECT_TRUE(layout.fast_start);
+
+    test::TempFile file(fast);
+    LayoutInfo from_file;
+    auto result = detect_safe(file.path(), from_file);
+    EXPECT_EQ(result.format, Format::MP4);
+    EXPECT_TRUE(from_file.fast_start);
+
+    // 仅有文件头、尚未遇到 moov/mdat 时布局未知
+    auto ftyp_only = make_ftyp("isom", {"isom"});
+    EXPECT_FALSE(probe_layout(ftyp_only.data(), ftyp_only.size()).known);
+}
+
+TEST_F(MediaFormatTest, ProbeNonMedia) {
+    std::vector<uint8_t> pdf = {0x25, 0x50, 0x44, 0x46, 0x2D, 0x31, 0x2E, 0x37};
+    auto info = probe_media(pdf.data(), pdf.size());
+    EXPECT_EQ(info.format, Format::PDF);
+    EXPECT_FALSE(info.has_duration());
+    EXPECT_FALSE(probe_media(nullptr, 0).has_duration());
+}
+
 TEST_F(MediaFormatTest, Mp3FormatInfo) {
     auto& info = get_info(Format::MP3);
     EXPECT_EQ(info.format, Format::MP3);
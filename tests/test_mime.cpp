@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+
+namespace fileformat {
+namespace {
+
+class MimeScanTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    struct Part {
+        size_t index;
+        std::string content_type;
+        Format format;
+        bool mismatch;
+    };
+
+    const Bytes png_magic = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A,
+                             0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52};
+    const Bytes pdf_magic = {'%', 'P', 'D', 'F', '-', '1', '.', '7', '\n'};
+
+    // 标准 Base64，每 76 个字符插入 CRLF
+    static std::string base64(const Bytes& data) {
+        static const char kAlphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string encoded;
+        for (size_t i = 0; i < data.size(); i += 3) {
+            uint32_t value = static_cast<uint32_t>(data[i]) << 16;
+            if (i + 1 < data.size()) {
+                value |= static_cast<uint32_t>(data[i + 1]) << 8;
+            }
+            if (i + 2 < data.size()) {
+                value |= data[i + 2];
+            }
+            encoded += kAlphabet[(value >> 18) & 0x3F];
+            encoded += kAlphabet[(value >> 12) & 0x3F];
+            encoded += i + 1 < data.size() ? kAlphabet[(value >> 6) & 0x3F] : '=';
+            encoded += i + 2 < data.size() ? kAlphabet[value & 0x3F] : '=';
+        }
+        std::string wrapped;
+        for (size_t i = 0; i < encoded.size(); i += 76) {
+            wrapped += encoded.substr(i, 76) + "\r\n";
+        }
+        return wrapped;
+    }
+
+    static std::string attachment(const std::string& boundary, const std::string& type,
+                                  const Bytes& content) {
+        return "--" + boundary + "\r\n" + "Content-Type: " + type + "\r\n" +
+               "Content-Transfer-Encoding: base64\r\n\r\n" + base64(content);
+    }
+
+    static std::vector<Part> scan(const std::string& message, std::error_code& error) {
+        std::vector<Part> parts;
+        scan_mime(reinterpret_cast<const uint8_t*>(message.data()), message.size(),
+                  [&](const MimePart& p) {
+                      parts.push_back({p.index, std::string(p.content_type), p.format, p.mismatch});
+                      return true;
+                  },
+                  error);
+        return parts;
+    }
+
+    // 不可定位的流缓冲区（模拟管道）
+    class PipeBuffer : public std::streambuf {
+    public:
+        explicit PipeBuffer(std::string& data) { setg(&data[0], &data[0], &data[0] + data.size()); }
+    };
+};
+
+TEST_F(MimeScanTest, MultipartAttachments) {
+    std::string message =
+        "From: sender@example.com\r\n"
+        "MIME-Version: 1.0\r\n"
+        "Content-Type: multipart/mixed;\r\n"
+        "\tboundary=\"=_outer\"\r\n"
+        "\r\n"
+        "This is a multi-part message in MIME format.\r\n"
+        "--=_outer\r\n"
+        "Content-Type: text/plain; charset=utf-8\r\n"
+        "Content-Transfer-Encoding: quoted-printable\r\n"
+        "\r\n"
+        "Hello, caf=C3=A9 =\r\n"
+        "world.\r\n" +
+        attachment("=_outer", "image/png; name=\"logo.png\"", png_magic) +
+        attachment("=_outer", "image/jpeg", pdf_magic) +
+        attachment("=_outer", "application/octet-stream", pdf_magic) +
+        "--=_outer--\r\n"
+        "epilogue\r\n";
+
+    std::error_code error;
+    auto parts = scan(message, error);
+    EXPECT_FALSE(error);
+    ASSERT_EQ(parts.size(), 4u);
+    EXPECT_EQ(parts[0].content_type, "text/plain");
+    EXPECT_EQ(get_info(parts[0].format).category, Category::Text);
+    EXPECT_FALSE(parts[0].mismatch);
+
+    EXPECT_EQ(parts[1].index, 1u);
+    EXPECT_EQ(parts[1].content_type, "image/png");
+    EXPECT_EQ(parts[1].format, Format::PNG);
+    EXPECT_FALSE(parts[1].mismatch);
+
+    // 声明为 JPEG 的 PDF
+    EXPECT_EQ(parts[2].format, Format::PDF);
+    EXPECT_TRUE(parts[2].mismatch);
+
+    // 通用二进制类型不判定为不符
+    EXPECT_EQ(parts[3].format, Format::PDF);
+    EXPECT_FALSE(parts[3].mismatch);
+}
+
+TEST_F(MimeScanTest, NestedMultipartAndAliases) {
+    std::string message =
+        "Content-Type: multipart/mixed; boundary=outer\n"
+        "\n"
+        "--outer\n"
+        "Content-Type: multipart/alternative; boundary=inner\n"
+        "\n"
+        "--inner\n"
+        "Content-Type: text/plain\n"
+        "\n"
+        "plain body\n"
+        "--inner\n"
+        "Content-Type: text/html\n"
+        "\n"
+        "<html><body>hi</body></html>\n"
+        // 外层边界同时结束未闭合的内层
+        "--outer\n"
+        "Content-Type: image/jpg\n"
+        "Content-Transfer-Encoding: base64\n"
+        "\n" +
+        base64({0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00}) +
+        "--outer--\n";
+
+    std::error_code error;
+    auto parts = scan(message, error);
+    EXPECT_FALSE(error);
+    ASSERT_EQ(parts.size(), 3u);
+    EXPECT_EQ(parts[0].content_type, "text/plain");
+    EXPECT_EQ(parts[1].content_type, "text/html");
+    EXPECT_FALSE(parts[1].mismatch);
+    EXPECT_EQ(parts[2].content_type, "image/jpg");
+    EXPECT_EQ(parts[2].format, Format::JPEG);
+    EXPECT_FALSE(parts[2].mismatch);
+}
+
+TEST_F(MimeScanTest, SinglePartMessage) {
+    std::string message =
+        "Content-Type: application/pdf\r\n"
+        "Content-Transfer-Encoding: base64\r\n"
+        "\r\n" +
+        base64(pdf_magic);
+
+    std::error_code error;
+    auto parts = scan(message, error);
+    EXPECT_FALSE(error);
+    ASSERT_EQ(parts.size(), 1u);
+    EXPECT_EQ(parts[0].index, 0u);
+    EXPECT_EQ(parts[0].content_type, "application/pdf");
+    EXPECT_EQ(parts[0].format, Format::PDF);
+    EXPECT_FALSE(parts[0].mismatch);
+}
+
+TEST_F(MimeScanTest, LargeAttachmentFromPipe) {
+    // 数 MB 的附件：只保留正文开头，不可定位的流同样可用
+    Bytes pdf = pdf_magic;
+    pdf.resize(2 * 1024 * 1024, 'A');
+    std::string message = "Content-Type: multipart/mixed; boundary=b\r\n\r\n" +
+                          attachment("b", "application/pdf", pdf) +
+                          attachment("b", "image/png", png_magic) + "--b--\r\n";
+
+    PipeBuffer buffer(message);
+    std::istream stream(&buffer);
+    std::vector<Format> formats;
+    std::error_code error;
+    size_t count = scan_mime(stream, [&](const MimePart& part) {
+        formats.push_back(part.format);
+        return true;
+    }, error);
+    EXPECT_FALSE(error);
+    EXPECT_EQ(count, 2u);
+    EXPECT_EQ(formats, (std::vector<Format>{Format::PDF, Format::PNG}));
+}
+
+TEST_F(MimeScanTest, StopsOnRequest) {
+    std::string message = "Content-Type: multipart/mixed; boundary=b\r\n\r\n" +
+                          attachment("b", "application/pdf", pdf_magic) +
+                          attachment("b", "image/png", png_magic) + "--b--\r\n";
+
+    std::error_code error;
+    size_t calls = 0;
+    size_t count = scan_mime(reinterpret_cast<const uint8_t*>(message.data()), message.size(),
+                             [&](const MimePart&) {
+                                 ++calls;
+                                 return false;
+                             },
+                             error);
+    EXPECT_EQ(count, 1u);
+    EXPECT_EQ(calls, 1u);
+    EXPECT_FALSE(error);
+}
+
+TEST_F(MimeScanTest, PathNotFound) {
+    std::error_code error;
+    size_t count = scan_mime("/nonexistent/path/message.eml", [](const MimePart&) { return true; },
+                             error);
+    EXPECT_EQ(count, 0u);
+    EXPECT_EQ(error, std::errc::no_such_file_or_directory);
+}
+
+}  // namespace
+}  // namespace fileformat
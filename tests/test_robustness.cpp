@@ -54,7 +54,7 @@ TEST_F(RobustnessTest, DetectSafeNonExistentFile) {
 
 // detect_or_throw 测试
 TEST_F(RobustnessTest, DetectOrThrowNonExistentFile) {
-    EXPECT_THROW(detect_or_throw("/nonexistent/file.bin"), std::system_error);
+    EXPECT_THROW((void)detect_or_throw("/nonexistent/file.bin"), std::system_error);
 }
 
 // 流检测测试
@@ -81,7 +81,7 @@ TEST_F(RobustnessTest, StreamPositionPreserved) {
     auto original_pos = stream.tellg();
 
     // 检测格式
-    detect(stream);
+    (void)detect(stream);
 
     // 验证位置被恢复
     EXPECT_EQ(stream.tellg(), original_pos);
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
+
+namespace fileformat {
+namespace {
+
+class ScanEmbeddedTest : public ::testing::Test {
+protected:
+    using Hits = std::vector<std::pair<uint64_t, Format>>;
+
+    const std::vector<uint8_t> png_magic = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    const std::vector<uint8_t> pdf_magic = {0x25, 0x50, 0x44, 0x46, 0x2D, 0x31, 0x2E, 0x37};
+    const std::vector<uint8_t> zip_magic = {0x50, 0x4B, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00};
+
+    static void place(std::vector<uint8_t>& data, size_t offset, const std::vector<uint8_t>& bytes) {
+        std::copy(bytes.begin(), bytes.end(), data.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+
+    static Hits scan(const std::vector<uint8_t>& data) {
+        Hits hits;
+        scan_embedded(data.data(), data.size(), [&](uint64_t offset, Format format) {
+            hits.emplace_back(offset, format);
+            return true;
+        });
+        return hits;
+    }
+};
+
+TEST_F(ScanEmbeddedTest, EmptyInput) {
+    EXPECT_EQ(scan_embedded(nullptr, 0, [](uint64_t, Format) { return true; }), 0u);
+}
+
+TEST_F(ScanEmbeddedTest, FindsSignaturesAtArbitraryOffsets) {
+    std::vector<uint8_t> data(8192, 0);
+    place(data, 100, pdf_magic);
+    place(data, 3001, png_magic);
+    place(data, 6000, zip_magic);
+
+    auto hits = scan(data);
+    ASSERT_EQ(hits.size(), 3u);
+    EXPECT_EQ(hits[0], std::make_pair(uint64_t{100}, Format::PDF));
+    EXPECT_EQ(hits[1], std::make_pair(uint64_t{3001}, Format::PNG));
+    EXPECT_EQ(hits[2], std::make_pair(uint64_t{6000}, Format::ZIP));
+}
+
+TEST_F(ScanEmbeddedTest, ReportsOuterFormatAtOffsetZero) {
+    std::vector<uint8_t> data(1024, 0);
+    place(data, 0, png_magic);
+    place(data, 512, pdf_magic);
+
+    auto hits = scan(data);
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[0].first, 0u);
+    EXPECT_EQ(hits[0].second, Format::PNG);
+    EXPECT_EQ(hits[1].second, Format::PDF);
+}
+
+TEST_F(ScanEmbeddedTest, FindsTarWithNonZeroAnchorOffset) {
+    std::vector<uint8_t> data(2048, 0);
+    place(data, 1000 + 257, {'u', 's', 't', 'a', 'r'});
+
+    auto hits = scan(data);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0], std::make_pair(uint64_t{1000}, Format::Tar));
+}
+
+TEST_F(ScanEmbeddedTest, FindsCompressedStreams) {
+    std::vector<uint8_t> data(8192, 0);
+    // zstd 单段帧
+    place(data, 1000, {0x28, 0xB5, 0x2F, 0xFD, 0x20, 0x10});
+    // bzip2: "BZh9" + 块头魔数
+    place(data, 3000, {0x42, 0x5A, 0x68, 0x39, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59});
+    // compress: 最大码长 16
+    place(data, 5000, {0x1F, 0x9D, 0x90});
+
+    auto hits = scan(data);
+    ASSERT_EQ(hits.size(), 3u);
+    EXPECT_EQ(hits[0], std::make_pair(uint64_t{1000}, Format::Zstd));
+    EXPECT_EQ(hits[1], std::make_pair(uint64_t{3000}, Format::BZip2));
+    EXPECT_EQ(hits[2], std::make_pair(uint64_t{5000}, Format::UnixCompress));
+}
+
+TEST_F(ScanEmbeddedTest, FindsDataFiles) {
+    std::vector<uint8_t> data(8192, 0);
+    // SQLite 头 + 4096 字节页大小
+    place(data, 2000, {0x53, 0x51, 0x4C, 0x69, 0x74, 0x65, 0x20, 0x66, 0x6F, 0x72, 0x6D, 0x61,
+                       0x74, 0x20, 0x33, 0x00, 0x10, 0x00});
+    place(data, 5000, {0x4F, 0x62, 0x6A, 0x01});
+
+    auto hits = scan(data);
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[0], std::make_pair(uint64_t{2000}, Format::SQLite));
+    EXPECT_EQ(hits[1], std::make_pair(uint64_t{5000}, Format::Avro));
+}
+
+TEST_F(ScanEmbeddedTest, WeakMagicsRequireStructuralConfirmation) {
+    // 孤立的 "MZ" 和 "BM" 没有合法的 PE 签名 / DIB 头，不应报告
+    std::vector<uint8_t> data(512, 0);
+    place(data, 10, {'M', 'Z'});
+    place(data, 200, {'B', 'M'});
+    EXPECT_TRUE(scan(data).empty());
+}
+
+TEST_F(ScanEmbeddedTest, CallbackCanStopScan) {
+    std::vector<uint8_t> data(4096, 0);
+    place(data, 10, png_magic);
+    place(data, 2000, png_magic);
+
+    size_t calls = 0;
+    auto hits = scan_embedded(data.data(), data.size(), [&](uint64_t, Format) {
+        ++calls;
+        return false;
+    });
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(hits, 1u);
+}
+
+TEST_F(ScanEmbeddedTest, ScanFileAcrossChunkBoundary) {
+    // 签名跨越流式读取的 1 MiB 分块边界
+    std::vector<uint8_t> data((1u << 20) + 8192, 0);
+    place(data, (1u << 20) - 3, png_magic);
+    place(data, 50, pdf_magic);
+
+    test::TempFile file(data);
+
+    Hits hits;
+    std::error_code error;
+    scan_embedded(
+        file.path(),
+        [&](uint64_t offset, Format format) {
+            hits.emplace_back(offset, format);
+            return true;
+        },
+        error);
+
+    EXPECT_FALSE(error);
+    EXPECT_EQ(hits, scan(data));
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[1], std::make_pair(uint64_t{(1u << 20) - 3}, Format::PNG));
+}
+
+TEST_F(ScanEmbeddedTest, ScanNonExistentFile) {
+    std::error_code error;
+    auto hits = scan_embedded("/nonexistent/file.bin", [](uint64_t, Format) { return true; }, error);
+    EXPECT_EQ(hits, 0u);
+    EXPECT_TRUE(error);
+}
+
+}  // namespace
+}  // namespace fileformat
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+#include "temp_file.hpp"
+
+namespace fileformat {
+namespace {
+
+class ByteSourceTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    // 模拟远端数据源：统计往返次数（每次 read_batch 或单独的 read_at 计一次）
+    class RemoteSource final : public ByteSource {
+    public:
+        explicit RemoteSource(const Bytes& data, uint64_t reported_size = 0)
+            : memory_(data.data(), data.size()),
+              size_(reported_size != 0 ? reported_size : data.size()) {}
+
+        uint64_t size() const noexcept override { return size_; }
+
+        size_t read_at(uint64_t offset, uint8_t* out, size_t length) noexcept override {
+            ++round_trips;
+            return memory_.read_at(offset, out, length);
+        }
+
+        void read_batch(ReadRequest* requests, size_t count) noexcept override {
+            ++round_trips;
+            ranges += count;
+            for (size_t i = 0; i < count; ++i) {
+                requests[i].transferred =
+                    memory_.read_at(requests[i].offset, requests[i].out, requests[i].length);
+            }
+        }
+
+        size_t round_trips = 0;
+        size_t ranges = 0;
+
+    private:
+        MemorySource memory_;
+        uint64_t size_;
+    };
+
+    static void put(Bytes& data, size_t offset, const std::string& text) {
+        std::copy(text.begin(), text.end(), data.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+};
+
+TEST_F(ByteSourceTest, FooterCheckReusesFirstBatch) {
+    // 头部与文件尾相距较远：两个区间，一次往返
+    Bytes parquet(200 * 1024, 0);
+    put(parquet, 0, "PAR1");
+    put(parquet, parquet.size() - 4, "PAR1");
+    RemoteSource source(parquet);
+    auto result = detect_safe(source);
+    EXPECT_TRUE(result.is_valid());
+    EXPECT_EQ(result.format, Format::Parquet);
+    EXPECT_EQ(source.round_trips, 1u);
+    EXPECT_EQ(source.ranges, 2u);
+
+    // 写入中断：尾部魔数缺失
+    put(parquet, parquet.size() - 4, "0000");
+    RemoteSource truncated(parquet);
+    EXPECT_EQ(detect_safe(truncated).format, Format::Unknown);
+    EXPECT_EQ(truncated.round_trips, 1u);
+}
+
+TEST_F(ByteSourceTest, SmallFileHeadAndTailCoalesced) {
+    Bytes pdf(8 * 1024, ' ');
+    put(pdf, 0, "%PDF-1.7\n");
+    std::string trailer = "trailer\n<< /Size 3 /Root 1 0 R /Encrypt 2 0 R >>\nstartxref\n0\n%%EOF\n";
+    put(pdf, pdf.size() - trailer.size(), trailer);
+    RemoteSource source(pdf);
+    auto result = detect_safe(source);
+    EXPECT_EQ(result.format, Format::PDF);
+    EXPECT_TRUE(result.encrypted);
+    EXPECT_EQ(source.round_trips, 1u);
+    EXPECT_EQ(source.ranges, 1u);
+}
+
+TEST_F(ByteSourceTest, FarProbesIssuedAsOneBatch) {
+    // ISO 9660：头部无法识别，卷识别序列的多个扇区合并为一次请求
+    constexpr size_t kSector = 2048;
+    Bytes iso(20 * kSector, 0);
+    put(iso, 16 * kSector + 1, "CD001");
+    put(iso, 17 * kSector + 1, "CD001");
+    RemoteSource source(iso);
+    auto result = detect_safe(source);
+    EXPECT_EQ(result.format, Format::ISO9660);
+    EXPECT_EQ(source.round_trips, 2u);
+}
+
+TEST_F(ByteSourceTest, ShortHeadReadIsError) {
+    Bytes data = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    RemoteSource source(data, 64 * 1024);
+    auto result = detect_safe(source);
+    EXPECT_EQ(result.error, std::errc::io_error);
+    EXPECT_EQ(result.format, Format::Unknown);
+
+    MemorySource empty(nullptr, 0);
+    auto empty_result = detect_safe(empty);
+    EXPECT_TRUE(empty_result.is_valid());
+    EXPECT_EQ(empty_result.format, Format::Unknown);
+}
+
+TEST_F(ByteSourceTest, ShortTailReadIsNotShifted) {
+    // 数据源声明的大小比实际多 512 字节：文件尾窗口只读回前半段
+    Bytes parquet(200 * 1024, 0);
+    put(parquet, 0, "PAR1");
+    // 实际数据的最后 4 字节；若按短读长度反推起点，会被误当作声明大小下的文件尾
+    put(parquet, parquet.size() - 4, "PAR1");
+    RemoteSource source(parquet, parquet.size() + 512);
+    auto result = detect_safe(source);
+    EXPECT_TRUE(result.is_valid());
+    EXPECT_EQ(result.format, Format::Unknown);
+}
+
+TEST_F(ByteSourceTest, FileSourceMatchesPathDetection) {
+    Bytes parquet(64 * 1024, 0);
+    put(parquet, 0, "PAR1");
+    put(parquet, parquet.size() - 4, "PAR1");
+    test::TempFile file(parquet);
+    const std::string& path = file.path();
+
+    FileSource source(path);
+    ASSERT_TRUE(source.is_open());
+    EXPECT_EQ(source.size(), parquet.size());
+    EXPECT_EQ(detect_safe(source).format, detect_safe(path).format);
+    EXPECT_EQ(detect_safe(source).format, Format::Parquet);
+
+    // 移动后由新对象持有文件句柄
+    FileSource moved(std::move(source));
+    EXPECT_TRUE(moved.is_open());
+    uint8_t magic[4] = {};
+    EXPECT_EQ(moved.read_at(0, magic, sizeof(magic)), sizeof(magic));
+    EXPECT_EQ(std::memcmp(magic, "PAR1", 4), 0);
+
+    FileSource missing("/nonexistent/path/object.bin");
+    EXPECT_FALSE(missing.is_open());
+    EXPECT_EQ(missing.size(), 0u);
+}
+
+}  // namespace
+}  // namespace fileformat
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+
+namespace fileformat {
+namespace {
+
+class TarWalkTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        uint64_t offset;
+        char type;
+        Format format;
+    };
+
+    const Bytes png_magic = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    const Bytes pdf_magic = {0x25, 0x50, 0x44, 0x46, 0x2D, 0x31, 0x2E, 0x37};
+
+    static void append(Bytes& data, const Bytes& bytes) {
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    // 512 字节头：name、size、type，magic 为 POSIX "ustar\0" 或 GNU "ustar  \0"，最后写入校验和
+    static Bytes tar_header(const std::string& name, uint64_t size, char type,
+                            const std::string& prefix = "", bool gnu = false) {
+        Bytes header(512, 0);
+        std::copy(name.begin(), name.begin() + std::min<size_t>(name.size(), 100), header.begin());
+        char field[12];
+        std::snprintf(field, sizeof(field), "%011llo", static_cast<unsigned long long>(size));
+        std::copy(field, field + 11, header.begin() + 124);
+        header[156] = static_cast<uint8_t>(type);
+        if (gnu) {
+            std::copy_n("ustar  ", 8, header.begin() + 257);
+        } else {
+            std::copy_n("ustar", 6, header.begin() + 257);
+            std::copy_n("00", 2, header.begin() + 263);
+            std::copy(prefix.begin(), prefix.end(), header.begin() + 345);
+        }
+        std::fill(header.begin() + 148, header.begin() + 156, ' ');
+        unsigned sum = 0;
+        for (uint8_t b : header) {
+            sum += b;
+        }
+        std::snprintf(field, sizeof(field), "%06o", sum);
+        std::copy(field, field + 7, header.begin() + 148);
+        return header;
+    }
+
+    // 头部 + 按块对齐的数据
+    static Bytes tar_member(const std::string& name, const Bytes& content, char type = '0',
+                            const std::string& prefix = "") {
+        Bytes data = tar_header(name, content.size(), type, prefix);
+        append(data, content);
+        data.resize((data.size() + 511) / 512 * 512, 0);
+        return data;
+    }
+
+    static Bytes text_bytes(const std::string& text) { return Bytes(text.begin(), text.end()); }
+
+    // PAX 记录："<长度> <键>=<值>\n"，长度包含自身
+    static std::string pax_record(const std::string& key, const std::string& value) {
+        std::string body = " " + key + "=" + value + "\n";
+        size_t length = body.size() + 1;
+        while (std::to_string(length).size() + body.size() != length) {
+            ++length;
+        }
+        return std::to_string(length) + body;
+    }
+
+    static Bytes end_blocks() { return Bytes(1024, 0); }
+
+    static std::vector<Entry> walk(const Bytes& data, std::error_code& error) {
+        std::vector<Entry> entries;
+        walk_tar(data.data(), data.size(), [&](const TarMember& m) {
+            entries.push_back({std::string(m.path), m.size, m.offset, m.type, m.format});
+            return true;
+        }, error);
+        return entries;
+    }
+
+    // 不可定位的流缓冲区（模拟管道）
+    class PipeBuffer : public std::streambuf {
+    public:
+        explicit PipeBuffer(Bytes& data) {
+            char* begin = reinterpret_cast<char*>(data.data());
+            setg(begin, begin, begin + data.size());
+        }
+    };
+};
+
+TEST_F(TarWalkTest, ReportsMembersWithFormats) {
+    Bytes tar = tar_member("docs/", {}, '5');
+    append(tar, tar_member("docs/report.pdf", pdf_magic));
+    append(tar, tar_member("logo.png", png_magic));
+    append(tar, end_blocks());
+
+    std::error_code error;
+    auto entries = walk(tar, error);
+    EXPECT_FALSE(error);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].path, "docs/");
+    EXPECT_EQ(entries[0].type, '5');
+    EXPECT_EQ(entries[0].format, Format::Unknown);
+    EXPECT_EQ(entries[1].path, "docs/report.pdf");
+    EXPECT_EQ(entries[1].size, pdf_magic.size());
+    EXPECT_EQ(entries[1].offset, 1024u);
+    EXPECT_EQ(entries[1].format, Format::PDF);
+    EXPECT_EQ(entries[2].path, "logo.png");
+    EXPECT_EQ(entries[2].offset, 2048u);
+    EXPECT_EQ(entries[2].format, Format::PNG);
+}
+
+TEST_F(TarWalkTest, UstarPrefixAndGnuLongName) {
+    Bytes tar = tar_member("image.png", png_magic, '0', "very/deep/directory");
+
+    std::string long_name = std::string(150, 'a') + "/file.pdf";
+    Bytes name_data = text_bytes(long_name);
+    name_data.push_back(0);
+    Bytes gnu_name = tar_header("././@LongLink", name_data.size(), 'L', "", true);
+    append(gnu_name, name_data);
+    gnu_name.resize((gnu_name.size() + 511) / 512 * 512, 0);
+    append(tar, gnu_name);
+    append(tar, tar_member(long_name.substr(0, 100), pdf_magic));
+    append(tar, end_blocks());
+
+    std::error_code error;
+    auto entries = walk(tar, error);
+    EXPECT_FALSE(error);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].path, "very/deep/directory/image.png");
+    EXPECT_EQ(entries[1].path, long_name);
+    EXPECT_EQ(entries[1].format, Format::PDF);
+    EXPECT_EQ(entries[1].offset, 2048u + 512u);
+}
+
+TEST_F(TarWalkTest, PaxPathAndSize) {
+    Bytes content = png_magic;
+    content.resize(700, 0);
+    std::string records = pax_record("path", "pax/long name.png") + pax_record("mtime", "1.5") +
+                          pax_record("size", "700");
+    Bytes tar = tar_member("PaxHeaders/x", text_bytes(records), 'x');
+    // 头部中的 size 字段可能不准确（超过 8 GB 时置 0），以 PAX size 为准
+    Bytes header = tar_header("short.png", 0, '0');
+    append(tar, header);
+    append(tar, content);
+    tar.resize((tar.size() + 511) / 512 * 512, 0);
+    append(tar, tar_member("next.pdf", pdf_magic));
+    append(tar, end_blocks());
+
+    std::error_code error;
+    auto entries = walk(tar, error);
+    EXPECT_FALSE(error);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].path, "pax/long name.png");
+    EXPECT_EQ(entries[0].size, 700u);
+    EXPECT_EQ(entries[0].format, Format::PNG);
+    // 扩展信息只作用于下一个成员
+    EXPECT_EQ(entries[1].path, "next.pdf");
+    EXPECT_EQ(entries[1].format, Format::PDF);
+}
+
+TEST_F(TarWalkTest, SeekableAndPipeStreamsAgree) {
+    Bytes big(3 * kMaxHeaderSize, 0x41);
+    std::copy(pdf_magic.begin(), pdf_magic.end(), big.begin());
+    Bytes tar = tar_member("big.pdf", big);
+    append(tar, tar_member("logo.png", png_magic));
+    append(tar, end_blocks());
+
+    auto collect = [](std::istream& stream, std::vector<std::string>& paths) {
+        std::error_code error;
+        size_t count = walk_tar(stream, [&](const TarMember& m) {
+            paths.emplace_back(m.path);
+            return true;
+        }, error);
+        EXPECT_FALSE(error);
+        return count;
+    };
+
+    std::istringstream seekable(std::string(tar.begin(), tar.end()));
+    std::vector<std::string> seek_paths;
+    EXPECT_EQ(collect(seekable, seek_paths), 2u);
+
+    PipeBuffer pipe_buffer(tar);
+    std::istream pipe(&pipe_buffer);
+    std::vector<std::string> pipe_paths;
+    EXPECT_EQ(collect(pipe, pipe_paths), 2u);
+    EXPECT_EQ(seek_paths, pipe_paths);
+}
+
+TEST_F(TarWalkTest, StopsOnRequest) {
+    Bytes tar = tar_member("a.pdf", pdf_magic);
+    append(tar, tar_member("b.png", png_magic));
+    append(tar, end_blocks());
+
+    std::error_code error;
+    size_t calls = 0;
+    size_t count = walk_tar(tar.data(), tar.size(), [&](const TarMember&) {
+        ++calls;
+        return false;
+    }, error);
+    EXPECT_EQ(count, 1u);
+    EXPECT_EQ(calls, 1u);
+    EXPECT_FALSE(error);
+}
+
+TEST_F(TarWalkTest, ReportsCorruptAndTruncatedArchives) {
+    Bytes tar = tar_member("a.pdf", pdf_magic);
+    append(tar, end_blocks());
+
+    Bytes corrupt = tar;
+    corrupt[0] ^= 0x01;
+    std::error_code error;
+    EXPECT_TRUE(walk(corrupt, error).empty());
+    EXPECT_EQ(error, std::errc::illegal_byte_sequence);
+
+    // 成员数据被截断：已报告的成员保留，同时返回 io_error
+    Bytes big(2048, 0x41);
+    std::copy(pdf_magic.begin(), pdf_magic.end(), big.begin());
+    Bytes truncated = tar_member("big.pdf", big);
+    truncated.resize(512 + 1024);
+    EXPECT_EQ(walk(truncated, error).size(), 1u);
+    EXPECT_EQ(error, std::errc::io_error);
+}
+
+TEST_F(TarWalkTest, PathNotFound) {
+    std::error_code error;
+    size_t count = walk_tar("/nonexistent/path/archive.tar", [](const TarMember&) { return true; },
+                            error);
+    EXPECT_EQ(count, 0u);
+    EXPECT_EQ(error, std::errc::no_such_file_or_directory);
+}
+
+}  // namespace
+}  // namespace fileformat
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+
+namespace fileformat {
+namespace {
+
+class TextFormatTest : public ::testing::Test {
+protected:
+    static Format detect_string(const std::string& text) {
+        return detect(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    }
+};
+
+TEST_F(TextFormatTest, DetectPlainText) {
+    EXPECT_EQ(detect_string("2024-01-01 12:00:00 INFO server started\n"), Format::Text);
+}
+
+TEST_F(TextFormatTest, DetectUtf8TextWithBom) {
+    EXPECT_EQ(detect_string("\xEF\xBB\xBF\xE4\xBD\xA0\xE5\xA5\xBD\xEF\xBC\x8C\xE4\xB8\x96\xE7\x95\x8C"),
+              Format::Text);
+}
+
+TEST_F(TextFormatTest, DetectUtf16LeTextWithBom) {
+    std::vector<uint8_t> data = {0xFF, 0xFE, 'h', 0x00, 'i', 0x00, 0x60, 0x4F, '\n', 0x00};
+    EXPECT_EQ(detect(data.data(), data.size()), Format::Text);
+}
+
+TEST_F(TextFormatTest, DetectUtf16BeXmlWithoutBom) {
+    std::string xml = "<?xml version=\"1.0\"?><root/>";
+    std::vector<uint8_t> data;
+    for (char c : xml) {
+        data.push_back(0x00);
+        data.push_back(static_cast<uint8_t>(c));
+    }
+    EXPECT_EQ(detect(data.data(), data.size()), Format::XML);
+}
+
+TEST_F(TextFormatTest, TruncatedUtf8SequenceAtEndIsText) {
+    // 头部缓冲区可能在多字节序列中间截断
+    EXPECT_EQ(detect_string("hello \xE4\xBD"), Format::Text);
+}
+
+TEST_F(TextFormatTest, RejectBinaryControlBytes) {
+    EXPECT_EQ(detect_string(std::string("abc\x00\x01\x02" "def", 9)), Format::Unknown);
+}
+
+TEST_F(TextFormatTest, RejectInvalidUtf8) {
+    EXPECT_EQ(detect_string("abc\xC0\xAF" " def"), Format::Unknown);
+}
+
+TEST_F(TextFormatTest, DetectXml) {
+    EXPECT_EQ(detect_string("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<rss version=\"2.0\">"),
+              Format::XML);
+    EXPECT_EQ(detect_string("<svg xmlns=\"http://www.w3.org/2000/svg\"></svg>"), Format::XML);
+}
+
+TEST_F(TextFormatTest, DetectXmlWithLegacyEncoding) {
+    // windows-1251 编码的 FB2 不是合法 UTF-8
+    EXPECT_EQ(detect_string("<?xml version=\"1.0\" encoding=\"windows-1251\"?>"
+                            "<FictionBook><title>\xCA\xED\xE8\xE3\xE0</title>"),
+              Format::FB2);
+}
+
+TEST_F(TextFormatTest, FictionBookRootIsCaseSensitive) {
+    // XML 元素名区分大小写：小写 fictionbook 不是 FB2
+    EXPECT_EQ(detect_string("<?xml version=\"1.0\"?>\n<fictionbook><body/></fictionbook>"),
+              Format::XML);
+    EXPECT_EQ(detect_string("<?xml version=\"1.0\"?>\n<FICTIONBOOK/>"), Format::XML);
+    EXPECT_EQ(detect_string("<?xml version=\"1.0\"?>\n<FictionBook/>"), Format::FB2);
+
+    // 同一次扫描中 HTML 标签仍不区分大小写
+    EXPECT_EQ(detect_string("<?xml version=\"1.0\"?>\n<fictionbook/><HTML>"), Format::HTML);
+}
+
+TEST_F(TextFormatTest, DetectHtml) {
+    EXPECT_EQ(detect_string("<!DOCTYPE html>\n<html><head>"), Format::HTML);
+    EXPECT_EQ(detect_string("  <HTML lang=\"en\">"), Format::HTML);
+    EXPECT_EQ(detect_string("<!-- comment -->\n<html>"), Format::HTML);
+}
+
+TEST_F(TextFormatTest, DetectJson) {
+    EXPECT_EQ(detect_string("{\"name\": \"value\", \"n\": 1}"), Format::JSON);
+    EXPECT_EQ(detect_string("[{\"id\": 1}, {\"id\": 2}]"), Format::JSON);
+    EXPECT_EQ(detect_string("[1, 2, 3]"), Format::JSON);
+    EXPECT_EQ(detect_string("{}"), Format::JSON);
+}
+
+TEST_F(TextFormatTest, BracketedLogLineIsNotJson) {
+    EXPECT_EQ(detect_string("[2024-01-01 12:00:00] INFO started\n"), Format::Text);
+    EXPECT_EQ(detect_string("[INFO] started\n"), Format::Text);
+}
+
+TEST_F(TextFormatTest, DetectCsv) {
+    EXPECT_EQ(detect_string("id,name,price\n1,apple,3.5\n2,\"pear, green\",4.0\n"), Format::CSV);
+    EXPECT_EQ(detect_string("a;b;c\r\n1;2;3\r\n"), Format::CSV);
+    EXPECT_EQ(detect_string("a\tb\n1\t2\n"), Format::CSV);
+}
+
+TEST_F(TextFormatTest, InconsistentColumnsIsText) {
+    EXPECT_EQ(detect_string("Hello, world.\nThis line has no comma\n"), Format::Text);
+}
+
+TEST_F(TextFormatTest, TextFormatInfo) {
+    auto& info = get_info(Format::JSON);
+    EXPECT_EQ(info.format, Format::JSON);
+    EXPECT_EQ(info.name, "JSON");
+    EXPECT_EQ(info.mime_type, "application/json");
+    EXPECT_EQ(info.extension, ".json");
+    EXPECT_EQ(info.category, Category::Text);
+}
+
+}  // namespace
+}  // namespace fileformat
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "fileformat/fileformat.hpp"
+
+namespace fileformat {
+namespace {
+
+class DetectTreeTest : public ::testing::Test {
+protected:
+    using Bytes = std::vector<uint8_t>;
+
+    const Bytes png_magic = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    const Bytes pdf_magic = {0x25, 0x50, 0x44, 0x46, 0x2D, 0x31, 0x2E, 0x37};
+
+    static void append(Bytes& data, const Bytes& bytes) {
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    static void append_le16(Bytes& data, size_t value) {
+        data.push_back(static_cast<uint8_t>(value));
+        data.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    static void append_le32(Bytes& data, size_t value) {
+        append_le16(data, value & 0xFFFF);
+        append_le16(data, value >> 16);
+    }
+
+    // 未压缩（stored）ZIP 条目
+    static Bytes zip_entry(const std::string& name, const Bytes& content) {
+        Bytes data = {0x50, 0x4B, 0x03, 0x04, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00};
+        data.resize(14, 0);                // 修改时间、日期
+        append_le32(data, 0);              // CRC-32
+        append_le32(data, content.size()); // 压缩后大小
+        append_le32(data, content.size()); // 原始大小
+        append_le16(data, name.size());
+        append_le16(data, 0);
+        data.insert(data.end(), name.begin(), name.end());
+        append(data, content);
+        return data;
+    }
+
+    // ustar 成员：512 字节头 + 按块对齐的数据
+    static Bytes tar_member(const std::string& name, const Bytes& content) {
+        Bytes header(512, 0);
+        std::copy(name.begin(), name.end(), header.begin());
+        char size_field[12];
+        std::snprintf(size_field, sizeof(size_field), "%011o", static_cast<unsigned>(content.size()));
+        std::copy(size_field, size_field + 11, header.begin() + 124);
+        header[156] = '0';
+        std::copy_n("ustar", 5, header.begin() + 257);
+
+        Bytes data = header;
+        append(data, content);
+        data.resize((data.size() + 511) / 512 * 512, 0);
+        return data;
+    }
+
+    // GZIP 成员，载荷以单个未压缩 deflate 块存放
+    static Bytes gzip_stored(const Bytes& payload) {
+        Bytes data = {0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0x03, 0x01};
+        append_le16(data, payload.size());
+        append_le16(data, ~payload.size() & 0xFFFF);
+        append(data, payload);
+        return data;
+    }
+
+    // 最小 PE：MZ 头 + e_lfanew 指向的 PE 签名
+    static Bytes pe_image(size_t size) {
+        Bytes data(size, 0);
+        data[0] = 'M';
+        data[1] = 'Z';
+        data[0x3C] = 0x80;
+        data[0x80] = 'P';
+        data[0x81] = 'E';
+        return data;
+    }
+};
+
+TEST_F(DetectTreeTest, EmptyInput) {
+    EXPECT_TRUE(detect_tree(nullptr, 0).empty());
+}
+
+TEST_F(DetectTreeTest, UnknownRootOnly) {
+    Bytes data(64, 0);
+    auto nodes = detect_tree(data.data(), data.size());
+    ASSERT_EQ(nodes.size(), 1u);
+    EXPECT_EQ(nodes[0].format, Format::Unknown);
+    EXPECT_EQ(nodes[0].parent, -1);
+}
+
+TEST_F(DetectTreeTest, DescendsIntoTarGz) {
+    Bytes tar = tar_member("report.pdf", pdf_magic);
+    append(tar, tar_member("logo.png", png_magic));
+    auto tgz = gzip_stored(tar);
+
+    auto nodes = detect_tree(tgz.data(), tgz.size());
+    ASSERT_EQ(nodes.size(), 4u);
+    EXPECT_EQ(nodes[0].format, Format::GZip);
+    EXPECT_EQ(nodes[1].format, Format::Tar);
+    EXPECT_EQ(nodes[1].parent, 0);
+    EXPECT_EQ(nodes[1].depth, 1u);
+    EXPECT_EQ(nodes[2].format, Format::PDF);
+    EXPECT_EQ(nodes[2].offset, 512u);
+    EXPECT_EQ(nodes[2].parent, 1);
+    EXPECT_EQ(nodes[2].depth, 2u);
+    EXPECT_EQ(nodes[3].format, Format::PNG);
+    EXPECT_EQ(nodes[3].offset, 1536u);
+    EXPECT_EQ(nodes[3].parent, 1);
+}
+
+TEST_F(DetectTreeTest, DescendsIntoNestedZip) {
+    Bytes inner = zip_entry("doc.pdf", pdf_magic);
+    Bytes outer = zip_entry("image.png", png_magic);
+    size_t inner_offset = outer.size() + 30 + 9;
+    append(outer, zip_entry("inner.zip", inner));
+
+    auto nodes = detect_tree(outer.data(), outer.size());
+    ASSERT_EQ(nodes.size(), 4u);
+    EXPECT_EQ(nodes[0].format, Format::ZIP);
+    EXPECT_EQ(nodes[1].format, Format::PNG);
+    EXPECT_EQ(nodes[1].offset, 39u);
+    EXPECT_EQ(nodes[2].format, Format::ZIP);
+    EXPECT_EQ(nodes[2].offset, inner_offset);
+    EXPECT_EQ(nodes[3].format, Format::PDF);
+    EXPECT_EQ(nodes[3].parent, 2);
+    EXPECT_EQ(nodes[3].depth, 2u);
+}
+
+TEST_F(DetectTreeTest, FindsZipAppendedToExecutable) {
+    Bytes data = pe_image(1024);
+    Bytes zip = zip_entry("a.pdf", pdf_magic);
+    append(zip, zip_entry("b.png", png_magic));
+    append(data, zip);
+
+    auto nodes = detect_tree(data.data(), data.size());
+    ASSERT_EQ(nodes.size(), 4u);
+    EXPECT_EQ(nodes[0].format, Format::EXE);
+    EXPECT_EQ(nodes[1].format, Format::ZIP);
+    EXPECT_EQ(nodes[1].offset, 1024u);
+    EXPECT_EQ(nodes[1].parent, 0);
+    // 条目已由 ZIP 遍历报告，不再作为 EXE 的嵌入命中重复出现
+    EXPECT_EQ(nodes[2].format, Format::PDF);
+    EXPECT_EQ(nodes[2].parent, 1);
+    EXPECT_EQ(nodes[3].format, Format::PNG);
+    EXPECT_EQ(nodes[3].parent, 1);
+}
+
+TEST_F(DetectTreeTest, RespectsDepthAndNodeBudgets) {
+    auto tgz = gzip_stored(tar_member("report.pdf", pdf_magic));
+
+    TreeOptions shallow;
+    shallow.max_depth = 1;
+    auto nodes = detect_tree(tgz.data(), tgz.size(), shallow);
+    ASSERT_EQ(nodes.size(), 2u);
+    EXPECT_EQ(nodes[1].format, Format::Tar);
+
+    TreeOptions few;
+    few.max_nodes = 1;
+    EXPECT_EQ(detect_tree(tgz.data(), tgz.size(), few).size(), 1u);
+
+    // 字节预算耗尽后不再解压
+    TreeOptions no_bytes;
+    no_bytes.max_bytes = 0;
+    EXPECT_EQ(detect_tree(tgz.data(), tgz.size(), no_bytes).size(), 1u);
+}
+
+TEST_F(DetectTreeTest, ClampsOversizedBudgets) {
+    // 极大的深度与节点预算不会按预算预先分配暂存区或节点表
+    auto tgz = gzip_stored(tar_member("report.pdf", pdf_magic));
+    TreeOptions huge;
+    huge.max_depth = UINT32_MAX;
+    huge.max_nodes = SIZE_MAX;
+    auto nodes = detect_tree(tgz.data(), tgz.size(), huge);
+    auto expected = detect_tree(tgz.data(), tgz.size());
+    ASSERT_EQ(nodes.size(), expected.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        EXPECT_EQ(nodes[i].format, expected[i].format);
+    }
+}
+
+TEST_F(DetectTreeTest, PathNotFound) {
+    std::error_code error;
+    auto nodes = detect_tree("/nonexistent/path/file.tgz", TreeOptions{}, error);
+    EXPECT_TRUE(nodes.empty());
+    EXPECT_EQ(error, std::errc::no_such_file_or_directory);
+}
+
+}  // namespace
+}  // namespace fileformat